@@ -0,0 +1,346 @@
+#!/usr/bin/env python3
+"""
+Performance regression test for the generated Python bindings
+
+pmp_bench (bench/pmp_bench.cxx) times the C++ side. This script times what
+the Rosetta-generated wrappers add on top of it, through the installed pmp
+module:
+
+- call.*     per-call overhead of small methods (argument conversion, handle
+             returns such as pmp.Vertex), in ns per call
+- bulk.*     the SurfaceMesh "vertices" / "indices" lambdas, whose
+             std::vector results are converted element by element, and the
+             buffer exporters of pmp_numpy.py, in ns per vertex / face
+- example/*  end-to-end runs of example.py (read, remesh, write) in a fresh
+             interpreter, in seconds
+
+Each metric is divided by a baseline timed in the same run that does the same
+work without the generated wrappers, and bench/binding_thresholds.json bounds
+that ratio, so the limits depend less on the machine:
+
+- call.*                 a call of a builtin method, (12345).bit_length()
+- bulk.vertices/indices  ndarray.tolist() of the same values, which builds
+                         the same Python list of floats / ints in C
+- bulk.*_array           ndarray.copy() of the result
+- example/*              the same steps run in this process, plus the
+                         start-up of an interpreter that imports pmp
+
+The script exits with status 1 when a ratio exceeds its limit. The limits
+are not part of the repository: generate them with --update from a known good
+build; the file also records the machine and commit they were measured on.
+Without it, the ratios are only reported.
+
+Usage:
+    python bench/binding_bench.py                       # all metrics
+    python bench/binding_bench.py --filter 'bulk.*'     # a subset
+    python bench/binding_bench.py --skip-large          # no 1M-face mesh
+    python bench/binding_bench.py --json results.json   # also save the values
+    python bench/binding_bench.py --update              # limits = ratios * 1.5
+"""
+
+import argparse
+import fnmatch
+import functools
+import json
+import os
+import platform
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+sys.path.insert(0, ROOT)
+
+try:
+    import pmp
+except ImportError:
+    print("Error: pmp module not found. Make sure the bindings are built and installed.")
+    sys.exit(1)
+
+from pmp_numpy import faces_array, points_array
+
+BUNNY = os.path.join(ROOT, "data", "bunny.obj")
+EXAMPLE = os.path.join(ROOT, "example.py")
+THRESHOLDS = os.path.join(ROOT, "bench", "binding_thresholds.json")
+
+
+def best_time(fn, repeat):
+    """Smallest wall-clock time of repeat calls of fn(), in seconds."""
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        fn()
+        best = min(best, time.perf_counter() - start)
+    return best
+
+
+def per_call_ns(fn, n_calls, repeat):
+    """Time of one call of fn() in ns, from the best of repeat loops of n_calls calls.
+
+    The cost of the Python loop itself is measured with an empty loop and
+    subtracted, leaving the cost of the call.
+    """
+    def run():
+        for _ in range(n_calls):
+            fn()
+
+    def empty():
+        for _ in range(n_calls):
+            pass
+
+    return max(best_time(run, repeat) - best_time(empty, repeat), 0.0) / n_calls * 1e9
+
+
+def load_mesh(path):
+    mesh = pmp.SurfaceMesh()
+    pmp.read(mesh, path)
+    return mesh
+
+
+def subdivided_icosahedron(n_subdivisions):
+    """Closed triangle mesh of 20 * 4^n_subdivisions faces."""
+    mesh = pmp.icosahedron()
+    for _ in range(n_subdivisions):
+        pmp.loop_subdivision(mesh)
+    return mesh
+
+
+def test_meshes(skip_large):
+    """(name, mesh) pairs: the bunny and generated meshes of ~80k and ~1.3M faces."""
+    meshes = [("bunny", load_mesh(BUNNY)), ("sphere80k", subdivided_icosahedron(6))]
+    if not skip_large:
+        meshes.append(("sphere1m", subdivided_icosahedron(8)))
+    return meshes
+
+
+def bench_calls(results, repeat):
+    mesh = load_mesh(BUNNY)
+    p = pmp.Point(0.0, 0.0, 0.0)
+
+    results["baseline.call"] = per_call_ns((12345).bit_length, 100000, repeat)
+    results["call.n_vertices"] = per_call_ns(mesh.n_vertices, 100000, repeat)
+    results["call.is_triangle_mesh"] = per_call_ns(mesh.is_triangle_mesh, 100000, repeat)
+    results["call.point"] = per_call_ns(functools.partial(pmp.Point, 1.0, 2.0, 3.0), 100000,
+                                        repeat)
+
+    # add_vertex grows the mesh: time it on a fresh mesh every loop
+    target = pmp.SurfaceMesh()
+
+    def add_vertices():
+        target.clear()
+        for _ in range(100000):
+            target.add_vertex(p)
+
+    def clear_only():
+        target.clear()
+        for _ in range(100000):
+            pass
+
+    add = best_time(add_vertices, repeat) - best_time(clear_only, repeat)
+    results["call.add_vertex"] = max(add, 0.0) / 100000 * 1e9
+
+
+def bench_bulk(results, meshes, repeat):
+    for name, mesh in meshes:
+        n_vertices = mesh.n_vertices()
+        n_faces = mesh.n_faces()
+        results[f"bulk.vertices/{name}"] = best_time(mesh.vertices, repeat) / n_vertices * 1e9
+        results[f"bulk.indices/{name}"] = best_time(mesh.indices, repeat) / n_faces * 1e9
+        results[f"bulk.points_array/{name}"] = (
+            best_time(lambda: points_array(mesh), repeat) / n_vertices * 1e9)
+        results[f"bulk.faces_array/{name}"] = (
+            best_time(lambda: faces_array(mesh), repeat) / n_faces * 1e9)
+
+        points = points_array(mesh)
+        faces = faces_array(mesh)
+        results[f"baseline.list_points/{name}"] = (
+            best_time(points.ravel().tolist, repeat) / n_vertices * 1e9)
+        results[f"baseline.list_faces/{name}"] = (
+            best_time(faces.ravel().tolist, repeat) / n_faces * 1e9)
+        results[f"baseline.copy_points/{name}"] = best_time(points.copy, repeat) / n_vertices * 1e9
+        results[f"baseline.copy_faces/{name}"] = best_time(faces.copy, repeat) / n_faces * 1e9
+
+
+def remesh_in_process(path, output):
+    """The steps of example.py, without its interpreter start-up and printing."""
+    mesh = load_mesh(path)
+    if not mesh.is_triangle_mesh():
+        pmp.triangulate(mesh)
+    pmp.uniform_remeshing(mesh, pmp.bounds(mesh).size() * 0.02, 10, True)
+    flags = pmp.IOFlags()
+    flags.use_binary = output.lower().endswith(".stl")
+    pmp.parallel_garbage_collection(mesh, 0)
+    pmp.write(mesh, output, flags)
+
+
+def bench_example(results, meshes, workdir):
+    start = time.perf_counter()
+    subprocess.run([sys.executable, "-c", "import pmp"], cwd=workdir, check=True)
+    startup = time.perf_counter() - start
+
+    for name, mesh in meshes:
+        if name == "bunny":
+            path = BUNNY
+        else:
+            path = os.path.join(workdir, name + ".obj")
+            pmp.write(mesh, path, pmp.IOFlags())
+        output = os.path.join(workdir, "remeshed_" + name + ".obj")
+
+        start = time.perf_counter()
+        run = subprocess.run([sys.executable, EXAMPLE, path, output], cwd=workdir,
+                             stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, text=True)
+        elapsed = time.perf_counter() - start
+        if run.returncode != 0 or not os.path.exists(output):
+            raise RuntimeError(f"example.py failed on {name}:\n{run.stderr}")
+        results[f"example/{name}"] = elapsed
+
+        start = time.perf_counter()
+        remesh_in_process(path, os.path.join(workdir, "baseline_" + name + ".obj"))
+        results[f"baseline.example/{name}"] = startup + time.perf_counter() - start
+
+
+def unit(metric):
+    if "example" in metric:
+        return "s"
+    if metric.startswith(("call.", "baseline.call")):
+        return "ns/call"
+    if "indices" in metric or "faces" in metric:
+        return "ns/face"
+    return "ns/vertex"
+
+
+def baseline(metric):
+    """Name of the baseline metric is divided by."""
+    group, _, mesh = metric.partition("/")
+    if group.startswith("call."):
+        return "baseline.call"
+    if group == "bulk.vertices":
+        return "baseline.list_points/" + mesh
+    if group == "bulk.indices":
+        return "baseline.list_faces/" + mesh
+    if group == "bulk.points_array":
+        return "baseline.copy_points/" + mesh
+    if group == "bulk.faces_array":
+        return "baseline.copy_faces/" + mesh
+    return "baseline.example/" + mesh
+
+
+def ratios(results):
+    """metric / baseline for every metric measured with its baseline."""
+    out = {}
+    for metric, value in results.items():
+        if metric.startswith("baseline."):
+            continue
+        reference = results.get(baseline(metric))
+        if reference:
+            out[metric] = value / reference
+    return out
+
+
+def recorded_on():
+    """Machine, interpreter and commit the limits are measured on."""
+    commit = subprocess.run(["git", "rev-parse", "HEAD"], cwd=ROOT, capture_output=True,
+                            text=True).stdout.strip()
+    return {
+        "machine": f"{platform.node()} ({platform.processor() or platform.machine()}, "
+                   f"{os.cpu_count()} cores, {platform.system()} {platform.release()})",
+        "python": platform.python_version(),
+        "commit": commit or "unknown",
+        "date": time.strftime("%Y-%m-%d"),
+    }
+
+
+def check(results, thresholds):
+    """Print every metric and its ratio against the limit, return the names over it."""
+    failed = []
+    measured = ratios(results)
+    print(f"{'metric':<32} {'value':>12} {'unit':<10} {'ratio':>8} {'limit':>8}")
+    for metric, value in results.items():
+        if metric.startswith("baseline."):
+            continue
+        ratio = measured.get(metric)
+        limit = thresholds.get(metric)
+        status = ""
+        if ratio is None:
+            status = "  (no baseline)"
+        elif limit is None:
+            status = "  (no limit)"
+        elif ratio > limit:
+            status = "  REGRESSION"
+            failed.append(metric)
+        ratio_text = "-" if ratio is None else f"{ratio:.3g}"
+        limit_text = "-" if limit is None else f"{limit:.3g}"
+        print(f"{metric:<32} {value:>12.4g} {unit(metric):<10} {ratio_text:>8} {limit_text:>8}"
+              f"{status}")
+    return failed
+
+
+def wanted(group, pattern):
+    """Whether pattern can match metrics of group ("call", "bulk" or "example")."""
+    prefix = pattern.split("*")[0].split("?")[0].split("[")[0]
+    return prefix.startswith(group) or group.startswith(prefix)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[1])
+    parser.add_argument("--thresholds", default=THRESHOLDS, help="JSON file of metric limits")
+    parser.add_argument("--filter", default="*", help="glob on metric names to keep")
+    parser.add_argument("--repeat", type=int, default=5, help="timings per metric, best kept")
+    parser.add_argument("--skip-large", action="store_true", help="leave out the 1M-face mesh")
+    parser.add_argument("--json", help="write the measured values to this file")
+    parser.add_argument("--update", action="store_true",
+                        help="write the measured ratios times --margin as the new limits")
+    parser.add_argument("--margin", type=float, default=1.5, help="limit / ratio for --update")
+    args = parser.parse_args()
+
+    results = {}
+    meshes = []
+    if wanted("bulk", args.filter) or wanted("example", args.filter):
+        meshes = test_meshes(args.skip_large)
+    if wanted("call", args.filter):
+        bench_calls(results, args.repeat)
+    if wanted("bulk", args.filter):
+        bench_bulk(results, meshes, args.repeat)
+    if wanted("example", args.filter):
+        with tempfile.TemporaryDirectory() as workdir:
+            bench_example(results, meshes, workdir)
+    # keep the baselines of the metrics kept
+    kept = [k for k in results if not k.startswith("baseline.") and fnmatch.fnmatch(k, args.filter)]
+    kept += {baseline(k) for k in kept if baseline(k) in results}
+    results = {k: results[k] for k in results if k in kept}
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump(results, f, indent=4)
+
+    thresholds = {}
+    if os.path.exists(args.thresholds):
+        with open(args.thresholds) as f:
+            thresholds = json.load(f)
+
+    if args.update:
+        thresholds.update(
+            {k: float(f"{v * args.margin:.3g}") for k, v in ratios(results).items()})
+        thresholds["_recorded"] = recorded_on()
+        with open(args.thresholds, "w") as f:
+            json.dump(dict(sorted(thresholds.items())), f, indent=4)
+            f.write("\n")
+        print(f"Limits written to {args.thresholds}")
+        return 0
+
+    if "_recorded" in thresholds:
+        print("Limits recorded on " +
+              ", ".join(f"{k} {v}" for k, v in thresholds["_recorded"].items()) + "\n")
+    elif not thresholds:
+        print(f"No limits in {args.thresholds}: ratios are only reported, "
+              "run --update on a known good build to record them\n")
+    failed = check(results, thresholds)
+    if failed:
+        print(f"\n{len(failed)} metric(s) over their limit: {', '.join(failed)}")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,1186 @@
+// ============================================================================
+// Benchmarks of the registered algorithms
+// ============================================================================
+// One Google Benchmark per function registered in pmp_rosetta::register_all()
+// whose cost grows with the mesh, run on data/bunny.obj and on generated
+// meshes of several sizes: triangulated uv spheres and loop-subdivided
+// icosahedra, plus open spheres (pole removed) for parameterization and hole
+// filling and plain uv spheres (quads) for triangulation and quad
+// subdivision. Benchmark names are "<function>/<input>".
+//
+// Every benchmark measures wall-clock time, since most functions spread
+// their work over threads, and reports
+//   faces             number of faces of the input
+//   faces_per_second  input faces processed per second
+//   peak_rss_mib      resident set high-water mark while it ran (on Linux
+//                     the mark is reset before each benchmark; elsewhere it
+//                     is the peak of the process so far)
+//
+// The cached_* functions are timed on cache hits, and the *_async ones from
+// submission to completion of the job.
+//
+// The "check/..." entries compare the parallel reimplementations with the
+// PMP functions once, and fail on a mismatch: subdivision, smoothing,
+// feature detection, garbage collection and copy_mesh_into() must give the
+// same mesh, remeshing and decimation a mesh of the same size and accuracy.
+//
+// Machine-readable results, for diffing between runs:
+//   pmp_bench --benchmark_out=bench.json --benchmark_out_format=json
+//
+// Left out: constant-time accessors (scalar_size, n_face_indices,
+// n_render_indices, list_properties, property_info, the n_*() methods...),
+// the job, cache and profiling controls (set_job_limits, ResultCache.trim,
+// write_chrome_trace...), clear_features, triangulate_face and the
+// fixed-size shapes (tetrahedron ... torus).
+// ============================================================================
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#if !defined(__linux__) && (defined(__unix__) || defined(__APPLE__))
+#include <sys/resource.h>
+#endif
+
+#include "pmp_registration.h"
+
+#ifndef PMP_BENCH_DATA_DIR
+#define PMP_BENCH_DATA_DIR "data"
+#endif
+
+namespace {
+
+    // ------------------------------------------------------------------------
+    // Peak memory
+    // ------------------------------------------------------------------------
+
+    void reset_peak_rss() {
+#if defined(__linux__)
+        std::ofstream("/proc/self/clear_refs") << "5";
+#endif
+    }
+
+    double peak_rss_mib() {
+#if defined(__linux__)
+        std::ifstream status("/proc/self/status");
+        std::string   line;
+        while (std::getline(status, line)) {
+            if (line.rfind("VmHWM:", 0) == 0) {
+                return std::stod(line.substr(6)) / 1024; // kB
+            }
+        }
+        return 0;
+#elif defined(__APPLE__)
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return double(usage.ru_maxrss) / (1024 * 1024); // bytes
+#elif defined(__unix__)
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return double(usage.ru_maxrss) / 1024; // kB
+#else
+        return 0;
+#endif
+    }
+
+    // ------------------------------------------------------------------------
+    // Inputs
+    // ------------------------------------------------------------------------
+
+    enum class Shape {
+        Closed, // closed triangle meshes
+        Open,   // triangle meshes with one boundary loop
+        Quad    // quad-dominant meshes
+    };
+
+    // Largest input a benchmark runs on: about 10k, 100k and 1M faces
+    enum class Size { Small, Medium, Large };
+
+    std::filesystem::path scratch_dir() {
+        static const auto dir = [] {
+            auto path = std::filesystem::temp_directory_path() / "pmp_bench";
+            std::filesystem::create_directories(path);
+            return path;
+        }();
+        return dir;
+    }
+
+    // An input mesh and the derived data some benchmarks need, built on
+    // first use so that only the selected benchmarks pay for them
+    class Input {
+    public:
+        Input(std::string name, Shape shape, Size size, std::function<pmp::SurfaceMesh()> make)
+            : name_(std::move(name)), shape_(shape), size_(size), make_(std::move(make)) {}
+
+        const std::string &name() const { return name_; }
+        Shape              shape() const { return shape_; }
+        Size               size() const { return size_; }
+
+        const pmp::SurfaceMesh &mesh() {
+            if (!mesh_) {
+                mesh_ = make_();
+            }
+            return *mesh_;
+        }
+
+        pmp::Scalar edge_length() {
+            if (!edge_length_) {
+                edge_length_ = pmp::mean_edge_length(mesh());
+            }
+            return *edge_length_;
+        }
+
+        const std::filesystem::path &obj() {
+            if (obj_.empty()) {
+                obj_ = scratch_dir() / (name_ + ".obj");
+                pmp::write(mesh(), obj_, pmp::IOFlags());
+            }
+            return obj_;
+        }
+
+        const std::filesystem::path &stl() {
+            if (stl_.empty()) {
+                using pmp_rosetta::detail::StlTriangle;
+                stl_ = scratch_dir() / (name_ + ".stl");
+                std::vector<StlTriangle> triangles;
+                for (auto f : mesh().faces()) {
+                    auto &t = triangles.emplace_back();
+                    auto  k = 0;
+                    for (auto v : mesh().vertices(f)) {
+                        const auto &p = mesh().position(v);
+                        t[k++]        = {p[0], p[1], p[2]};
+                    }
+                }
+                pmp_rosetta::detail::StlWriter writer(stl_.string());
+                writer.write(triangles, std::vector<std::uint16_t>(triangles.size(), 0));
+                writer.finish();
+            }
+            return stl_;
+        }
+
+        const std::filesystem::path &snapshot() {
+            if (snapshot_.empty()) {
+                snapshot_ = scratch_dir() / (name_ + ".pmps");
+                save_snapshot(mesh(), snapshot_);
+            }
+            return snapshot_;
+        }
+
+        // Flat points (3 per vertex) and triangle corners, as exported
+        const std::vector<pmp::Scalar> &points() {
+            if (points_.empty()) {
+                points_.resize(3 * mesh().n_vertices());
+                export_points(mesh(), std::uintptr_t(points_.data()), points_.size());
+            }
+            return points_;
+        }
+
+        const std::vector<std::int64_t> &triangles() {
+            if (triangles_.empty()) {
+                std::vector<pmp::IndexType> indices(n_face_indices(mesh()));
+                export_faces(mesh(), std::uintptr_t(indices.data()), indices.size(), 0, 0, true);
+                triangles_.assign(indices.begin(), indices.end());
+            }
+            return triangles_;
+        }
+
+        LaplacianSystem &laplacian() {
+            if (!laplacian_) {
+                laplacian_.emplace(mesh(), false);
+            }
+            return *laplacian_;
+        }
+
+        const RemeshingReference &reference() {
+            if (!reference_) {
+                reference_.emplace(mesh());
+            }
+            return *reference_;
+        }
+
+        const MeshBVH &bvh() {
+            if (!bvh_) {
+                bvh_.emplace(mesh());
+            }
+            return *bvh_;
+        }
+
+        const CompactMesh &compact() {
+            if (!compact_) {
+                compact_.emplace(mesh(), 16, 0);
+            }
+            return *compact_;
+        }
+
+        // Levels at 1/2, 1/4 and 1/8 of the vertices
+        const LodChain &lod_chain() {
+            if (!lod_chain_) {
+                lod_chain_.emplace(mesh(), lod_targets(mesh()), 0);
+            }
+            return *lod_chain_;
+        }
+
+        static std::vector<unsigned int> lod_targets(const pmp::SurfaceMesh &mesh) {
+            const auto n = unsigned(mesh.n_vertices());
+            return {n / 2, n / 4, n / 8};
+        }
+
+    private:
+        std::string                       name_;
+        Shape                             shape_;
+        Size                              size_;
+        std::function<pmp::SurfaceMesh()> make_;
+        std::optional<pmp::SurfaceMesh>   mesh_;
+        std::optional<pmp::Scalar>        edge_length_;
+        std::filesystem::path             obj_, stl_, snapshot_;
+        std::vector<pmp::Scalar>          points_;
+        std::vector<std::int64_t>         triangles_;
+        std::optional<LaplacianSystem>    laplacian_;
+        std::optional<RemeshingReference> reference_;
+        std::optional<MeshBVH>            bvh_;
+        std::optional<CompactMesh>        compact_;
+        std::optional<LodChain>           lod_chain_;
+    };
+
+    pmp::SurfaceMesh triangulated(pmp::SurfaceMesh mesh) {
+        pmp::triangulate(mesh);
+        return mesh;
+    }
+
+    pmp::SurfaceMesh uv_sphere(std::size_t n) {
+        return pmp::uv_sphere(pmp::Point(0, 0, 0), 1, n, n);
+    }
+
+    pmp::SurfaceMesh subdivided_icosahedron(unsigned int n_subdivisions) {
+        auto mesh = pmp::icosahedron();
+        for (unsigned int i = 0; i < n_subdivisions; ++i) {
+            pmp::loop_subdivision(mesh);
+        }
+        return mesh;
+    }
+
+    // Triangulated uv sphere without the triangle fan of one pole, i.e. a disk
+    pmp::SurfaceMesh open_sphere(std::size_t n) {
+        auto        mesh = triangulated(uv_sphere(n));
+        pmp::Vertex pole;
+        for (auto v : mesh.vertices()) {
+            if (!pole.is_valid() || mesh.valence(v) > mesh.valence(pole)) {
+                pole = v;
+            }
+        }
+        mesh.delete_vertex(pole);
+        mesh.garbage_collection();
+        return mesh;
+    }
+
+    std::vector<std::unique_ptr<Input>> &inputs() {
+        static std::vector<std::unique_ptr<Input>> list = [] {
+            std::vector<std::unique_ptr<Input>> l;
+            const auto add = [&](std::string name, Shape shape, Size size, auto make) {
+                l.push_back(std::make_unique<Input>(std::move(name), shape, size, make));
+            };
+            add("bunny", Shape::Closed, Size::Small, [] {
+                pmp::SurfaceMesh mesh;
+                pmp::read(mesh, std::filesystem::path(PMP_BENCH_DATA_DIR) / "bunny.obj");
+                return mesh;
+            });
+            add("uv_sphere_64", Shape::Closed, Size::Small,
+                [] { return triangulated(uv_sphere(64)); });
+            add("uv_sphere_256", Shape::Closed, Size::Medium,
+                [] { return triangulated(uv_sphere(256)); });
+            add("uv_sphere_720", Shape::Closed, Size::Large,
+                [] { return triangulated(uv_sphere(720)); });
+            add("icosahedron_4", Shape::Closed, Size::Small,
+                [] { return subdivided_icosahedron(4); });
+            add("icosahedron_6", Shape::Closed, Size::Medium,
+                [] { return subdivided_icosahedron(6); });
+            add("icosahedron_8", Shape::Closed, Size::Large,
+                [] { return subdivided_icosahedron(8); });
+            add("open_sphere_64", Shape::Open, Size::Small, [] { return open_sphere(64); });
+            add("open_sphere_256", Shape::Open, Size::Medium, [] { return open_sphere(256); });
+            add("quad_sphere_64", Shape::Quad, Size::Small, [] { return uv_sphere(64); });
+            add("quad_sphere_256", Shape::Quad, Size::Medium, [] { return uv_sphere(256); });
+            add("quad_sphere_720", Shape::Quad, Size::Large, [] { return uv_sphere(720); });
+            return l;
+        }();
+        return list;
+    }
+
+    // Scratch output buffer, grown as needed and shared by the benchmarks
+    template <typename T> T *scratch(std::size_t n) {
+        static std::vector<T> buffer;
+        if (buffer.size() < n) {
+            buffer.resize(n);
+        }
+        return buffer.data();
+    }
+
+    // Cache of the cached_* benchmarks, unbounded
+    ResultCache &result_cache() {
+        static ResultCache cache((scratch_dir() / "cache").string(), 0);
+        return cache;
+    }
+
+    // Queue F(args...) on the job executor and wait for it, as the *_async
+    // functions do from Python; a failed job ends the run
+    template <auto F, typename... Args> void run_job(Args &&...args) {
+        const auto job = pmp_rosetta::Async<F>::submit(std::forward<Args>(args)...);
+        job.wait(-1);
+        if (!job.ok()) {
+            throw std::runtime_error(job.error());
+        }
+    }
+
+    // ------------------------------------------------------------------------
+    // Registration
+    // ------------------------------------------------------------------------
+
+    using MeshFunction = std::function<void(pmp::SurfaceMesh &, Input &)>;
+
+    enum class Mode {
+        Shared, // every iteration runs on the same working copy of the input
+        Fresh   // every iteration runs on a new copy, made outside the timing
+    };
+
+    void report(benchmark::State &state, double n_faces) {
+        state.counters["faces"]            = n_faces;
+        state.counters["faces_per_second"] =
+            benchmark::Counter(n_faces, benchmark::Counter::kIsIterationInvariantRate);
+        state.counters["peak_rss_mib"] = peak_rss_mib();
+    }
+
+    // Time fn on every input of the given shape up to max_size. prepare
+    // (optional) is applied to each fresh copy, untimed. One untimed run
+    // before the measurement builds the derived data fn pulls from the input.
+    void add(const std::string &function, Shape shape, Size max_size, Mode mode,
+             MeshFunction fn, MeshFunction prepare = {}) {
+        for (auto &input : inputs()) {
+            if (input->shape() != shape || input->size() > max_size) {
+                continue;
+            }
+            auto *in = input.get();
+            benchmark::RegisterBenchmark(
+                (function + "/" + in->name()).c_str(),
+                [in, mode, fn, prepare](benchmark::State &state) {
+                    const auto &source = in->mesh();
+                    const auto  copy   = [&](pmp::SurfaceMesh &mesh) {
+                        mesh = source;
+                        if (prepare) {
+                            prepare(mesh, *in);
+                        }
+                    };
+                    pmp::SurfaceMesh mesh;
+                    copy(mesh);
+                    fn(mesh, *in);
+                    copy(mesh);
+
+                    reset_peak_rss();
+                    for (auto _ : state) {
+                        if (mode == Mode::Fresh) {
+                            state.PauseTiming();
+                            copy(mesh);
+                            state.ResumeTiming();
+                        }
+                        fn(mesh, *in);
+                        benchmark::ClobberMemory();
+                    }
+                    report(state, double(source.n_faces()));
+                })
+                ->Unit(benchmark::kMillisecond)
+                ->UseRealTime();
+        }
+    }
+
+    // Time a shape generator at the resolutions of the generated inputs
+    void add_shape(const std::string &function,
+                   const std::function<pmp::SurfaceMesh(std::size_t)> &make) {
+        for (std::size_t n : {64, 256, 720}) {
+            benchmark::RegisterBenchmark((function + "/" + std::to_string(n)).c_str(),
+                                         [n, make](benchmark::State &state) {
+                                             reset_peak_rss();
+                                             std::size_t n_faces = 0;
+                                             for (auto _ : state) {
+                                                 const auto mesh = make(n);
+                                                 n_faces         = mesh.n_faces();
+                                             }
+                                             report(state, double(n_faces));
+                                         })
+                ->Unit(benchmark::kMillisecond)
+                ->UseRealTime();
+        }
+    }
+
+    // Check, untimed, that a reimplementation gives the same mesh as the
+    // PMP function it replaces on small inputs: same element counts, and
+    // positions equal up to rounding, vertex by vertex. Reported as
+    // "check/<function>/<input>", failed with an error on a mismatch.
+    using MeshEdit = std::function<void(pmp::SurfaceMesh &)>;
+
+    void add_check(const std::string &function, MeshEdit fn, MeshEdit reference,
+                   const std::vector<std::pair<std::string, pmp::SurfaceMesh>> &meshes) {
+        for (const auto &[name, input] : meshes) {
+            benchmark::RegisterBenchmark(
+                ("check/" + function + "/" + name).c_str(),
+                [input, fn, reference](benchmark::State &state) {
+                    pmp::SurfaceMesh result(input), expected(input);
+                    for (auto _ : state) {
+                        fn(result);
+                    }
+                    reference(expected);
+
+                    if (result.n_vertices() != expected.n_vertices() ||
+                        result.n_edges() != expected.n_edges() ||
+                        result.n_faces() != expected.n_faces()) {
+                        state.SkipWithError("element counts differ from the PMP function");
+                        return;
+                    }
+                    double max_error = 0;
+                    for (auto v : expected.vertices()) {
+                        max_error = std::max<double>(
+                            max_error, pmp::norm(result.position(v) - expected.position(v)));
+                    }
+                    state.counters["max_error"] = max_error;
+                    if (max_error > 1e-4 * pmp::bounds(expected).size()) {
+                        state.SkipWithError("positions differ from the PMP function");
+                    }
+                })
+                ->Iterations(1)
+                ->Unit(benchmark::kMillisecond);
+        }
+    }
+
+    // Mesh with garbage: some edges collapsed (which leaves the links of the
+    // deleted halfedges in place), then every 5th remaining face deleted
+    pmp::SurfaceMesh with_garbage(pmp::SurfaceMesh mesh) {
+        for (auto h : mesh.halfedges()) {
+            if (h.idx() % 7 == 0 && !mesh.is_deleted(h) && mesh.is_collapse_ok(h)) {
+                mesh.collapse(h);
+            }
+        }
+        for (auto f : mesh.faces()) {
+            if (f.idx() % 5 == 0) {
+                mesh.delete_face(f);
+            }
+        }
+        return mesh;
+    }
+
+    // First difference between a and b in the element slots, the deleted
+    // flags, or the links and positions of the live elements; empty if none
+    std::string connectivity_difference(const pmp::SurfaceMesh &a, const pmp::SurfaceMesh &b) {
+        if (a.vertices_size() != b.vertices_size() || a.edges_size() != b.edges_size() ||
+            a.faces_size() != b.faces_size() || a.n_vertices() != b.n_vertices() ||
+            a.n_edges() != b.n_edges() || a.n_faces() != b.n_faces() ||
+            a.has_garbage() != b.has_garbage()) {
+            return "element counts differ";
+        }
+        for (auto h : a.halfedges()) {
+            if (b.is_deleted(h) || a.next_halfedge(h) != b.next_halfedge(h) ||
+                a.prev_halfedge(h) != b.prev_halfedge(h) || a.to_vertex(h) != b.to_vertex(h) ||
+                a.face(h) != b.face(h)) {
+                return "links of halfedge " + std::to_string(h.idx()) + " differ";
+            }
+        }
+        for (auto v : a.vertices()) {
+            if (b.is_deleted(v) || a.halfedge(v) != b.halfedge(v) ||
+                a.position(v) != b.position(v)) {
+                return "vertex " + std::to_string(v.idx()) + " differs";
+            }
+        }
+        for (auto f : a.faces()) {
+            if (b.is_deleted(f) || a.halfedge(f) != b.halfedge(f)) {
+                return "face " + std::to_string(f.idx()) + " differs";
+            }
+        }
+        return {};
+    }
+
+    // Check, untimed, that copy(dst, input) makes dst the same mesh as input,
+    // both for an empty dst and for a dst holding a larger mesh. Reported as
+    // "check/<function>/<input>".
+    using MeshCopy = std::function<void(pmp::SurfaceMesh &, const pmp::SurfaceMesh &)>;
+
+    void add_copy_check(const std::string &function, MeshCopy copy,
+                        const std::vector<std::pair<std::string, pmp::SurfaceMesh>> &meshes) {
+        for (const auto &[name, input] : meshes) {
+            benchmark::RegisterBenchmark(
+                ("check/" + function + "/" + name).c_str(),
+                [input, copy](benchmark::State &state) {
+                    pmp::SurfaceMesh empty, larger = subdivided_icosahedron(4);
+                    for (auto _ : state) {
+                        copy(empty, input);
+                        copy(larger, input);
+                    }
+                    for (const auto *dst : {&empty, &larger}) {
+                        if (const auto error = connectivity_difference(input, *dst);
+                            !error.empty()) {
+                            state.SkipWithError(error.c_str());
+                            return;
+                        }
+                    }
+                })
+                ->Iterations(1)
+                ->Unit(benchmark::kMillisecond);
+        }
+    }
+
+    // Check, untimed, that fn and the PMP function it replaces give the same
+    // mesh on small inputs, as judged by difference(result, expected): the
+    // first difference found, or empty if none. Reported as
+    // "check/<function>/<input>".
+    using MeshDifference =
+        std::function<std::string(const pmp::SurfaceMesh &, const pmp::SurfaceMesh &)>;
+
+    void add_difference_check(const std::string &function, MeshEdit fn, MeshEdit reference,
+                              MeshDifference difference,
+                              const std::vector<std::pair<std::string, pmp::SurfaceMesh>> &meshes) {
+        for (const auto &[name, input] : meshes) {
+            benchmark::RegisterBenchmark(
+                ("check/" + function + "/" + name).c_str(),
+                [input, fn, reference, difference](benchmark::State &state) {
+                    pmp::SurfaceMesh result(input), expected(input);
+                    for (auto _ : state) {
+                        fn(result);
+                    }
+                    reference(expected);
+                    if (const auto error = difference(result, expected); !error.empty()) {
+                        state.SkipWithError(error.c_str());
+                    }
+                })
+                ->Iterations(1)
+                ->Unit(benchmark::kMillisecond);
+        }
+    }
+
+    // First edge or vertex whose feature flag differs between a and b
+    std::string feature_difference(const pmp::SurfaceMesh &a, const pmp::SurfaceMesh &b) {
+        const auto ea = a.get_edge_property<bool>("e:feature");
+        const auto eb = b.get_edge_property<bool>("e:feature");
+        const auto va = a.get_vertex_property<bool>("v:feature");
+        const auto vb = b.get_vertex_property<bool>("v:feature");
+        if (!ea || !eb || !va || !vb) {
+            return "feature properties missing";
+        }
+        for (auto e : b.edges()) {
+            if (ea[e] != eb[e]) {
+                return "feature flag of edge " + std::to_string(e.idx()) + " differs";
+            }
+        }
+        for (auto v : b.vertices()) {
+            if (va[v] != vb[v]) {
+                return "feature flag of vertex " + std::to_string(v.idx()) + " differs";
+            }
+        }
+        return {};
+    }
+
+    // mesh with every vertex slot numbered in a "v:check" property, so that
+    // compactions numbering the kept elements differently can be compared
+    pmp::SurfaceMesh numbered(pmp::SurfaceMesh mesh) {
+        auto check = mesh.vertex_property<int>("v:check");
+        for (auto v : mesh.vertices()) {
+            check[v] = int(v.idx());
+        }
+        return mesh;
+    }
+
+    // First difference between two compactions of a numbered() mesh, whatever
+    // order each gave the kept elements: the vertices with their number and
+    // position, and the faces as cycles of vertex numbers
+    std::string compaction_difference(const pmp::SurfaceMesh &a, const pmp::SurfaceMesh &b) {
+        if (a.has_garbage() || b.has_garbage()) {
+            return "garbage left";
+        }
+        if (a.n_vertices() != b.n_vertices() || a.n_edges() != b.n_edges() ||
+            a.n_faces() != b.n_faces()) {
+            return "element counts differ from the PMP function";
+        }
+        using Vertex = std::tuple<int, pmp::Scalar, pmp::Scalar, pmp::Scalar>;
+        const auto vertices = [](const pmp::SurfaceMesh &m) {
+            const auto          check = m.get_vertex_property<int>("v:check");
+            std::vector<Vertex> list;
+            for (auto v : m.vertices()) {
+                const auto &p = m.position(v);
+                list.emplace_back(check[v], p[0], p[1], p[2]);
+            }
+            std::sort(list.begin(), list.end());
+            return list;
+        };
+        const auto faces = [](const pmp::SurfaceMesh &m) {
+            const auto                    check = m.get_vertex_property<int>("v:check");
+            std::vector<std::vector<int>> list;
+            for (auto f : m.faces()) {
+                auto &cycle = list.emplace_back();
+                for (auto v : m.vertices(f)) {
+                    cycle.push_back(check[v]);
+                }
+                std::rotate(cycle.begin(), std::min_element(cycle.begin(), cycle.end()),
+                            cycle.end());
+            }
+            std::sort(list.begin(), list.end());
+            return list;
+        };
+        if (!a.get_vertex_property<int>("v:check") || !b.get_vertex_property<int>("v:check")) {
+            return "v:check property lost";
+        }
+        if (vertices(a) != vertices(b)) {
+            return "kept vertices or their properties differ from the PMP function";
+        }
+        if (faces(a) != faces(b)) {
+            return "faces differ from the PMP function";
+        }
+        return {};
+    }
+
+    // Largest distance from a vertex of input to the surface of mesh
+    double surface_error(const pmp::SurfaceMesh &input, const pmp::SurfaceMesh &mesh) {
+        const pmp_rosetta::TriangleBVH bvh(mesh);
+        double                         error = 0;
+        for (auto v : input.vertices()) {
+            error = std::max<double>(error, bvh.nearest(input.position(v)).distance);
+        }
+        return error;
+    }
+
+    // Check, untimed, that fn matches the PMP function it replaces where the
+    // two do not give the same elements (remeshing and decimation decide on
+    // rounded positions, in another order): the face counts may differ by
+    // face_tolerance (relative), and the largest distance from the input
+    // vertices to the result by error_ratio times that of the PMP result.
+    // Reported as "check/<function>/<input>".
+    void add_surface_check(const std::string &function, MeshEdit fn, MeshEdit reference,
+                           double face_tolerance, double error_ratio,
+                           const std::vector<std::pair<std::string, pmp::SurfaceMesh>> &meshes) {
+        for (const auto &[name, input] : meshes) {
+            benchmark::RegisterBenchmark(
+                ("check/" + function + "/" + name).c_str(),
+                [input, fn, reference, face_tolerance, error_ratio](benchmark::State &state) {
+                    pmp::SurfaceMesh result(input), expected(input);
+                    for (auto _ : state) {
+                        fn(result);
+                    }
+                    reference(expected);
+
+                    const double faces          = double(result.n_faces());
+                    const double expected_faces = std::max(double(expected.n_faces()), 1.0);
+                    const double error          = surface_error(input, result);
+                    const double expected_error = surface_error(input, expected);
+
+                    state.counters["face_ratio"]     = faces / expected_faces;
+                    state.counters["error"]          = error;
+                    state.counters["expected_error"] = expected_error;
+                    if (std::abs(faces - expected_faces) > face_tolerance * expected_faces) {
+                        state.SkipWithError("face count differs from the PMP function");
+                    } else if (error >
+                               error_ratio * expected_error + 1e-4 * pmp::bounds(input).size()) {
+                        state.SkipWithError("error exceeds that of the PMP function");
+                    }
+                })
+                ->Iterations(1)
+                ->Unit(benchmark::kMillisecond);
+        }
+    }
+
+    void first_boundary_fill(pmp::SurfaceMesh &mesh) {
+        for (auto h : mesh.halfedges()) {
+            if (mesh.is_boundary(h)) {
+                pmp::fill_hole(mesh, h);
+                return;
+            }
+        }
+    }
+
+    void register_benchmarks() {
+        const auto interpolate = pmp::BoundaryHandling::Interpolate;
+        const auto closed      = Shape::Closed;
+        const auto open        = Shape::Open;
+        const auto quad        = Shape::Quad;
+        const auto medium      = Size::Medium;
+        const auto large       = Size::Large;
+        const auto shared      = Mode::Shared;
+        const auto fresh       = Mode::Fresh;
+
+        // IO
+        add("read", closed, large, shared, [](auto &m, auto &in) { pmp::read(m, in.obj()); });
+        add("read_mesh", closed, large, shared,
+            [](auto &m, auto &in) { read_mesh(m, in.obj(), ReadFlags()); });
+        add("read_mesh_stl", closed, large, shared,
+            [](auto &m, auto &in) { read_mesh(m, in.stl(), ReadFlags()); });
+        add("load_mesh", closed, large, shared, [](auto &m, auto &in) { load_mesh(m, in.obj()); });
+        add("write", closed, large, shared, [](auto &m, auto &in) {
+            pmp::write(m, scratch_dir() / ("write_" + in.name() + ".obj"), pmp::IOFlags());
+        });
+        add("save_snapshot", closed, large, shared, [](auto &m, auto &in) {
+            save_snapshot(m, scratch_dir() / ("save_" + in.name() + ".pmps"));
+        });
+        add("open_snapshot", closed, large, shared,
+            [](auto &m, auto &in) { open_snapshot(m, in.snapshot()); });
+        add("MeshSnapshot.to_mesh", closed, large, shared,
+            [](auto &m, auto &in) { MeshSnapshot(in.snapshot().string()).to_mesh(m); });
+
+        // Copies and compaction
+        add("copy_mesh", closed, large, shared, [](auto &m, auto &) {
+            auto copy = copy_mesh(m);
+            benchmark::DoNotOptimize(copy);
+        });
+        add("copy_mesh_into", closed, large, shared, [](auto &m, auto &) {
+            static pmp::SurfaceMesh dst;
+            copy_mesh_into(dst, m);
+        });
+        add(
+            "parallel_garbage_collection", closed, large, fresh,
+            [](auto &m, auto &) { parallel_garbage_collection(m, 0); },
+            [](auto &m, auto &) {
+                for (auto f : m.faces()) {
+                    if (f.idx() % 16 == 0) {
+                        m.delete_face(f);
+                    }
+                }
+            });
+
+        // Buffers and properties
+        add("build_mesh", closed, large, shared, [](auto &m, auto &in) {
+            build_mesh(m, std::uintptr_t(in.points().data()), in.points().size() / 3,
+                       std::uintptr_t(in.triangles().data()), in.triangles().size(), 3);
+        });
+        add("export_points", closed, large, shared, [](auto &m, auto &) {
+            const auto n = 3 * m.n_vertices();
+            export_points(m, std::uintptr_t(scratch<pmp::Scalar>(n)), n);
+        });
+        add("export_faces", closed, large, shared, [](auto &m, auto &) {
+            const auto n = n_face_indices(m);
+            export_faces(m, std::uintptr_t(scratch<pmp::IndexType>(n)), n, 0, 0, true);
+        });
+        add("export_curvatures", closed, large, shared, [](auto &m, auto &) {
+            const auto n    = m.n_vertices();
+            auto      *out  = scratch<pmp::Scalar>(2 * n);
+            const auto mean = std::uintptr_t(out), gauss = std::uintptr_t(out + n);
+            export_curvatures(m, 0, 0, mean, gauss, n, 0);
+        });
+        add("export_vertex_normals", closed, large, shared, [](auto &m, auto &) {
+            const auto n = 3 * m.n_vertices();
+            export_vertex_normals(m, std::uintptr_t(scratch<pmp::Scalar>(n)), n, 0);
+        });
+        add("export_face_normals", closed, large, shared, [](auto &m, auto &) {
+            const auto n = 3 * m.n_faces();
+            export_face_normals(m, std::uintptr_t(scratch<pmp::Scalar>(n)), n, 0);
+        });
+        add("export_vertex_areas", closed, large, shared, [](auto &m, auto &) {
+            const auto n = m.n_vertices();
+            export_vertex_areas(m, std::uintptr_t(scratch<pmp::Scalar>(n)), n, 0);
+        });
+        add("export_render_buffers", closed, large, shared, [](auto &m, auto &) {
+            const auto n = n_render_indices(m, false);
+            export_render_buffers(m, std::uintptr_t(scratch<pmp::Scalar>(6 * m.n_vertices())),
+                                  6 * m.n_vertices(), std::uintptr_t(scratch<pmp::IndexType>(n)),
+                                  n, false, 0);
+        });
+        add("export_render_buffers_vtk", closed, large, shared, [](auto &m, auto &) {
+            const auto n = n_render_indices(m, true);
+            export_render_buffers(m, std::uintptr_t(scratch<pmp::Scalar>(6 * m.n_vertices())),
+                                  6 * m.n_vertices(), std::uintptr_t(scratch<std::int64_t>(n)), n,
+                                  true, 0);
+        });
+        add("read_property", closed, large, shared, [](auto &m, auto &) {
+            const auto n = 3 * m.vertices_size();
+            read_property(m, "v", "v:point", std::uintptr_t(scratch<pmp::Scalar>(n)), n);
+        });
+        add("write_property", closed, large, shared, [](auto &m, auto &in) {
+            write_property(m, "v", "v:bench", "float32", 3, std::uintptr_t(in.points().data()),
+                           m.vertices_size());
+        });
+
+        // Quantized storage, 16 bits per coordinate
+        add("CompactMesh", closed, large, shared, [](auto &m, auto &) {
+            CompactMesh compact(m, 16, 0);
+            benchmark::DoNotOptimize(compact);
+        });
+        add("export_compact_points", closed, large, shared, [](auto &, auto &in) {
+            const auto n = 3 * in.compact().n_vertices();
+            export_compact_points(in.compact(), std::uintptr_t(scratch<pmp::Scalar>(n)), n, 0);
+        });
+        add("export_compact_faces", closed, large, shared, [](auto &, auto &in) {
+            const auto n = in.compact().n_face_indices();
+            export_compact_faces(in.compact(), std::uintptr_t(scratch<pmp::IndexType>(n)), n, 0,
+                                 0, 0);
+        });
+        add("expand_compact_mesh", closed, large, shared,
+            [](auto &m, auto &in) { expand_compact_mesh(m, in.compact(), 0); });
+
+        // Decimation
+        add("decimate", closed, medium, fresh,
+            [](auto &m, auto &) { pmp::decimate(m, m.n_vertices() / 4); });
+        add("parallel_decimate", closed, medium, fresh,
+            [](auto &m, auto &) { parallel_decimate(m, m.n_vertices() / 4, 0, false); });
+        add("build_lod_chain", closed, medium, shared, [](auto &m, auto &) {
+            auto chain = build_lod_chain(m, Input::lod_targets(m), 0);
+            benchmark::DoNotOptimize(chain);
+        });
+        add("write_lod_chain", closed, medium, shared, [](auto &, auto &in) {
+            std::vector<std::string> paths;
+            for (int i = 0; i < 3; ++i) {
+                paths.push_back(
+                    (scratch_dir() / ("lod_" + in.name() + std::to_string(i) + ".obj")).string());
+            }
+            write_lod_chain(in.lod_chain(), paths, pmp::IOFlags(), 0);
+        });
+
+        // Smoothing
+        add("explicit_smoothing", closed, large, fresh,
+            [](auto &m, auto &) { pmp::explicit_smoothing(m, 10, false); });
+        add("parallel_explicit_smoothing", closed, large, fresh,
+            [](auto &m, auto &) { parallel_explicit_smoothing(m, 10, false, 0); });
+        add("implicit_smoothing", closed, medium, fresh,
+            [](auto &m, auto &) { pmp::implicit_smoothing(m, 0.001, 1, false, true); });
+        add("LaplacianSystem", closed, medium, shared, [](auto &m, auto &) {
+            LaplacianSystem system(m, false);
+            benchmark::DoNotOptimize(system);
+        });
+        add("LaplacianSystem.implicit_smoothing", closed, medium, fresh,
+            [](auto &m, auto &in) { in.laplacian().implicit_smoothing(m, 0.001, 1, true); });
+
+        // Remeshing, a few iterations at the mean edge length of the input
+        add("uniform_remeshing", closed, medium, fresh,
+            [](auto &m, auto &in) { pmp::uniform_remeshing(m, in.edge_length(), 3, true); });
+        add("adaptive_remeshing", closed, medium, fresh, [](auto &m, auto &in) {
+            const auto l = in.edge_length();
+            pmp::adaptive_remeshing(m, 0.5f * l, 2 * l, 0.1f * l, 3, true);
+        });
+        add("parallel_uniform_remeshing", closed, medium, fresh,
+            [](auto &m, auto &in) { parallel_uniform_remeshing(m, in.edge_length(), 3, true, 0); });
+        add("parallel_adaptive_remeshing", closed, medium, fresh, [](auto &m, auto &in) {
+            const auto l = in.edge_length();
+            parallel_adaptive_remeshing(m, 0.5f * l, 2 * l, 0.1f * l, 3, true, 0);
+        });
+        add("RemeshingReference", closed, medium, shared, [](auto &m, auto &) {
+            RemeshingReference reference(m);
+            benchmark::DoNotOptimize(reference);
+        });
+        add("Remesher", closed, medium, shared, [](auto &m, auto &in) {
+            Remesher remesher(m, in.reference(), 0);
+            remesher.set_uniform(in.edge_length());
+            remesher.start(3, 3);
+            remesher.wait(-1);
+        });
+        add("uniform_remeshing_onto", closed, medium, fresh, [](auto &m, auto &in) {
+            uniform_remeshing_onto(m, in.reference(), in.edge_length(), 3, 0);
+        });
+        add("adaptive_remeshing_onto", closed, medium, fresh, [](auto &m, auto &in) {
+            const auto l = in.edge_length();
+            adaptive_remeshing_onto(m, in.reference(), 0.5f * l, 2 * l, 0.1f * l, 3, 0);
+        });
+
+        // Subdivision and triangulation
+        add("loop_subdivision", closed, medium, fresh,
+            [](auto &m, auto &) { pmp::loop_subdivision(m); });
+        add("catmull_clark_subdivision", quad, medium, fresh,
+            [](auto &m, auto &) { pmp::catmull_clark_subdivision(m); });
+        add("quad_tri_subdivision", quad, medium, fresh,
+            [](auto &m, auto &) { pmp::quad_tri_subdivision(m); });
+        add("parallel_loop_subdivision", closed, medium, fresh, [](auto &m, auto &) {
+            parallel_loop_subdivision(m, pmp::BoundaryHandling::Interpolate, 0);
+        });
+        add("parallel_catmull_clark_subdivision", quad, medium, fresh, [](auto &m, auto &) {
+            parallel_catmull_clark_subdivision(m, pmp::BoundaryHandling::Interpolate, 0);
+        });
+        add("parallel_quad_tri_subdivision", quad, medium, fresh, [](auto &m, auto &) {
+            parallel_quad_tri_subdivision(m, pmp::BoundaryHandling::Interpolate, 0);
+        });
+        add("triangulate", quad, large, fresh, [](auto &m, auto &) { pmp::triangulate(m); });
+
+        // Differential geometry and features
+        add("vertex_normals", closed, large, shared,
+            [](auto &m, auto &) { pmp::vertex_normals(m); });
+        add("face_normals", closed, large, shared, [](auto &m, auto &) { pmp::face_normals(m); });
+        add("curvature", closed, large, shared,
+            [](auto &m, auto &) { pmp::curvature(m, pmp::Curvature::mean); });
+        add("detect_features", closed, large, shared,
+            [](auto &m, auto &) { pmp::detect_features(m, 25); });
+        add("parallel_detect_features", closed, large, shared,
+            [](auto &m, auto &) { parallel_detect_features(m, 25, 0); });
+        add("bounds", closed, large, shared,
+            [](auto &m, auto &) { benchmark::DoNotOptimize(pmp::bounds(m)); });
+        add("surface_area", closed, large, shared,
+            [](auto &m, auto &) { benchmark::DoNotOptimize(pmp::surface_area(m)); });
+        add("volume", closed, large, shared,
+            [](auto &m, auto &) { benchmark::DoNotOptimize(pmp::volume(m)); });
+        add("centroid", closed, large, shared,
+            [](auto &m, auto &) { benchmark::DoNotOptimize(pmp::centroid(m)); });
+        add("flip_faces", closed, large, shared, [](auto &m, auto &) { pmp::flip_faces(m); });
+
+        // Hole filling and parameterization, on disks
+        add("fill_hole", open, medium, fresh, [](auto &m, auto &) { first_boundary_fill(m); });
+        add("harmonic_parameterization", open, medium, shared,
+            [](auto &m, auto &) { pmp::harmonic_parameterization(m, false); });
+        add("lscm_parameterization", open, medium, shared,
+            [](auto &m, auto &) { pmp::lscm_parameterization(m); });
+        add("LaplacianSystem.harmonic_parameterization", open, medium, shared,
+            [](auto &m, auto &in) { in.laplacian().harmonic_parameterization(m); });
+        add("LaplacianSystem.lscm_parameterization", open, medium, shared,
+            [](auto &m, auto &in) { in.laplacian().lscm_parameterization(m); });
+
+        // Geodesics: 16 single-seed distance fields
+        add("geodesic_distances", closed, medium, shared, [](auto &m, auto &) {
+            constexpr std::size_t       n_sets = 16;
+            std::vector<pmp::IndexType> seeds(n_sets), offsets(n_sets + 1);
+            for (std::size_t i = 0; i < n_sets; ++i) {
+                seeds[i]       = pmp::IndexType(i * m.n_vertices() / n_sets);
+                offsets[i + 1] = pmp::IndexType(i + 1);
+            }
+            const auto capacity = n_sets * m.n_vertices();
+            geodesic_distances(m, std::uintptr_t(seeds.data()), n_sets,
+                               std::uintptr_t(offsets.data()), n_sets,
+                               std::uintptr_t(scratch<pmp::Scalar>(capacity)), capacity,
+                               std::numeric_limits<pmp::Scalar>::max(), 0);
+        });
+
+        // Spatial queries, one per vertex: points pushed 10% outwards, and
+        // rays from the centroid through every vertex
+        add("MeshBVH", closed, large, shared, [](auto &m, auto &) {
+            MeshBVH bvh(m);
+            benchmark::DoNotOptimize(bvh);
+        });
+        add("MeshBVH.closest_points", closed, large, shared, [](auto &, auto &in) {
+            const auto &p = in.points();
+            const auto  n = p.size() / 3;
+            auto       *q = scratch<pmp::Scalar>(5 * n);
+            std::transform(p.begin(), p.end(), q, [](pmp::Scalar x) { return 1.1f * x; });
+            in.bvh().closest_points(std::uintptr_t(q), n, std::uintptr_t(q + 3 * n),
+                                    std::uintptr_t(q + 4 * n), 0, 0);
+        });
+        add("MeshBVH.ray_intersect", closed, large, shared, [](auto &m, auto &in) {
+            const auto &p = in.points();
+            const auto  n = p.size() / 3;
+            const auto  c = pmp::centroid(m);
+            auto       *q = scratch<pmp::Scalar>(7 * n);
+            for (std::size_t i = 0; i < n; ++i) {
+                for (int k = 0; k < 3; ++k) {
+                    q[3 * i + k]       = c[k];
+                    q[3 * (n + i) + k] = p[3 * i + k] - c[k];
+                }
+            }
+            in.bvh().ray_intersect(std::uintptr_t(q), std::uintptr_t(q + 3 * n), n,
+                                   std::uintptr_t(q + 6 * n), 0, 0);
+        });
+        add("MeshBVH.winding_numbers", closed, medium, shared, [](auto &, auto &in) {
+            const auto &p = in.points();
+            const auto  n = p.size() / 3;
+            auto       *q = scratch<pmp::Scalar>(4 * n);
+            std::transform(p.begin(), p.end(), q, [](pmp::Scalar x) { return 0.9f * x; });
+            in.bvh().winding_numbers(std::uintptr_t(q), n, std::uintptr_t(q + 3 * n), 2, 0);
+        });
+
+        // File pipelines: decimation to half the vertices
+        add("process_batch", closed, medium, shared, [](auto &, auto &in) {
+            BatchPipeline pipeline;
+            pipeline.decimate_ratio = 0.5f;
+            process_batch({in.obj().string()},
+                          {(scratch_dir() / ("batch_" + in.name() + ".obj")).string()}, pipeline,
+                          0);
+        });
+        add("process_tiled", closed, medium, shared, [](auto &m, auto &in) {
+            TiledPipeline pipeline;
+            pipeline.tile_triangles = std::max<std::size_t>(m.n_faces() / 8, 1024);
+            pipeline.decimate_ratio = 0.5f;
+            process_tiled(in.stl().string(),
+                          (scratch_dir() / ("tiled_" + in.name() + ".stl")).string(), pipeline,
+                          0);
+        });
+
+        // Content hashes, and the cached algorithms on cache hits: the untimed
+        // first run stores the result every timed run loads
+        add("mesh_content_hash", closed, large, shared,
+            [](auto &m, auto &) { benchmark::DoNotOptimize(mesh_content_hash(m, 0)); });
+        add("result_key", closed, large, shared,
+            [](auto &m, auto &) { benchmark::DoNotOptimize(result_key(m, "bench", "")); });
+        add("cached_uniform_remeshing", closed, medium, fresh, [](auto &m, auto &in) {
+            cached_uniform_remeshing(m, result_cache(), in.edge_length(), 3, true);
+        });
+        add("cached_adaptive_remeshing", closed, medium, fresh, [](auto &m, auto &in) {
+            const auto l = in.edge_length();
+            cached_adaptive_remeshing(m, result_cache(), 0.5f * l, 2 * l, 0.1f * l, 3, true);
+        });
+        add("cached_decimate", closed, medium, fresh, [](auto &m, auto &) {
+            cached_decimate(m, result_cache(), m.n_vertices() / 4, 0, 0, 0, 0, 0, 1e-2f, 1);
+        });
+        add("cached_loop_subdivision", closed, medium, fresh,
+            [=](auto &m, auto &) { cached_loop_subdivision(m, result_cache(), interpolate); });
+        add("cached_catmull_clark_subdivision", quad, medium, fresh, [=](auto &m, auto &) {
+            cached_catmull_clark_subdivision(m, result_cache(), interpolate);
+        });
+        add("cached_quad_tri_subdivision", quad, medium, fresh,
+            [=](auto &m, auto &) { cached_quad_tri_subdivision(m, result_cache(), interpolate); });
+
+        // The *_async functions, from submission to completion, with the
+        // arguments of the synchronous benchmarks above
+        add("decimate_async", closed, medium, fresh, [](auto &m, auto &) {
+            run_job<&pmp::decimate>(m, m.n_vertices() / 4, 0, 0, 0, 0, 0, 1e-2f, 1);
+        });
+        add("parallel_decimate_async", closed, medium, fresh, [](auto &m, auto &) {
+            run_job<&parallel_decimate>(m, m.n_vertices() / 4, 0, false);
+        });
+        add("build_lod_chain_async", closed, medium, shared, [](auto &m, auto &) {
+            run_job<&build_lod_chain>(m, Input::lod_targets(m), 0);
+        });
+        add("explicit_smoothing_async", closed, large, fresh,
+            [](auto &m, auto &) { run_job<&pmp::explicit_smoothing>(m, 10, false); });
+        add("implicit_smoothing_async", closed, medium, fresh, [](auto &m, auto &) {
+            run_job<&pmp::implicit_smoothing>(m, 0.001f, 1, false, true);
+        });
+        add("parallel_explicit_smoothing_async", closed, large, fresh,
+            [](auto &m, auto &) { run_job<&parallel_explicit_smoothing>(m, 10, false, 0); });
+        add("uniform_remeshing_async", closed, medium, fresh, [](auto &m, auto &in) {
+            run_job<&pmp::uniform_remeshing>(m, in.edge_length(), 3, true);
+        });
+        add("adaptive_remeshing_async", closed, medium, fresh, [](auto &m, auto &in) {
+            const auto l = in.edge_length();
+            run_job<&pmp::adaptive_remeshing>(m, 0.5f * l, 2 * l, 0.1f * l, 3, true);
+        });
+        add("parallel_uniform_remeshing_async", closed, medium, fresh, [](auto &m, auto &in) {
+            run_job<&parallel_uniform_remeshing>(m, in.edge_length(), 3, true, 0);
+        });
+        add("parallel_adaptive_remeshing_async", closed, medium, fresh, [](auto &m, auto &in) {
+            const auto l = in.edge_length();
+            run_job<&parallel_adaptive_remeshing>(m, 0.5f * l, 2 * l, 0.1f * l, 3, true, 0);
+        });
+        add("uniform_remeshing_onto_async", closed, medium, fresh, [](auto &m, auto &in) {
+            run_job<&uniform_remeshing_onto>(m, in.reference(), in.edge_length(), 3, 0);
+        });
+        add("adaptive_remeshing_onto_async", closed, medium, fresh, [](auto &m, auto &in) {
+            const auto l = in.edge_length();
+            run_job<&adaptive_remeshing_onto>(m, in.reference(), 0.5f * l, 2 * l, 0.1f * l, 3,
+                                              0);
+        });
+        add("loop_subdivision_async", closed, medium, fresh,
+            [=](auto &m, auto &) { run_job<&pmp::loop_subdivision>(m, interpolate); });
+        add("catmull_clark_subdivision_async", quad, medium, fresh,
+            [=](auto &m, auto &) { run_job<&pmp::catmull_clark_subdivision>(m, interpolate); });
+        add("quad_tri_subdivision_async", quad, medium, fresh,
+            [=](auto &m, auto &) { run_job<&pmp::quad_tri_subdivision>(m, interpolate); });
+        add("parallel_loop_subdivision_async", closed, medium, fresh,
+            [=](auto &m, auto &) { run_job<&parallel_loop_subdivision>(m, interpolate, 0); });
+        add("parallel_catmull_clark_subdivision_async", quad, medium, fresh, [=](auto &m, auto &) {
+            run_job<&parallel_catmull_clark_subdivision>(m, interpolate, 0);
+        });
+        add("parallel_quad_tri_subdivision_async", quad, medium, fresh,
+            [=](auto &m, auto &) { run_job<&parallel_quad_tri_subdivision>(m, interpolate, 0); });
+        add("read_mesh_async", closed, large, shared,
+            [](auto &m, auto &in) { run_job<&read_mesh>(m, in.obj(), ReadFlags()); });
+        add("load_mesh_async", closed, large, shared,
+            [](auto &m, auto &in) { run_job<&load_mesh>(m, in.obj()); });
+
+        // The parallel subdivisions against PMP, on triangles, quads only
+        // (closed and open), and quads with triangle fans
+        add_check(
+            "parallel_loop_subdivision",
+            [=](auto &m) { parallel_loop_subdivision(m, interpolate, 0); },
+            [=](auto &m) { pmp::loop_subdivision(m, interpolate); },
+            {{"icosahedron_2", subdivided_icosahedron(2)}, {"open_sphere_16", open_sphere(16)}});
+        const std::vector<std::pair<std::string, pmp::SurfaceMesh>> quad_meshes = {
+            {"quad_sphere_2", pmp::quad_sphere(2)},
+            {"plane_8", pmp::plane(8)},
+            {"uv_sphere_16", uv_sphere(16)}};
+        add_check(
+            "parallel_catmull_clark_subdivision",
+            [=](auto &m) { parallel_catmull_clark_subdivision(m, interpolate, 0); },
+            [=](auto &m) { pmp::catmull_clark_subdivision(m, interpolate); }, quad_meshes);
+        add_check(
+            "parallel_quad_tri_subdivision",
+            [=](auto &m) { parallel_quad_tri_subdivision(m, interpolate, 0); },
+            [=](auto &m) { pmp::quad_tri_subdivision(m, interpolate); }, quad_meshes);
+
+        // Copies of compact meshes, made in place, and of meshes with garbage,
+        // whose deleted halfedges keep stale links
+        const std::vector<std::pair<std::string, pmp::SurfaceMesh>> garbage_meshes = {
+            {"icosahedron_3_garbage", with_garbage(subdivided_icosahedron(3))},
+            {"open_sphere_16_garbage", with_garbage(open_sphere(16))}};
+        auto copy_meshes = garbage_meshes;
+        copy_meshes.insert(copy_meshes.begin(), {{"icosahedron_3", subdivided_icosahedron(3)},
+                                                 {"open_sphere_16", open_sphere(16)}});
+        add_copy_check(
+            "copy_mesh_into", [](auto &dst, const auto &src) { copy_mesh_into(dst, src); },
+            copy_meshes);
+
+        // Compactions of the same meshes, whose kept elements PMP numbers in
+        // another order
+        add_difference_check(
+            "parallel_garbage_collection", [](auto &m) { parallel_garbage_collection(m, 0); },
+            [](auto &m) { m.garbage_collection(); }, compaction_difference,
+            {{"icosahedron_3_garbage", numbered(with_garbage(subdivided_icosahedron(3)))},
+             {"open_sphere_16_garbage", numbered(with_garbage(open_sphere(16)))}});
+
+        // Smoothing and feature detection, closed and open, triangles and
+        // (for the uniform Laplacian and features) quads
+        const std::vector<std::pair<std::string, pmp::SurfaceMesh>> triangle_meshes = {
+            {"icosahedron_2", subdivided_icosahedron(2)}, {"open_sphere_16", open_sphere(16)}};
+        auto mixed_meshes = triangle_meshes;
+        mixed_meshes.insert(mixed_meshes.end(), quad_meshes.begin(), quad_meshes.end());
+        add_check(
+            "parallel_explicit_smoothing/cotan",
+            [](auto &m) { parallel_explicit_smoothing(m, 10, false, 0); },
+            [](auto &m) { pmp::explicit_smoothing(m, 10, false); }, triangle_meshes);
+        add_check(
+            "parallel_explicit_smoothing/uniform",
+            [](auto &m) { parallel_explicit_smoothing(m, 10, true, 0); },
+            [](auto &m) { pmp::explicit_smoothing(m, 10, true); }, mixed_meshes);
+        mixed_meshes.emplace_back("hexahedron", pmp::hexahedron());
+        add_difference_check(
+            "parallel_detect_features", [](auto &m) { parallel_detect_features(m, 25, 0); },
+            [](auto &m) { pmp::detect_features(m, 25); }, feature_difference, mixed_meshes);
+
+        // Remeshing and decimation: same face counts within 5% and 2%, and at
+        // most twice the distance of the PMP result to the input
+        const std::vector<std::pair<std::string, pmp::SurfaceMesh>> remesh_meshes = {
+            {"icosahedron_3", subdivided_icosahedron(3)}, {"open_sphere_32", open_sphere(32)}};
+        add_surface_check(
+            "parallel_uniform_remeshing",
+            [](auto &m) { parallel_uniform_remeshing(m, pmp::mean_edge_length(m), 5, true, 0); },
+            [](auto &m) { pmp::uniform_remeshing(m, pmp::mean_edge_length(m), 5, true); }, 0.05,
+            2, remesh_meshes);
+        add_surface_check(
+            "parallel_adaptive_remeshing",
+            [](auto &m) {
+                const auto l = pmp::mean_edge_length(m);
+                parallel_adaptive_remeshing(m, 0.5f * l, 2 * l, 0.1f * l, 5, true, 0);
+            },
+            [](auto &m) {
+                const auto l = pmp::mean_edge_length(m);
+                pmp::adaptive_remeshing(m, 0.5f * l, 2 * l, 0.1f * l, 5, true);
+            },
+            0.05, 2, remesh_meshes);
+        add_surface_check(
+            "parallel_decimate",
+            [](auto &m) { parallel_decimate(m, m.n_vertices() / 4, 0, false); },
+            [](auto &m) { pmp::decimate(m, m.n_vertices() / 4); }, 0.02, 2,
+            {{"icosahedron_4", subdivided_icosahedron(4)}, {"open_sphere_32", open_sphere(32)}});
+
+        // Generators with a resolution
+        add_shape("uv_sphere", [](std::size_t n) { return uv_sphere(n); });
+        add_shape("plane", [](std::size_t n) { return pmp::plane(n); });
+    }
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    register_benchmarks();
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
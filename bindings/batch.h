@@ -0,0 +1,150 @@
+// ============================================================================
+// Batch processing: run a read -> process -> write pipeline over many files
+// ============================================================================
+// Each file is an independent task on a work-stealing ThreadPool, so a whole
+// batch saturates the machine from a single (GIL-free) binding call.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <string>
+#include <vector>
+
+#include <pmp/algorithms/decimation.h>
+#include <pmp/algorithms/remeshing.h>
+#include <pmp/algorithms/triangulation.h>
+#include <pmp/algorithms/utilities.h>
+#include <pmp/exceptions.h>
+#include <pmp/io/io.h>
+#include <pmp/surface_mesh.h>
+
+#include "garbage_collection.h"
+#include "parallel.h"
+#include "profiling.h"
+
+// Steps applied to every mesh of a batch, in this order:
+// read -> triangulate -> uniform_remeshing -> decimate -> write
+struct BatchPipeline {
+    // Triangulate non-triangle meshes (required by remeshing and decimation)
+    bool triangulate = true;
+
+    // Uniform remeshing, skipped when remesh_edge_length is 0. With
+    // remesh_relative, the edge length is a fraction of the bounding box diagonal.
+    pmp::Scalar  remesh_edge_length = 0;
+    bool         remesh_relative    = true;
+    unsigned int remesh_iterations  = 10;
+    bool         remesh_projection  = true;
+
+    // Decimation to decimate_vertices vertices, or else to decimate_ratio
+    // times the current vertex count. Skipped when both are 0.
+    unsigned int decimate_vertices = 0;
+    pmp::Scalar  decimate_ratio    = 0;
+
+    // Output format options
+    bool use_binary = false;
+};
+
+// Outcome of one file of a batch; timings are in seconds
+struct BatchResult {
+    std::string input;
+    std::string output;
+    bool        ok = false;
+    std::string error;
+    std::size_t n_vertices      = 0;
+    std::size_t n_faces         = 0;
+    double      read_seconds    = 0;
+    double      process_seconds = 0;
+    double      write_seconds   = 0;
+    double      total_seconds   = 0;
+};
+
+namespace pmp_rosetta::detail {
+
+    // Run the pipeline on an already loaded mesh
+    inline void run_pipeline(pmp::SurfaceMesh &mesh, const BatchPipeline &pipeline) {
+        if (pipeline.triangulate && !mesh.is_triangle_mesh()) {
+            pmp::triangulate(mesh);
+        }
+
+        if (pipeline.remesh_edge_length > 0) {
+            auto edge_length = pipeline.remesh_edge_length;
+            if (pipeline.remesh_relative) {
+                edge_length *= pmp::bounds(mesh).size();
+            }
+            pmp::uniform_remeshing(mesh, edge_length, pipeline.remesh_iterations,
+                                   pipeline.remesh_projection);
+        }
+
+        unsigned int target = pipeline.decimate_vertices;
+        if (target == 0 && pipeline.decimate_ratio > 0) {
+            target = static_cast<unsigned int>(mesh.n_vertices() * pipeline.decimate_ratio);
+        }
+        if (target > 0 && target < mesh.n_vertices()) {
+            pmp::decimate(mesh, target);
+        }
+
+        // pmp::write() expects a compact mesh
+        parallel_garbage_collection(mesh, 0);
+    }
+
+    inline void process_file(BatchResult &result, const BatchPipeline &pipeline,
+                             const pmp::IOFlags &flags) {
+        const auto start = std::chrono::steady_clock::now();
+        try {
+            pmp::SurfaceMesh mesh;
+            pmp::read(mesh, result.input);
+            result.read_seconds = seconds_since(start);
+
+            const auto process_start = std::chrono::steady_clock::now();
+            run_pipeline(mesh, pipeline);
+            result.process_seconds = seconds_since(process_start);
+
+            const auto write_start = std::chrono::steady_clock::now();
+            pmp::write(mesh, result.output, flags);
+            result.write_seconds = seconds_since(write_start);
+
+            result.n_vertices = mesh.n_vertices();
+            result.n_faces    = mesh.n_faces();
+            result.ok         = true;
+        } catch (const std::exception &e) {
+            result.error = e.what();
+        }
+        result.total_seconds = seconds_since(start);
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Process paths_in[i] into paths_out[i] on n_threads threads (0 = all
+// cores). Failures are reported per file and do not stop the batch.
+inline std::vector<BatchResult> process_batch(const std::vector<std::string> &paths_in,
+                                              const std::vector<std::string> &paths_out,
+                                              const BatchPipeline &pipeline,
+                                              unsigned int n_threads) {
+    if (paths_in.size() != paths_out.size()) {
+        throw pmp::InvalidInputException("process_batch: got " + std::to_string(paths_in.size()) +
+                                         " inputs but " + std::to_string(paths_out.size()) +
+                                         " outputs");
+    }
+
+    pmp::IOFlags flags;
+    flags.use_binary = pipeline.use_binary;
+
+    std::vector<BatchResult> results(paths_in.size());
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        results[i].input  = paths_in[i];
+        results[i].output = paths_out[i];
+    }
+
+    pmp_rosetta::ThreadPool pool(std::min<std::size_t>(pmp_rosetta::resolve_threads(n_threads),
+                                                       std::max<std::size_t>(results.size(), 1)));
+    for (auto &result : results) {
+        pool.submit([&result, &pipeline, &flags] {
+            pmp_rosetta::detail::process_file(result, pipeline, flags);
+        });
+    }
+    pool.wait();
+
+    return results;
+}
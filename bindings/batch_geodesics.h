@@ -0,0 +1,217 @@
+// ============================================================================
+// Batched geodesic distances
+// ============================================================================
+// pmp::geodesics() computes one distance field at a time into a mesh
+// property, so fields for many seed sets cannot be computed concurrently.
+// geodesic_distances() flattens the triangles once into a read-only
+// topology shared by all threads, then runs one fast marching front
+// (Kimmel & Sethian, with the planar "virtual source" update and a Dijkstra
+// fallback across obtuse triangles) per seed set on the thread pool.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "mesh_buffers.h"
+#include "parallel.h"
+
+namespace pmp_rosetta::detail {
+
+    // Triangles around each vertex, in compact vertex numbering
+    struct GeodesicTopology {
+        std::vector<pmp::dvec3>                    points;
+        std::vector<std::array<pmp::IndexType, 3>> triangles;
+        std::vector<pmp::IndexType>                offsets; // CSR into vertex_triangles
+        std::vector<pmp::IndexType>                vertex_triangles;
+
+        explicit GeodesicTopology(const pmp::SurfaceMesh &mesh) {
+            const auto map = compact_vertex_map(mesh);
+            const auto row = [&](pmp::Vertex v) { return map.empty() ? v.idx() : map[v.idx()]; };
+
+            points.reserve(mesh.n_vertices());
+            for (auto v : mesh.vertices()) {
+                points.emplace_back(mesh.position(v));
+            }
+
+            triangles.reserve(mesh.n_faces());
+            offsets.assign(points.size() + 1, 0);
+            for (auto f : mesh.faces()) {
+                std::array<pmp::IndexType, 3> t;
+                int                           k = 0;
+                for (auto v : mesh.vertices(f)) {
+                    t[k++] = row(v);
+                    ++offsets[row(v) + 1];
+                }
+                triangles.push_back(t);
+            }
+            for (std::size_t i = 1; i < offsets.size(); ++i) {
+                offsets[i] += offsets[i - 1];
+            }
+            vertex_triangles.resize(offsets.back());
+            auto next = offsets;
+            for (std::size_t t = 0; t < triangles.size(); ++t) {
+                for (auto v : triangles[t]) {
+                    vertex_triangles[next[v]++] = pmp::IndexType(t);
+                }
+            }
+        }
+    };
+
+    // Distance at c through the triangle (a, b, c) from the known distances
+    // at a and b: the front is a plane wave from a virtual source placed in
+    // the unfolded plane of the triangle. Falls back to the edge paths when
+    // the wave would not enter the triangle through the edge ab.
+    inline double fast_marching_update(const pmp::dvec3 &a, double da, const pmp::dvec3 &b,
+                                       double db, const pmp::dvec3 &c) {
+        const double fallback = std::min(da + norm(c - a), db + norm(c - b));
+
+        const pmp::dvec3 e  = b - a;
+        const double     ab = norm(e);
+        if (ab == 0) {
+            return fallback;
+        }
+        // Unfold: a = (0, 0), b = (ab, 0), c = (cx, cy) with cy > 0
+        const pmp::dvec3 ac = c - a;
+        const double     cx = dot(ac, e) / ab;
+        const double     cy = norm(cross(ac, e)) / ab;
+
+        // Virtual source below the edge, at distance da from a and db from b
+        const double sx  = (da * da - db * db + ab * ab) / (2 * ab);
+        const double sy2 = da * da - sx * sx;
+        if (sy2 < 0 || cy == 0) {
+            return fallback;
+        }
+        const double sy = -std::sqrt(sy2);
+
+        // The ray from the source to c must cross the edge ab
+        const double x = sx + (cx - sx) * (-sy / (cy - sy));
+        if (x < 0 || x > ab) {
+            return fallback;
+        }
+        return std::min(fallback, std::hypot(cx - sx, cy - sy));
+    }
+
+    // Distance field from one seed set; vertices farther than max_distance
+    // (or unreachable) get infinity
+    inline void fast_marching(const GeodesicTopology &topology, const pmp::IndexType *seeds,
+                              std::size_t n_seeds, double max_distance,
+                              std::vector<double> &distance, std::vector<char> &known) {
+        using Entry = std::pair<double, pmp::IndexType>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> front;
+
+        distance.assign(topology.points.size(), std::numeric_limits<double>::infinity());
+        known.assign(topology.points.size(), 0);
+        for (std::size_t i = 0; i < n_seeds; ++i) {
+            distance[seeds[i]] = 0;
+            front.emplace(0.0, seeds[i]);
+        }
+
+        while (!front.empty()) {
+            const auto [d, v] = front.top();
+            front.pop();
+            if (known[v] || d > distance[v]) {
+                continue;
+            }
+            if (d > max_distance) {
+                break;
+            }
+            known[v] = 1;
+
+            for (auto i = topology.offsets[v]; i < topology.offsets[v + 1]; ++i) {
+                const auto &t = topology.triangles[topology.vertex_triangles[i]];
+                const int   k = t[0] == v ? 0 : (t[1] == v ? 1 : 2);
+                const auto  a = t[(k + 1) % 3], b = t[(k + 2) % 3];
+                for (const auto &[c, o] : {std::pair(a, b), std::pair(b, a)}) {
+                    if (known[c]) {
+                        continue;
+                    }
+                    const auto &pc = topology.points[c];
+                    double      dc = d + norm(pc - topology.points[v]);
+                    if (known[o]) {
+                        dc = std::min(dc, fast_marching_update(topology.points[v], d,
+                                                               topology.points[o],
+                                                               distance[o], pc));
+                    }
+                    if (dc < distance[c]) {
+                        distance[c] = dc;
+                        front.emplace(dc, c);
+                    }
+                }
+            }
+        }
+
+        for (std::size_t v = 0; v < distance.size(); ++v) {
+            if (!known[v]) {
+                distance[v] = std::numeric_limits<double>::infinity();
+            }
+        }
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Geodesic distance fields of a triangle mesh for n_sets seed sets, one set
+// per thread (n_threads = 0: all cores).
+//   seeds:        seed vertices of all sets, as rows of export_points()
+//   seed_offsets: n_sets + 1 CSR offsets into seeds
+//   out:          n_sets * n_vertices() pmp::Scalar, row s holding the
+//                 distances from set s; infinity beyond max_distance
+// Returns n_sets.
+inline std::size_t geodesic_distances(const pmp::SurfaceMesh &mesh, std::uintptr_t seeds,
+                                      std::size_t n_seeds, std::uintptr_t seed_offsets,
+                                      std::size_t n_sets, std::uintptr_t out,
+                                      std::size_t capacity, pmp::Scalar max_distance,
+                                      unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    if (!mesh.is_triangle_mesh()) {
+        throw pmp::InvalidInputException("Input is not a triangle mesh!");
+    }
+    const std::size_t n = mesh.n_vertices();
+    check_capacity(n_sets * n, capacity, "geodesic_distances");
+    const auto *s   = buffer_cast<const pmp::IndexType>(seeds, n_seeds, "geodesic_distances");
+    const auto *off = buffer_cast<const pmp::IndexType>(seed_offsets, n_sets + 1,
+                                                        "geodesic_distances");
+    auto       *dst = buffer_cast<pmp::Scalar>(out, capacity, "geodesic_distances");
+
+    if (off[0] != 0 || off[n_sets] != n_seeds) {
+        throw pmp::InvalidInputException("geodesic_distances: bad seed offsets");
+    }
+    for (std::size_t i = 0; i < n_sets; ++i) {
+        if (off[i + 1] < off[i]) {
+            throw pmp::InvalidInputException("geodesic_distances: bad seed offsets");
+        }
+    }
+    for (std::size_t i = 0; i < n_seeds; ++i) {
+        if (s[i] >= n) {
+            throw pmp::InvalidInputException("geodesic_distances: seed " + std::to_string(s[i]) +
+                                             " out of range");
+        }
+    }
+
+    const GeodesicTopology topology(mesh);
+    pmp_rosetta::parallel_for(
+        0, n_sets,
+        [&](std::size_t set) {
+            thread_local std::vector<double> distance;
+            thread_local std::vector<char>   known;
+            fast_marching(topology, s + off[set], off[set + 1] - off[set], max_distance,
+                          distance, known);
+            for (std::size_t v = 0; v < n; ++v) {
+                dst[set * n + v] = pmp::Scalar(distance[v]);
+            }
+        },
+        n_threads, 1);
+    return n_sets;
+}
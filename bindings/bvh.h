@@ -0,0 +1,464 @@
+// ============================================================================
+// Bounding volume hierarchy over the triangles of a SurfaceMesh
+// ============================================================================
+// Nodes are stored in one flat array in depth-first order: the left child of
+// an inner node directly follows it, so a query walks memory mostly forward.
+// Triangles are stored in leaf order. Next to their corners, each leaf keeps
+// per-triangle bounding boxes and planes as structure-of-arrays, so a query
+// first computes a lower bound of the distance to every triangle of a leaf
+// in one vectorizable loop, and only runs the exact (branchy)
+// pmp::dist_point_triangle() on the triangles that can still be closer.
+//
+// Queries: closest point, first ray hit, and generalized winding number
+// (Barill et al., "Fast Winding Numbers for Soups and Clouds": exact solid
+// angles near the query, a dipole per distant node).
+//
+// The tree is immutable once built and every query is const, so any number of
+// threads can query the same tree concurrently.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <utility>
+#include <vector>
+
+#include <pmp/algorithms/distance_point_triangle.h>
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+namespace pmp_rosetta {
+
+    class TriangleBVH {
+    public:
+        // Largest number of triangles in a leaf
+        static constexpr unsigned int max_leaf_size = 8;
+
+        // Result of a closest point query
+        struct Nearest {
+            pmp::Face   face;
+            pmp::Point  point;
+            pmp::Scalar distance = std::numeric_limits<pmp::Scalar>::max();
+        };
+
+        // Result of a ray query; face is invalid if nothing was hit
+        struct Hit {
+            pmp::Face   face;
+            pmp::Scalar t = std::numeric_limits<pmp::Scalar>::infinity();
+        };
+
+        TriangleBVH() = default;
+
+        // Build over the faces of a triangle mesh. Deleted faces are skipped.
+        explicit TriangleBVH(const pmp::SurfaceMesh &mesh, unsigned int leaf_size = 4) {
+            if (!mesh.is_triangle_mesh()) {
+                throw pmp::InvalidInputException("TriangleBVH: input is not a triangle mesh");
+            }
+            leaf_size = std::clamp(leaf_size, 1u, max_leaf_size);
+
+            std::vector<BuildItem> items;
+            items.reserve(mesh.n_faces());
+            for (auto f : mesh.faces()) {
+                BuildItem item;
+                item.face = f;
+                auto it   = mesh.vertices(f).begin();
+                for (auto &p : item.points) {
+                    p = mesh.position(*it);
+                    ++it;
+                }
+                item.centroid = (item.points[0] + item.points[1] + item.points[2]) / pmp::Scalar(3);
+                items.push_back(item);
+            }
+            if (items.empty()) {
+                return;
+            }
+
+            nodes_.reserve(2 * items.size() / leaf_size + 1);
+            build(items, 0, items.size(), leaf_size);
+
+            // Leaf-ordered triangle data
+            const auto n = items.size();
+            faces_.resize(n);
+            corners_.resize(n);
+            for (auto &a : soa_) {
+                a.resize(n);
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                const auto &t = items[i].points;
+                faces_[i]     = items[i].face;
+                corners_[i]   = t;
+
+                const auto lo = min(min(t[0], t[1]), t[2]);
+                const auto hi = max(max(t[0], t[1]), t[2]);
+                auto       nn = cross(t[1] - t[0], t[2] - t[0]);
+                const auto l  = norm(nn);
+                if (l > 0) {
+                    nn /= l;
+                }
+                for (int k = 0; k < 3; ++k) {
+                    soa_[k][i]     = lo[k];
+                    soa_[3 + k][i] = hi[k];
+                    soa_[6 + k][i] = nn[k];
+                }
+                soa_[9][i] = dot(nn, t[0]);
+            }
+
+            build_dipoles();
+        }
+
+        bool        empty() const { return faces_.empty(); }
+        std::size_t n_triangles() const { return faces_.size(); }
+        std::size_t n_nodes() const { return nodes_.size(); }
+
+        // Closest point of the mesh surface to p. Throws on an empty tree.
+        Nearest nearest(const pmp::Point &p) const {
+            if (empty()) {
+                throw pmp::InvalidInputException("TriangleBVH: nearest() on an empty tree");
+            }
+
+            Nearest                       result;
+            pmp::Scalar                   best2 = result.distance;
+            std::array<std::uint32_t, 64> stack;
+            std::size_t                   top = 0;
+            stack[top++]                      = 0;
+
+            while (top > 0) {
+                const auto  index = stack[--top];
+                const Node &node  = nodes_[index];
+                if (box_distance2(node, p) >= best2) {
+                    continue;
+                }
+
+                if (node.count > 0) {
+                    leaf_nearest(node, p, result, best2);
+                    continue;
+                }
+
+                // Visit the closer child first: push it last
+                const std::uint32_t left  = index + 1;
+                const std::uint32_t right = node.first;
+                if (box_distance2(nodes_[left], p) < box_distance2(nodes_[right], p)) {
+                    stack[top++] = right;
+                    stack[top++] = left;
+                } else {
+                    stack[top++] = left;
+                    stack[top++] = right;
+                }
+            }
+            return result;
+        }
+
+        // First intersection of the ray origin + t * direction, t in [0, t_max]
+        Hit intersect(const pmp::Point &origin, const pmp::Point &direction,
+                      pmp::Scalar t_max = std::numeric_limits<pmp::Scalar>::infinity()) const {
+            Hit hit;
+            if (empty()) {
+                return hit;
+            }
+            hit.t = t_max;
+
+            pmp::Point inv;
+            for (int k = 0; k < 3; ++k) {
+                inv[k] = direction[k] != 0 ? 1 / direction[k]
+                                           : std::numeric_limits<pmp::Scalar>::infinity();
+            }
+
+            std::array<std::uint32_t, 64> stack;
+            std::size_t                   top = 0;
+            stack[top++]                      = 0;
+            while (top > 0) {
+                const auto  index = stack[--top];
+                const Node &node  = nodes_[index];
+                if (ray_box_entry(node, origin, inv) > hit.t) {
+                    continue;
+                }
+
+                if (node.count > 0) {
+                    for (auto i = node.first; i < node.first + node.count; ++i) {
+                        const auto t = ray_triangle(origin, direction, corners_[i]);
+                        if (t >= 0 && t <= hit.t) {
+                            hit.t    = t;
+                            hit.face = faces_[i];
+                        }
+                    }
+                    continue;
+                }
+
+                // Visit the child entered first: push it last
+                const std::uint32_t left  = index + 1;
+                const std::uint32_t right = node.first;
+                if (ray_box_entry(nodes_[left], origin, inv) <
+                    ray_box_entry(nodes_[right], origin, inv)) {
+                    stack[top++] = right;
+                    stack[top++] = left;
+                } else {
+                    stack[top++] = left;
+                    stack[top++] = right;
+                }
+            }
+
+            if (!hit.face.is_valid()) {
+                hit.t = std::numeric_limits<pmp::Scalar>::infinity();
+            }
+            return hit;
+        }
+
+        // Generalized winding number of the surface at p: 1 inside and 0
+        // outside a closed, consistently oriented surface, and a smooth
+        // inside-ness measure for meshes with holes. Nodes seen from farther
+        // than beta times their radius are approximated by their dipole.
+        pmp::Scalar winding_number(const pmp::Point &p, pmp::Scalar beta = 2) const {
+            if (empty()) {
+                return 0;
+            }
+
+            double                        w = 0;
+            std::array<std::uint32_t, 64> stack;
+            std::size_t                   top = 0;
+            stack[top++]                      = 0;
+            while (top > 0) {
+                const auto    index = stack[--top];
+                const Node   &node  = nodes_[index];
+                const Dipole &dp    = dipoles_[index];
+
+                const pmp::Point d  = dp.center - p;
+                const auto       r2 = sqrnorm(d);
+                if (r2 > beta * beta * dp.radius * dp.radius) {
+                    w += dot(d, dp.normal) / (r2 * std::sqrt(r2));
+                    continue;
+                }
+
+                if (node.count > 0) {
+                    for (auto i = node.first; i < node.first + node.count; ++i) {
+                        w += solid_angle(p, corners_[i]);
+                    }
+                } else {
+                    stack[top++] = index + 1;
+                    stack[top++] = node.first;
+                }
+            }
+            return pmp::Scalar(w / (4 * std::numbers::pi));
+        }
+
+    private:
+        struct BuildItem {
+            pmp::Face                 face;
+            std::array<pmp::Point, 3> points;
+            pmp::Point                centroid;
+        };
+
+        // 32 bytes: two nodes per cache line.
+        // Inner nodes: count == 0, left child at index + 1, right child at `first`.
+        // Leaves: triangles [first, first + count).
+        struct Node {
+            pmp::Point    min;
+            pmp::Point    max;
+            std::uint32_t first = 0;
+            std::uint32_t count = 0;
+        };
+
+        static pmp::Scalar box_distance2(const Node &node, const pmp::Point &p) {
+            pmp::Scalar d2 = 0;
+            for (int k = 0; k < 3; ++k) {
+                const auto d = std::max({node.min[k] - p[k], pmp::Scalar(0), p[k] - node.max[k]});
+                d2 += d * d;
+            }
+            return d2;
+        }
+
+        // Ray parameter at which the ray enters the box, infinity if it misses
+        static pmp::Scalar ray_box_entry(const Node &node, const pmp::Point &origin,
+                                         const pmp::Point &inv) {
+            pmp::Scalar t0 = 0;
+            pmp::Scalar t1 = std::numeric_limits<pmp::Scalar>::infinity();
+            for (int k = 0; k < 3; ++k) {
+                auto ta = (node.min[k] - origin[k]) * inv[k];
+                auto tb = (node.max[k] - origin[k]) * inv[k];
+                if (ta > tb) {
+                    std::swap(ta, tb);
+                }
+                // NaN (origin on a slab plane of an axis-parallel ray) keeps the bounds
+                t0 = ta > t0 ? ta : t0;
+                t1 = tb < t1 ? tb : t1;
+            }
+            return t0 <= t1 ? t0 : std::numeric_limits<pmp::Scalar>::infinity();
+        }
+
+        // Möller-Trumbore: ray parameter of the hit, -1 if none
+        static pmp::Scalar ray_triangle(const pmp::Point &origin, const pmp::Point &direction,
+                                        const std::array<pmp::Point, 3> &t) {
+            const pmp::Point  e1  = t[1] - t[0];
+            const pmp::Point  e2  = t[2] - t[0];
+            const pmp::Point  pv  = cross(direction, e2);
+            const pmp::Scalar det = dot(e1, pv);
+            if (std::abs(det) < std::numeric_limits<pmp::Scalar>::min()) {
+                return -1;
+            }
+            const pmp::Scalar inv_det = 1 / det;
+            const pmp::Point  tv      = origin - t[0];
+            const pmp::Scalar u       = dot(tv, pv) * inv_det;
+            if (u < 0 || u > 1) {
+                return -1;
+            }
+            const pmp::Point  qv = cross(tv, e1);
+            const pmp::Scalar v  = dot(direction, qv) * inv_det;
+            if (v < 0 || u + v > 1) {
+                return -1;
+            }
+            return dot(e2, qv) * inv_det;
+        }
+
+        // Signed solid angle of a triangle seen from p (Van Oosterom & Strackee),
+        // in double precision since it is summed over many triangles
+        static double solid_angle(const pmp::Point &p, const std::array<pmp::Point, 3> &t) {
+            const pmp::dvec3 q(p);
+            const pmp::dvec3 a = pmp::dvec3(t[0]) - q;
+            const pmp::dvec3 b = pmp::dvec3(t[1]) - q;
+            const pmp::dvec3 c = pmp::dvec3(t[2]) - q;
+            const double     la = norm(a), lb = norm(b), lc = norm(c);
+            const double     num = dot(a, cross(b, c));
+            const double den = la * lb * lc + dot(a, b) * lc + dot(b, c) * la + dot(c, a) * lb;
+            return 2 * std::atan2(num, den);
+        }
+
+        void leaf_nearest(const Node &node, const pmp::Point &p, Nearest &result,
+                          pmp::Scalar &best2) const {
+            const auto        first = node.first;
+            const auto        count = node.count;
+            const pmp::Scalar px = p[0], py = p[1], pz = p[2];
+            const pmp::Scalar zero = 0;
+
+            // Lower bound of the squared distance to each triangle: the larger
+            // of the distances to its bounding box and to its plane
+            pmp::Scalar lower[max_leaf_size];
+            for (std::uint32_t i = 0; i < count; ++i) {
+                const auto j  = first + i;
+                const auto dx = std::max(std::max(soa_[0][j] - px, px - soa_[3][j]), zero);
+                const auto dy = std::max(std::max(soa_[1][j] - py, py - soa_[4][j]), zero);
+                const auto dz = std::max(std::max(soa_[2][j] - pz, pz - soa_[5][j]), zero);
+                const auto dp = soa_[6][j] * px + soa_[7][j] * py + soa_[8][j] * pz - soa_[9][j];
+                lower[i]      = std::max(dx * dx + dy * dy + dz * dz, dp * dp);
+            }
+
+            for (std::uint32_t i = 0; i < count; ++i) {
+                if (lower[i] >= best2) {
+                    continue;
+                }
+                const auto &t = corners_[first + i];
+                pmp::Point  q;
+                const auto  d = pmp::dist_point_triangle(p, t[0], t[1], t[2], q);
+                if (d * d < best2) {
+                    best2           = d * d;
+                    result.distance = d;
+                    result.face     = faces_[first + i];
+                    result.point    = q;
+                }
+            }
+        }
+
+        // Far field of a node, for winding numbers: the sum of its area
+        // vectors, placed at its area-weighted centroid, and the radius of
+        // the node around that point
+        struct Dipole {
+            pmp::Point  center = pmp::Point(0, 0, 0);
+            pmp::Point  normal = pmp::Point(0, 0, 0);
+            pmp::Scalar radius = 0;
+        };
+
+        // One bottom-up pass: children are always stored after their parent
+        void build_dipoles() {
+            dipoles_.assign(nodes_.size(), Dipole());
+            std::vector<pmp::Scalar> areas(nodes_.size(), 0);
+
+            for (auto index = nodes_.size(); index-- > 0;) {
+                const Node &node = nodes_[index];
+                Dipole     &dp   = dipoles_[index];
+                pmp::Point  weighted(0, 0, 0);
+                pmp::Scalar area = 0;
+
+                if (node.count > 0) {
+                    for (auto i = node.first; i < node.first + node.count; ++i) {
+                        const auto      &t = corners_[i];
+                        const pmp::Point n = cross(t[1] - t[0], t[2] - t[0]) * pmp::Scalar(0.5);
+                        const auto       a = norm(n);
+                        dp.normal += n;
+                        weighted += (t[0] + t[1] + t[2]) * (a / 3);
+                        area += a;
+                    }
+                } else {
+                    for (const auto child : {std::uint32_t(index + 1), node.first}) {
+                        dp.normal += dipoles_[child].normal;
+                        weighted += dipoles_[child].center * areas[child];
+                        area += areas[child];
+                    }
+                }
+
+                areas[index] = area;
+                dp.center = area > 0 ? weighted / area : (node.min + node.max) * pmp::Scalar(0.5);
+
+                // The farthest box corner bounds the node
+                pmp::Point far;
+                for (int k = 0; k < 3; ++k) {
+                    far[k] = std::max(dp.center[k] - node.min[k], node.max[k] - dp.center[k]);
+                }
+                dp.radius = norm(far);
+            }
+        }
+
+        // Build the subtree over items[begin, end) and return its index
+        std::uint32_t build(std::vector<BuildItem> &items, std::size_t begin, std::size_t end,
+                            unsigned int leaf_size) {
+            const auto index = std::uint32_t(nodes_.size());
+            nodes_.emplace_back();
+
+            pmp::Point lo(std::numeric_limits<pmp::Scalar>::max());
+            pmp::Point hi(-std::numeric_limits<pmp::Scalar>::max());
+            pmp::Point clo = lo, chi = hi;
+            for (auto i = begin; i < end; ++i) {
+                for (const auto &p : items[i].points) {
+                    lo = min(lo, p);
+                    hi = max(hi, p);
+                }
+                clo = min(clo, items[i].centroid);
+                chi = max(chi, items[i].centroid);
+            }
+            nodes_[index].min = lo;
+            nodes_[index].max = hi;
+
+            if (end - begin <= leaf_size) {
+                nodes_[index].first = std::uint32_t(begin);
+                nodes_[index].count = std::uint32_t(end - begin);
+                return index;
+            }
+
+            // Median split along the longest axis of the centroid bounds
+            const pmp::Point extent = chi - clo;
+            const int        axis   = extent[0] > extent[1] ? (extent[0] > extent[2] ? 0 : 2)
+                                                            : (extent[1] > extent[2] ? 1 : 2);
+            const auto       mid    = begin + (end - begin) / 2;
+            std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end,
+                             [axis](const BuildItem &a, const BuildItem &b) {
+                                 return a.centroid[axis] < b.centroid[axis];
+                             });
+
+            build(items, begin, mid, leaf_size);
+            nodes_[index].first = build(items, mid, end, leaf_size);
+            return index;
+        }
+
+        std::vector<Node>                      nodes_;
+        std::vector<pmp::Face>                 faces_;
+        std::vector<std::array<pmp::Point, 3>> corners_;
+
+        // Per triangle: box min x/y/z, box max x/y/z, unit normal x/y/z, plane offset
+        std::array<std::vector<pmp::Scalar>, 10> soa_;
+
+        // Per node, for winding numbers
+        std::vector<Dipole> dipoles_;
+    };
+
+} // namespace pmp_rosetta
@@ -0,0 +1,302 @@
+// ============================================================================
+// Compact read-only mesh storage
+// ============================================================================
+// A SurfaceMesh keeps, per vertex, its position and about six halfedges with
+// their connectivity: around 100 bytes for a triangle mesh. CompactMesh keeps
+// what a mesh that is only queried or drawn needs, in about a fifth of that:
+// - positions quantized to `position_bits` bits per coordinate (16 at most)
+//   on a grid spanning the bounding box, stored as uint16;
+// - face corners as a byte stream: per face its valence (omitted for
+//   triangle meshes), then each corner as the zigzag varint of its
+//   difference to the previous corner. Neighboring faces share vertices
+//   with close indices, so most corners take one or two bytes.
+// The stream is cut into blocks of block_faces faces that start from
+// corner 0 and record where they begin, so encoding, decoding and the
+// exporters run block by block over the thread pool.
+//
+// Vertices are numbered as by export_points(): rows of the original mesh
+// without its deleted vertices. to_mesh() rebuilds a SurfaceMesh with the
+// same vertex and face order, its positions within max_error() of the
+// original ones per coordinate.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "mesh_buffers.h"
+#include "mesh_geometry.h"
+#include "parallel.h"
+#include "profiling.h"
+
+namespace pmp_rosetta::detail {
+
+    inline void put_varint(std::vector<std::uint8_t> &out, std::uint64_t x) {
+        while (x >= 0x80) {
+            out.push_back(std::uint8_t(x | 0x80));
+            x >>= 7;
+        }
+        out.push_back(std::uint8_t(x));
+    }
+
+    inline std::uint64_t get_varint(const std::uint8_t *&p) {
+        std::uint64_t x     = 0;
+        int           shift = 0;
+        while (*p & 0x80) {
+            x |= std::uint64_t(*p++ & 0x7f) << shift;
+            shift += 7;
+        }
+        return x | std::uint64_t(*p++) << shift;
+    }
+
+    inline std::uint64_t zigzag(std::int64_t x) {
+        return (std::uint64_t(x) << 1) ^ std::uint64_t(x >> 63);
+    }
+
+    inline std::int64_t unzigzag(std::uint64_t x) {
+        return std::int64_t(x >> 1) ^ -std::int64_t(x & 1);
+    }
+
+} // namespace pmp_rosetta::detail
+
+class CompactMesh {
+public:
+    static constexpr std::size_t block_faces = 1024;
+
+    CompactMesh() = default;
+
+    // Encode mesh with position_bits bits per coordinate (1 to 16), over
+    // n_threads threads (0: all cores)
+    CompactMesh(const pmp::SurfaceMesh &mesh, unsigned int position_bits,
+                unsigned int n_threads)
+        : bits_(position_bits) {
+        using namespace pmp_rosetta::detail;
+        pmp_rosetta::ProfileScope scope("compact_mesh.encode");
+
+        if (position_bits < 1 || position_bits > 16) {
+            throw pmp::InvalidInputException("CompactMesh: position_bits must be in [1, 16]");
+        }
+
+        const auto vs = handles<pmp::Vertex>(mesh.vertices());
+        const auto fs = handles<pmp::Face>(mesh.faces());
+        n_vertices_   = vs.size();
+        n_faces_      = fs.size();
+        triangles_    = mesh.is_triangle_mesh();
+
+        // Grid over the bounding box; flat boxes get a unit step
+        std::array<double, 3> lo, hi;
+        lo.fill(std::numeric_limits<double>::max());
+        hi.fill(std::numeric_limits<double>::lowest());
+        for (auto v : vs) {
+            const auto &p = mesh.position(v);
+            for (int k = 0; k < 3; ++k) {
+                lo[k] = std::min(lo[k], double(p[k]));
+                hi[k] = std::max(hi[k], double(p[k]));
+            }
+        }
+        const double levels = double((1u << bits_) - 1);
+        for (int k = 0; k < 3; ++k) {
+            origin_[k] = vs.empty() ? 0 : lo[k];
+            step_[k]   = vs.empty() || hi[k] <= lo[k] ? 1 : (hi[k] - lo[k]) / levels;
+        }
+
+        positions_.resize(3 * n_vertices_);
+        pmp_rosetta::parallel_for(
+            0, n_vertices_,
+            [&](std::size_t i) {
+                const auto &p = mesh.position(vs[i]);
+                for (int k = 0; k < 3; ++k) {
+                    const double q         = std::round((double(p[k]) - origin_[k]) / step_[k]);
+                    positions_[3 * i + k] = std::uint16_t(std::clamp(q, 0.0, levels));
+                }
+            },
+            n_threads, 4096);
+
+        std::vector<pmp::IndexType> map;
+        if (mesh.has_garbage()) {
+            map = compact_vertex_map(mesh);
+        }
+
+        // Blocks are encoded on their own, then concatenated
+        const std::size_t n_blocks = (n_faces_ + block_faces - 1) / block_faces;
+        std::vector<std::vector<std::uint8_t>> streams(n_blocks);
+        std::vector<std::uint64_t>             corners(n_blocks + 1, 0);
+        pmp_rosetta::parallel_for(
+            0, n_blocks,
+            [&](std::size_t b) {
+                auto         &out  = streams[b];
+                std::int64_t  prev = 0;
+                std::uint64_t n    = 0;
+                const auto    end  = std::min(n_faces_, (b + 1) * block_faces);
+                for (auto f = b * block_faces; f < end; ++f) {
+                    if (!triangles_) {
+                        put_varint(out, mesh.valence(fs[f]));
+                    }
+                    for (auto v : mesh.vertices(fs[f])) {
+                        const std::int64_t j = map.empty() ? v.idx() : map[v.idx()];
+                        put_varint(out, zigzag(j - prev));
+                        prev = j;
+                        ++n;
+                    }
+                }
+                corners[b + 1] = n;
+            },
+            n_threads, 1);
+
+        block_offsets_.assign(n_blocks + 1, 0);
+        block_corners_.assign(n_blocks + 1, 0);
+        for (std::size_t b = 0; b < n_blocks; ++b) {
+            block_offsets_[b + 1] = block_offsets_[b] + streams[b].size();
+            block_corners_[b + 1] = block_corners_[b] + corners[b + 1];
+        }
+        stream_.resize(block_offsets_.back());
+        pmp_rosetta::parallel_for(
+            0, n_blocks,
+            [&](std::size_t b) {
+                std::copy(streams[b].begin(), streams[b].end(),
+                          stream_.begin() + std::ptrdiff_t(block_offsets_[b]));
+            },
+            n_threads, 1);
+    }
+
+    std::size_t  n_vertices() const { return n_vertices_; }
+    std::size_t  n_faces() const { return n_faces_; }
+    std::size_t  n_face_indices() const {
+        return block_corners_.empty() ? 0 : std::size_t(block_corners_.back());
+    }
+    bool         is_triangle_mesh() const { return triangles_ && n_faces_ > 0; }
+    unsigned int position_bits() const { return bits_; }
+
+    // Largest distance of a decoded coordinate to the original one
+    double max_error() const { return 0.5 * std::max({step_[0], step_[1], step_[2]}); }
+
+    // Bytes held by the encoded arrays
+    std::size_t memory_bytes() const {
+        return positions_.capacity() * sizeof(std::uint16_t) + stream_.capacity() +
+               (block_offsets_.capacity() + block_corners_.capacity()) * sizeof(std::uint64_t);
+    }
+
+    // Fill out (n_vertices() * 3 pmp::Scalar) with the decoded positions
+    void decode_points(pmp::Scalar *out, unsigned int n_threads) const {
+        pmp_rosetta::parallel_for(
+            0, n_vertices_,
+            [&](std::size_t i) {
+                for (int k = 0; k < 3; ++k) {
+                    out[3 * i + k] =
+                        pmp::Scalar(origin_[k] + step_[k] * double(positions_[3 * i + k]));
+                }
+            },
+            n_threads, 4096);
+    }
+
+    // Fill indices (n_face_indices()) and, unless null, offsets
+    // (n_faces() + 1) with the CSR face corners
+    void decode_faces(pmp::IndexType *indices, pmp::IndexType *offsets,
+                      unsigned int n_threads) const {
+        using namespace pmp_rosetta::detail;
+        const auto n_blocks = block_offsets_.empty() ? 0 : block_offsets_.size() - 1;
+        pmp_rosetta::parallel_for(
+            0, n_blocks,
+            [&](std::size_t b) {
+                const auto  *p    = stream_.data() + block_offsets_[b];
+                auto         c    = block_corners_[b];
+                std::int64_t prev = 0;
+                const auto   end  = std::min(n_faces_, (b + 1) * block_faces);
+                for (auto f = b * block_faces; f < end; ++f) {
+                    if (offsets) {
+                        offsets[f] = pmp::IndexType(c);
+                    }
+                    const std::uint64_t n = triangles_ ? 3 : get_varint(p);
+                    for (std::uint64_t k = 0; k < n; ++k) {
+                        prev += unzigzag(get_varint(p));
+                        indices[c++] = pmp::IndexType(prev);
+                    }
+                }
+            },
+            n_threads, 1);
+        if (offsets) {
+            offsets[n_faces_] = pmp::IndexType(n_face_indices());
+        }
+    }
+
+    // Rebuild a SurfaceMesh (cleared first) from the compact data
+    void to_mesh(pmp::SurfaceMesh &mesh, unsigned int n_threads) const {
+        using namespace pmp_rosetta::detail;
+        pmp_rosetta::ProfileScope scope("compact_mesh.decode");
+
+        std::vector<pmp::Scalar>    points(3 * n_vertices_);
+        std::vector<pmp::IndexType> indices(n_face_indices()), offsets(n_faces_ + 1);
+        decode_points(points.data(), n_threads);
+        decode_faces(indices.data(), offsets.data(), n_threads);
+
+        std::vector<FaceRange> ranges(n_faces_);
+        for (std::size_t f = 0; f < n_faces_; ++f) {
+            ranges[f] = {offsets[f], std::size_t(offsets[f + 1] - offsets[f])};
+        }
+
+        mesh.clear();
+        mesh.reserve(n_vertices_, n_face_indices() / 2, n_faces_);
+        for (std::size_t i = 0; i < n_vertices_; ++i) {
+            mesh.add_vertex(pmp::Point(points[3 * i], points[3 * i + 1], points[3 * i + 2]));
+        }
+        // The faces come from a valid mesh: none is rejected
+        add_faces(mesh, indices.data(), ranges, std::vector<bool>(n_faces_, false));
+    }
+
+private:
+    unsigned int bits_       = 16;
+    std::size_t  n_vertices_ = 0;
+    std::size_t  n_faces_    = 0;
+    bool         triangles_  = true;
+
+    std::array<double, 3>      origin_{};
+    std::array<double, 3>      step_{1, 1, 1};
+    std::vector<std::uint16_t> positions_;
+    std::vector<std::uint8_t>  stream_;
+    std::vector<std::uint64_t> block_offsets_; // byte offset of each block in stream_
+    std::vector<std::uint64_t> block_corners_; // index of the first corner of each block
+};
+
+// Copy the decoded positions into a caller-provided buffer of
+// n_vertices() * 3 pmp::Scalar, like export_points()
+inline std::size_t export_compact_points(const CompactMesh &mesh, std::uintptr_t out,
+                                         std::size_t capacity, unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    check_capacity(mesh.n_vertices() * 3, capacity, "export_compact_points");
+    mesh.decode_points(buffer_cast<pmp::Scalar>(out, capacity, "export_compact_points"),
+                       n_threads);
+    return mesh.n_vertices();
+}
+
+// Write the face corners (n_face_indices() pmp::IndexType) and optionally
+// the CSR offsets (n_faces() + 1, or 0 to skip), like export_faces()
+inline std::size_t export_compact_faces(const CompactMesh &mesh, std::uintptr_t indices,
+                                        std::size_t n_indices, std::uintptr_t offsets,
+                                        std::size_t n_offsets, unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    check_capacity(mesh.n_face_indices(), n_indices, "export_compact_faces");
+    if (offsets != 0) {
+        check_capacity(mesh.n_faces() + 1, n_offsets, "export_compact_faces");
+    }
+    auto *idx = buffer_cast<pmp::IndexType>(indices, n_indices, "export_compact_faces");
+    auto *off = offsets != 0
+                    ? buffer_cast<pmp::IndexType>(offsets, n_offsets, "export_compact_faces")
+                    : nullptr;
+    mesh.decode_faces(idx, off, n_threads);
+    return mesh.n_faces();
+}
+
+// Rebuild a full SurfaceMesh into mesh
+inline void expand_compact_mesh(pmp::SurfaceMesh &mesh, const CompactMesh &compact,
+                                unsigned int n_threads) {
+    compact.to_mesh(mesh, n_threads);
+}
@@ -0,0 +1,642 @@
+// ============================================================================
+// Patch-parallel quadric decimation
+// ============================================================================
+// QuadricDecimator is a halfedge-collapse simplifier driven by per-vertex
+// error quadrics (Garland & Heckbert), like pmp::decimate() without its
+// optional aspect ratio / edge length / valence / Hausdorff constraints, and
+// with the ability to lock vertices.
+//
+// parallel_decimate() uses it to split the work over a thread pool:
+// 1. the faces are partitioned into compact patches, one per thread;
+// 2. each patch is copied out and decimated on its own, with the vertices
+//    shared with other patches locked so the patches still fit together;
+// 3. the patches are stitched back, keeping their accumulated quadrics;
+// 4. a serial pass over the whole mesh, with nothing locked but features,
+//    removes the remaining vertices, mostly along the former patch borders.
+// The result is rebuilt, and the vertex and face properties are gathered
+// from the input elements each of its vertices and faces comes from. Meshes
+// with halfedge or edge properties, or properties of types not stored in
+// snapshots, are decimated serially, so every property is kept either way.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
+#include <queue>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include <pmp/algorithms/decimation.h>
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "bvh.h"
+#include "garbage_collection.h"
+#include "parallel.h"
+#include "profiling.h"
+
+// Outcome of parallel_decimate(); timings are in seconds. Errors are the
+// distances from the input vertices to the result surface (a lower bound of
+// the Hausdorff distance). The serial_* fields are only filled in when the
+// run was compared against pmp::decimate() on a copy of the input.
+struct DecimationReport {
+    std::size_t n_vertices        = 0;
+    std::size_t n_faces           = 0;
+    std::size_t n_patches         = 0;
+    double      patch_seconds     = 0;
+    double      finish_seconds    = 0;
+    double      total_seconds     = 0;
+    double      max_error         = 0;
+    double      mean_error        = 0;
+    bool        compared          = false;
+    double      serial_seconds    = 0;
+    double      serial_max_error  = 0;
+    double      serial_mean_error = 0;
+};
+
+namespace pmp_rosetta::detail {
+
+    // Symmetric 4x4 error quadric, stored as its upper triangle
+    struct Quadric {
+        std::array<double, 10> a{};
+
+        Quadric() = default;
+
+        // Squared distance to the plane dot(n, x) + d = 0, n of unit length
+        Quadric(const pmp::dvec3 &n, double d)
+            : a{n[0] * n[0], n[0] * n[1], n[0] * n[2], n[0] * d, n[1] * n[1],
+                n[1] * n[2], n[1] * d,    n[2] * n[2], n[2] * d, d * d} {}
+
+        Quadric &operator+=(const Quadric &q) {
+            for (int i = 0; i < 10; ++i) {
+                a[i] += q.a[i];
+            }
+            return *this;
+        }
+
+        double operator()(const pmp::Point &p) const {
+            const double x = p[0], y = p[1], z = p[2];
+            return a[0] * x * x + 2 * a[1] * x * y + 2 * a[2] * x * z + 2 * a[3] * x +
+                   a[4] * y * y + 2 * a[5] * y * z + 2 * a[6] * y + a[7] * z * z +
+                   2 * a[8] * z + a[9];
+        }
+    };
+
+    // Halfedge collapse of vertex `from` into vertex `to`
+    struct Collapse {
+        pmp::IndexType from;
+        pmp::IndexType to;
+    };
+
+    class QuadricDecimator {
+    public:
+        // Quadrics are initialized from the faces of the mesh
+        explicit QuadricDecimator(pmp::SurfaceMesh &mesh)
+            : mesh_(mesh), quadrics_(mesh.vertices_size()) {
+            if (!mesh_.is_triangle_mesh()) {
+                throw pmp::InvalidInputException("Input is not a triangle mesh!");
+            }
+            for (auto f : mesh_.faces()) {
+                auto       h  = mesh_.halfedge(f);
+                const auto v0 = mesh_.to_vertex(h);
+                const auto v1 = mesh_.to_vertex(h = mesh_.next_halfedge(h));
+                const auto v2 = mesh_.to_vertex(mesh_.next_halfedge(h));
+
+                const pmp::dvec3 p0(mesh_.position(v0));
+                const pmp::dvec3 n =
+                    cross(pmp::dvec3(mesh_.position(v1)) - p0, pmp::dvec3(mesh_.position(v2)) - p0);
+                const double length = norm(n);
+                if (length == 0) {
+                    continue;
+                }
+                const Quadric q(n / length, -dot(n, p0) / length);
+                quadrics_[v0.idx()] += q;
+                quadrics_[v1.idx()] += q;
+                quadrics_[v2.idx()] += q;
+            }
+            locked_.assign(mesh_.vertices_size(), 0);
+        }
+
+        // Continue from already accumulated quadrics, one per vertex slot
+        QuadricDecimator(pmp::SurfaceMesh &mesh, std::vector<Quadric> quadrics)
+            : mesh_(mesh), quadrics_(std::move(quadrics)), locked_(mesh.vertices_size(), 0) {
+            if (!mesh_.is_triangle_mesh()) {
+                throw pmp::InvalidInputException("Input is not a triangle mesh!");
+            }
+            if (quadrics_.size() != mesh_.vertices_size()) {
+                throw pmp::InvalidInputException("QuadricDecimator: one quadric per vertex needed");
+            }
+        }
+
+        // A locked vertex is never removed, but others may collapse into it
+        void lock(pmp::Vertex v) { locked_[v.idx()] = 1; }
+
+        const std::vector<Quadric> &quadrics() const { return quadrics_; }
+
+        // Append every collapse done from now on to collapses (null: stop)
+        void record_collapses(std::vector<Collapse> *collapses) { collapses_ = collapses; }
+
+        // Collapse edges, cheapest first, until n_vertices are left or no
+        // legal collapse remains. Leaves the deleted elements as garbage.
+        // A later call with a smaller target continues the same run, from
+        // its quadrics and queue.
+        void decimate(std::size_t n_vertices) {
+            std::size_t n = mesh_.n_vertices();
+            if (n <= n_vertices) {
+                return;
+            }
+
+            if (target_.empty()) {
+                target_.assign(mesh_.vertices_size(), pmp::Halfedge());
+                stamp_.assign(mesh_.vertices_size(), 0);
+                for (auto v : mesh_.vertices()) {
+                    update(v);
+                }
+            }
+
+            while (n > n_vertices && !queue_.empty()) {
+                const auto entry = queue_.top();
+                queue_.pop();
+                const pmp::Vertex v0(entry.vertex);
+                if (entry.stamp != stamp_[v0.idx()] || mesh_.is_deleted(v0)) {
+                    continue;
+                }
+
+                // The neighborhood may have changed since the entry was queued
+                const auto h = target_[v0.idx()];
+                if (!is_legal(h)) {
+                    update(v0);
+                    continue;
+                }
+
+                const auto v1 = mesh_.to_vertex(h);
+                quadrics_[v1.idx()] += quadrics_[v0.idx()];
+                mesh_.collapse(h);
+                --n;
+                if (collapses_) {
+                    collapses_->push_back(Collapse{v0.idx(), v1.idx()});
+                }
+
+                update(v1);
+                for (auto v : mesh_.vertices(v1)) {
+                    update(v);
+                }
+            }
+        }
+
+    private:
+        struct Entry {
+            float          error;
+            pmp::IndexType vertex;
+            std::uint32_t  stamp;
+
+            bool operator>(const Entry &other) const { return error > other.error; }
+        };
+
+        bool is_legal(pmp::Halfedge h) const {
+            if (!h.is_valid() || mesh_.is_deleted(mesh_.edge(h))) {
+                return false;
+            }
+            const auto v0 = mesh_.from_vertex(h);
+            const auto v1 = mesh_.to_vertex(h);
+            if (locked_[v0.idx()] || !mesh_.is_collapse_ok(h)) {
+                return false;
+            }
+
+            // A boundary vertex may only slide along the boundary
+            if (mesh_.is_boundary(v0) && !mesh_.is_boundary(mesh_.edge(h))) {
+                return false;
+            }
+
+            // No face around v0 may flip when v0 moves onto v1
+            const auto &p0 = mesh_.position(v0);
+            const auto &p1 = mesh_.position(v1);
+            for (auto hh : mesh_.halfedges(v0)) {
+                if (mesh_.is_boundary(hh)) {
+                    continue;
+                }
+                const auto vb = mesh_.to_vertex(hh);
+                const auto vc = mesh_.to_vertex(mesh_.next_halfedge(hh));
+                if (vb == v1 || vc == v1) {
+                    continue; // removed by the collapse
+                }
+                const auto &pb = mesh_.position(vb);
+                const auto &pc = mesh_.position(vc);
+                if (dot(cross(pb - p0, pc - p0), cross(pb - p1, pc - p1)) <= 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Find the cheapest legal collapse out of v and (re)queue it
+        void update(pmp::Vertex v) {
+            const auto i = v.idx();
+            ++stamp_[i];
+            target_[i] = pmp::Halfedge();
+            if (locked_[i]) {
+                return;
+            }
+
+            double best = std::numeric_limits<double>::max();
+            for (auto h : mesh_.halfedges(v)) {
+                if (!is_legal(h)) {
+                    continue;
+                }
+                auto q = quadrics_[i];
+                q += quadrics_[mesh_.to_vertex(h).idx()];
+                const double error = q(mesh_.position(mesh_.to_vertex(h)));
+                if (error < best) {
+                    best       = error;
+                    target_[i] = h;
+                }
+            }
+            if (target_[i].is_valid()) {
+                queue_.push(Entry{float(best), i, stamp_[i]});
+            }
+        }
+
+        pmp::SurfaceMesh          &mesh_;
+        std::vector<Quadric>       quadrics_;
+        std::vector<char>          locked_;
+        std::vector<pmp::Halfedge> target_;
+        std::vector<std::uint32_t> stamp_;
+        std::vector<Collapse>     *collapses_ = nullptr;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue_;
+    };
+
+    // Split the faces into n_patches spatially compact sets of about equal
+    // size, by recursive bisection of their centroids. Returns the patch of
+    // every face slot (deleted faces included, their value is meaningless).
+    inline std::vector<std::uint32_t> partition_faces(const pmp::SurfaceMesh &mesh,
+                                                      std::size_t             n_patches) {
+        std::vector<pmp::Point>     centroids(mesh.faces_size());
+        std::vector<pmp::IndexType> faces;
+        faces.reserve(mesh.n_faces());
+        for (auto f : mesh.faces()) {
+            pmp::Point c(0);
+            for (auto v : mesh.vertices(f)) {
+                c += mesh.position(v);
+            }
+            centroids[f.idx()] = c / pmp::Scalar(3);
+            faces.push_back(f.idx());
+        }
+
+        std::vector<std::uint32_t> patch(mesh.faces_size(), 0);
+
+        // Range [begin, end) of faces gets patches [first, first + count)
+        std::function<void(std::size_t, std::size_t, std::uint32_t, std::size_t)> split =
+            [&](std::size_t begin, std::size_t end, std::uint32_t first, std::size_t count) {
+                if (count == 1 || end - begin < 2) {
+                    for (auto i = begin; i < end; ++i) {
+                        patch[faces[i]] = first;
+                    }
+                    return;
+                }
+
+                pmp::Point lo(std::numeric_limits<pmp::Scalar>::max());
+                pmp::Point hi(-std::numeric_limits<pmp::Scalar>::max());
+                for (auto i = begin; i < end; ++i) {
+                    lo = min(lo, centroids[faces[i]]);
+                    hi = max(hi, centroids[faces[i]]);
+                }
+                const pmp::Point extent = hi - lo;
+                const int axis = extent[0] > extent[1] ? (extent[0] > extent[2] ? 0 : 2)
+                                                       : (extent[1] > extent[2] ? 1 : 2);
+
+                const std::size_t left = count / 2;
+                const std::size_t mid  = begin + (end - begin) * left / count;
+                std::nth_element(faces.begin() + begin, faces.begin() + mid, faces.begin() + end,
+                                 [&](pmp::IndexType a, pmp::IndexType b) {
+                                     return centroids[a][axis] < centroids[b][axis];
+                                 });
+                split(begin, mid, first, left);
+                split(mid, end, first + std::uint32_t(left), count - left);
+            };
+        split(0, faces.size(), 0, n_patches);
+        return patch;
+    }
+
+    // Decimated triangles of one patch, in vertex indices of the input mesh,
+    // the input face each of them was shrunk from, and the quadrics of the
+    // vertices it still uses
+    struct DecimatedPatch {
+        std::vector<std::array<pmp::IndexType, 3>>      triangles;
+        std::vector<pmp::IndexType>                     origins;
+        std::vector<std::pair<pmp::IndexType, Quadric>> quadrics;
+        bool                                            ok = true;
+    };
+
+    inline DecimatedPatch decimate_patch(const pmp::SurfaceMesh            &mesh,
+                                         const std::vector<pmp::IndexType> &faces,
+                                         const std::vector<char>           &locked,
+                                         std::size_t                        n_interior_target) {
+        DecimatedPatch result;
+
+        std::vector<pmp::IndexType> globals;
+        globals.reserve(faces.size() * 3);
+        for (auto f : faces) {
+            for (auto v : mesh.vertices(pmp::Face(f))) {
+                globals.push_back(v.idx());
+            }
+        }
+        std::sort(globals.begin(), globals.end());
+        globals.erase(std::unique(globals.begin(), globals.end()), globals.end());
+        const auto local = [&](pmp::Vertex v) {
+            return pmp::Vertex(pmp::IndexType(
+                std::lower_bound(globals.begin(), globals.end(), v.idx()) - globals.begin()));
+        };
+
+        pmp::SurfaceMesh patch;
+        patch.reserve(globals.size(), 3 * faces.size(), faces.size());
+        for (auto v : globals) {
+            patch.add_vertex(mesh.position(pmp::Vertex(v)));
+        }
+        std::vector<pmp::Vertex> corners(3);
+        for (auto f : faces) {
+            int k = 0;
+            for (auto v : mesh.vertices(pmp::Face(f))) {
+                corners[k++] = local(v);
+            }
+            try {
+                patch.add_face(corners);
+            } catch (const pmp::TopologyException &) {
+                result.ok = false;
+                return result;
+            }
+        }
+
+        QuadricDecimator decimator(patch);
+        std::size_t      n_locked = 0;
+        for (std::size_t i = 0; i < globals.size(); ++i) {
+            if (locked[globals[i]]) {
+                decimator.lock(pmp::Vertex(pmp::IndexType(i)));
+                ++n_locked;
+            }
+        }
+        decimator.decimate(n_interior_target + n_locked);
+
+        // Collapses keep the indices of the faces they do not delete
+        result.triangles.reserve(patch.n_faces());
+        result.origins.reserve(patch.n_faces());
+        for (auto f : patch.faces()) {
+            std::array<pmp::IndexType, 3> triangle;
+            int                           k = 0;
+            for (auto v : patch.vertices(f)) {
+                triangle[k++] = globals[v.idx()];
+            }
+            result.triangles.push_back(triangle);
+            result.origins.push_back(faces[f.idx()]);
+        }
+        result.quadrics.reserve(patch.n_vertices());
+        for (auto v : patch.vertices()) {
+            result.quadrics.emplace_back(globals[v.idx()], decimator.quadrics()[v.idx()]);
+        }
+        return result;
+    }
+
+    // Max and mean distance from points to the surface of a triangle mesh
+    inline std::pair<double, double> surface_error(const std::vector<pmp::Point> &points,
+                                                   const pmp::SurfaceMesh        &mesh) {
+        if (points.empty() || mesh.n_faces() == 0) {
+            return {0, 0};
+        }
+        const TriangleBVH   bvh(mesh);
+        std::vector<double> distances(points.size());
+        parallel_for(0, points.size(),
+                     [&](std::size_t i) { distances[i] = bvh.nearest(points[i]).distance; });
+
+        double max_error = 0, sum = 0;
+        for (auto d : distances) {
+            max_error = std::max(max_error, d);
+            sum += d;
+        }
+        return {max_error, sum / double(distances.size())};
+    }
+
+    // Whether the parallel path keeps every property of mesh: it knows which
+    // input vertex or face each vertex or face of its result comes from, but
+    // not the input edges, and gathers the types of SnapshotTypes only
+    inline bool has_patch_properties_only(const pmp::SurfaceMesh &mesh) {
+        for (char kind : {'v', 'h', 'e', 'f'}) {
+            for (const auto &name : property_names(mesh, kind)) {
+                if (is_builtin_property(name)) {
+                    continue;
+                }
+                if (kind == 'h' || kind == 'e' || !has_supported_type(mesh, kind, name)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Serial fallback: the same quadric decimation on the whole mesh
+    inline void decimate_serial(pmp::SurfaceMesh &mesh, std::size_t n_vertices,
+                                const pmp::VertexProperty<bool> &features) {
+        ProfileScope     scope("decimate.serial");
+        QuadricDecimator decimator(mesh);
+        if (features) {
+            for (auto v : mesh.vertices()) {
+                if (features[v]) {
+                    decimator.lock(v);
+                }
+            }
+        }
+        decimator.decimate(n_vertices);
+        mesh.garbage_collection();
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Decimate a triangle mesh down to n_vertices over n_threads threads (0: all
+// cores). Vertices marked in a "v:feature" property are kept, and so are the
+// other properties of the mesh (see the header comment). With
+// compare_serial, pmp::decimate() is also run on a copy of the input and its
+// time and error are added to the report, for picking a mode per job.
+inline DecimationReport parallel_decimate(pmp::SurfaceMesh &mesh, unsigned int n_vertices,
+                                          unsigned int n_threads, bool compare_serial) {
+    using namespace pmp_rosetta::detail;
+    using clock = std::chrono::steady_clock;
+
+    if (!mesh.is_triangle_mesh()) {
+        throw pmp::InvalidInputException("Input is not a triangle mesh!");
+    }
+    parallel_garbage_collection(mesh, n_threads);
+
+    // Kept for the report, not timed
+    const std::vector<pmp::Point> original = mesh.positions();
+    pmp::SurfaceMesh              serial;
+    if (compare_serial) {
+        serial = mesh;
+    }
+
+    DecimationReport report;
+    const auto       start    = clock::now();
+    const auto       features = mesh.get_vertex_property<bool>("v:feature");
+
+    // Patches below this many faces are not worth the copy
+    constexpr std::size_t min_patch_faces = 16384;
+    const std::size_t     n_patches =
+        std::min(pmp_rosetta::resolve_threads(n_threads), mesh.n_faces() / min_patch_faces);
+
+    if (n_patches < 2 || n_vertices >= mesh.n_vertices() || !has_patch_properties_only(mesh)) {
+        report.n_patches = 1;
+        decimate_serial(mesh, n_vertices, features);
+        report.finish_seconds = seconds_since(start);
+    } else {
+        report.n_patches = n_patches;
+        std::optional<pmp_rosetta::ProfileScope> phase(std::in_place, "decimate.partition");
+        const auto                               patch_of = partition_faces(mesh, n_patches);
+
+        // Vertices shared by several patches are locked in the parallel phase
+        std::vector<char>        locked(mesh.vertices_size(), 0);
+        std::vector<std::size_t> n_interior(n_patches, 0);
+        std::size_t              n_locked = 0;
+        for (auto v : mesh.vertices()) {
+            std::uint32_t patch  = PMP_MAX_INDEX;
+            bool          is_cut = false;
+            for (auto f : mesh.faces(v)) {
+                if (patch == PMP_MAX_INDEX) {
+                    patch = patch_of[f.idx()];
+                } else if (patch != patch_of[f.idx()]) {
+                    is_cut = true;
+                }
+            }
+            if (is_cut || (features && features[v])) {
+                locked[v.idx()] = 1;
+                ++n_locked;
+            } else if (patch != PMP_MAX_INDEX) {
+                ++n_interior[patch];
+            }
+        }
+
+        std::vector<std::vector<pmp::IndexType>> patch_faces(n_patches);
+        for (auto f : mesh.faces()) {
+            patch_faces[patch_of[f.idx()]].push_back(f.idx());
+        }
+
+        // Shrink every interior by the overall ratio: the stitched mesh then
+        // has about n_vertices plus the locked vertices, which the serial
+        // pass removes
+        const double ratio = double(n_vertices) / double(mesh.n_vertices());
+
+        phase.emplace("decimate.patches");
+        std::vector<DecimatedPatch> patches(n_patches);
+        pmp_rosetta::parallel_for(
+            0, n_patches,
+            [&](std::size_t i) {
+                const auto target = std::size_t(std::llround(ratio * double(n_interior[i])));
+                patches[i]        = decimate_patch(mesh, patch_faces[i], locked, target);
+            },
+            n_threads, 1);
+
+        const bool ok = std::all_of(patches.begin(), patches.end(),
+                                    [](const DecimatedPatch &p) { return p.ok; });
+        report.patch_seconds = seconds_since(start);
+        const auto finish_start = clock::now();
+        phase.emplace("decimate.stitch");
+
+        if (!ok) {
+            // A patch could not be copied out as a manifold mesh
+            decimate_serial(mesh, n_vertices, features);
+        } else {
+            // Stitch: surviving vertices keep their input order, isolated
+            // vertices are kept as they are
+            std::vector<pmp::IndexType> new_index(mesh.vertices_size(), PMP_MAX_INDEX);
+            std::vector<Quadric>        quadric_of(mesh.vertices_size());
+            for (const auto &patch : patches) {
+                for (const auto &[v, q] : patch.quadrics) {
+                    new_index[v] = 0;
+                    quadric_of[v] += q;
+                }
+            }
+            for (auto v : mesh.vertices()) {
+                if (mesh.is_isolated(v)) {
+                    new_index[v.idx()] = 0;
+                }
+            }
+
+            pmp::SurfaceMesh            result;
+            std::vector<Quadric>        quadrics;
+            std::vector<char>           keep;
+            std::vector<pmp::IndexType> vertex_old_of;
+            for (auto v : mesh.vertices()) {
+                if (new_index[v.idx()] == PMP_MAX_INDEX) {
+                    continue;
+                }
+                new_index[v.idx()] = result.add_vertex(mesh.position(v)).idx();
+                quadrics.push_back(quadric_of[v.idx()]);
+                keep.push_back(features && features[v]);
+                vertex_old_of.push_back(v.idx());
+            }
+
+            bool                        stitched = true;
+            std::vector<pmp::IndexType> face_old_of;
+            for (const auto &patch : patches) {
+                for (std::size_t i = 0; i < patch.triangles.size(); ++i) {
+                    const auto &t = patch.triangles[i];
+                    try {
+                        result.add_triangle(pmp::Vertex(new_index[t[0]]),
+                                            pmp::Vertex(new_index[t[1]]),
+                                            pmp::Vertex(new_index[t[2]]));
+                        face_old_of.push_back(patch.origins[i]);
+                    } catch (const pmp::TopologyException &) {
+                        stitched = false;
+                    }
+                }
+            }
+
+            if (!stitched) {
+                decimate_serial(mesh, n_vertices, features);
+            } else {
+                phase.emplace("decimate.finish");
+                // Properties, "v:feature" included, then follow their
+                // elements through the collapses and garbage collection below
+                for (char kind : {'v', 'f'}) {
+                    for (const auto &name : property_names(mesh, kind)) {
+                        if (!is_builtin_property(name)) {
+                            gather_property(mesh, result, kind, name,
+                                            kind == 'v' ? vertex_old_of : face_old_of, n_threads);
+                        }
+                    }
+                }
+                QuadricDecimator decimator(result, std::move(quadrics));
+                for (std::size_t i = 0; i < keep.size(); ++i) {
+                    if (keep[i]) {
+                        decimator.lock(pmp::Vertex(pmp::IndexType(i)));
+                    }
+                }
+                decimator.decimate(n_vertices);
+                parallel_garbage_collection(result, n_threads);
+                mesh = result;
+            }
+        }
+        report.finish_seconds = seconds_since(finish_start);
+    }
+
+    report.total_seconds = seconds_since(start);
+    report.n_vertices    = mesh.n_vertices();
+    report.n_faces       = mesh.n_faces();
+    {
+        pmp_rosetta::ProfileScope scope("decimate.error");
+        std::tie(report.max_error, report.mean_error) = surface_error(original, mesh);
+    }
+
+    if (compare_serial) {
+        const auto serial_start = clock::now();
+        pmp::decimate(serial, n_vertices);
+        report.serial_seconds = seconds_since(serial_start);
+        report.compared       = true;
+        std::tie(report.serial_max_error, report.serial_mean_error) =
+            surface_error(original, serial);
+    }
+    return report;
+}
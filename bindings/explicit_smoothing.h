@@ -0,0 +1,195 @@
+// ============================================================================
+// Explicit smoothing over a flattened one-ring adjacency
+// ============================================================================
+// pmp::explicit_smoothing() moves every interior vertex halfway to the
+// weighted average of its neighbors, once per iteration. The version below
+// computes the same iterations on a CSR copy of the one-rings: each row holds
+// the neighbor indices and the weights already divided by their sum, and
+// the coordinates live in separate x/y/z arrays. An iteration is then a
+// sparse matrix-vector product over contiguous arrays, split across threads,
+// instead of a walk through the halfedge connectivity. The positions are
+// written back to "v:point" once, after the last iteration.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "laplacian.h"
+#include "mesh_geometry.h"
+#include "parallel.h"
+
+namespace pmp_rosetta::detail {
+
+    // Row i lists the neighbors of vertex i and their weights, normalized to
+    // sum to one; fixed vertices (boundary ones and those selected by the
+    // caller) have empty rows
+    struct OneRingMatrix {
+        std::vector<std::uint32_t> offsets;
+        std::vector<std::uint32_t> neighbors;
+        std::vector<double>        weights;
+    };
+
+    template <typename IsFixed>
+    inline OneRingMatrix one_ring_matrix(const pmp::SurfaceMesh          &mesh,
+                                         const std::vector<pmp::Vertex> &vertices,
+                                         bool use_uniform_laplace, IsFixed &&is_fixed,
+                                         unsigned int n_threads) {
+        std::vector<pmp::IndexType> index_of;
+        if (mesh.has_garbage()) {
+            index_of.assign(mesh.vertices_size(), PMP_MAX_INDEX);
+            for (std::size_t i = 0; i < vertices.size(); ++i) {
+                index_of[vertices[i].idx()] = pmp::IndexType(i);
+            }
+        }
+        const auto row = [&](pmp::Vertex v) {
+            return index_of.empty() ? v.idx() : index_of[v.idx()];
+        };
+
+        // Cotan weights clamped to zero, like pmp::explicit_smoothing()
+        std::vector<double> edge_weight;
+        if (!use_uniform_laplace) {
+            edge_weight.assign(mesh.edges_size(), 0);
+            const auto edges = handles<pmp::Edge>(mesh.edges());
+            parallel_for(
+                0, edges.size(),
+                [&](std::size_t i) {
+                    double w = 0;
+                    for (unsigned k = 0; k < 2; ++k) {
+                        const auto h = mesh.halfedge(edges[i], k);
+                        if (!mesh.is_boundary(h)) {
+                            w += cotan_at(mesh.position(mesh.from_vertex(h)),
+                                          mesh.position(mesh.to_vertex(h)),
+                                          mesh.position(mesh.to_vertex(mesh.next_halfedge(h))));
+                        }
+                    }
+                    edge_weight[edges[i].idx()] = std::max(w, 0.0);
+                },
+                n_threads);
+        }
+
+        OneRingMatrix m;
+        m.offsets.assign(vertices.size() + 1, 0);
+        for (std::size_t i = 0; i < vertices.size(); ++i) {
+            const auto v = vertices[i];
+            m.offsets[i + 1] = m.offsets[i] + (mesh.is_boundary(v) || is_fixed(v)
+                                                   ? 0
+                                                   : std::uint32_t(mesh.valence(v)));
+        }
+        m.neighbors.resize(m.offsets.back());
+        m.weights.resize(m.offsets.back());
+
+        parallel_for(
+            0, vertices.size(),
+            [&](std::size_t i) {
+                const auto begin = m.offsets[i], end = m.offsets[i + 1];
+                if (begin == end) {
+                    return;
+                }
+                double sum = 0;
+                auto   k   = begin;
+                for (auto h : mesh.halfedges(vertices[i])) {
+                    m.neighbors[k] = row(mesh.to_vertex(h));
+                    m.weights[k]   = use_uniform_laplace ? 1.0 : edge_weight[mesh.edge(h).idx()];
+                    sum += m.weights[k];
+                    ++k;
+                }
+                for (k = begin; k < end; ++k) {
+                    if (sum > 0) {
+                        m.weights[k] /= sum;
+                    } else {
+                        // No positive weight: the vertex averages itself,
+                        // i.e. stays fixed
+                        m.neighbors[k] = std::uint32_t(i);
+                        m.weights[k]   = 1.0 / (end - begin);
+                    }
+                }
+            },
+            n_threads, 256);
+        return m;
+    }
+
+    // Run the iterations x <- x / 2 + W x / 2 of explicit smoothing on the
+    // vertices, fixed rows being copied through, then write the positions
+    inline void smooth_positions(pmp::SurfaceMesh &mesh, const std::vector<pmp::Vertex> &vertices,
+                                 const OneRingMatrix &m, unsigned int iterations,
+                                 unsigned int n_threads) {
+        const auto n = vertices.size();
+
+        std::array<std::vector<double>, 3> x, y;
+        for (auto &c : x) {
+            c.resize(n);
+        }
+        for (auto &c : y) {
+            c.resize(n);
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto &p = mesh.position(vertices[i]);
+            for (int c = 0; c < 3; ++c) {
+                x[c][i] = p[c];
+            }
+        }
+
+        for (unsigned int it = 0; it < iterations; ++it) {
+            parallel_for(
+                0, n,
+                [&](std::size_t i) {
+                    const auto begin = m.offsets[i], end = m.offsets[i + 1];
+                    if (begin == end) {
+                        for (int c = 0; c < 3; ++c) {
+                            y[c][i] = x[c][i];
+                        }
+                        return;
+                    }
+                    double sx = 0, sy = 0, sz = 0;
+                    for (auto k = begin; k < end; ++k) {
+                        const auto   j = m.neighbors[k];
+                        const double w = m.weights[k];
+                        sx += w * x[0][j];
+                        sy += w * x[1][j];
+                        sz += w * x[2][j];
+                    }
+                    y[0][i] = 0.5 * (x[0][i] + sx);
+                    y[1][i] = 0.5 * (x[1][i] + sy);
+                    y[2][i] = 0.5 * (x[2][i] + sz);
+                },
+                n_threads, 4096);
+            std::swap(x, y);
+        }
+
+        parallel_for(
+            0, n,
+            [&](std::size_t i) {
+                mesh.position(vertices[i]) = pmp::Point(
+                    pmp::Scalar(x[0][i]), pmp::Scalar(x[1][i]), pmp::Scalar(x[2][i]));
+            },
+            n_threads, 4096);
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Same result as pmp::explicit_smoothing(mesh, iterations,
+// use_uniform_laplace), computed over n_threads threads (0: all cores).
+// Boundary vertices stay fixed; cotan weights need a triangle mesh.
+inline void parallel_explicit_smoothing(pmp::SurfaceMesh &mesh, unsigned int iterations,
+                                        bool use_uniform_laplace, unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    if (!use_uniform_laplace && !mesh.is_triangle_mesh()) {
+        throw pmp::InvalidInputException("Input is not a triangle mesh!");
+    }
+    if (mesh.n_vertices() == 0 || iterations == 0) {
+        return;
+    }
+
+    const auto vertices = handles<pmp::Vertex>(mesh.vertices());
+    const auto m        = one_ring_matrix(
+        mesh, vertices, use_uniform_laplace, [](pmp::Vertex) { return false; }, n_threads);
+    smooth_positions(mesh, vertices, m, iterations, n_threads);
+}
@@ -0,0 +1,68 @@
+// ============================================================================
+// Parallel feature edge detection
+// ============================================================================
+// pmp::detect_features() visits every edge and computes the normals of both
+// its faces, so each face normal is computed once per edge of the face, on
+// one thread. parallel_detect_features() computes every face normal once,
+// with the triangle formula on triangle meshes (see triangles.h), then tests
+// the edges in parallel; only setting the bit-packed flags is serial.
+// ============================================================================
+#pragma once
+
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+#include <pmp/surface_mesh.h>
+
+#include "mesh_geometry.h"
+#include "parallel.h"
+#include "triangles.h"
+
+// Mark the interior edges whose dihedral angle exceeds angle (in degrees),
+// and their vertices, in "e:feature" / "v:feature", like
+// pmp::detect_features(). Flags already set stay set. Returns the number of
+// edges found, over n_threads threads (0: all cores).
+inline std::size_t parallel_detect_features(pmp::SurfaceMesh &mesh, pmp::Scalar angle,
+                                            unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    auto vfeature = mesh.vertex_property<bool>("v:feature", false);
+    auto efeature = mesh.edge_property<bool>("e:feature", false);
+
+    const pmp::Scalar        feature_cosine = std::cos(angle / 180.0 * std::numbers::pi);
+    const auto               faces          = handles<pmp::Face>(mesh.faces());
+    std::vector<pmp::Normal> normals(mesh.faces_size());
+    with_arity(mesh, [&](auto arity) {
+        pmp_rosetta::parallel_for(
+            0, faces.size(),
+            [&](std::size_t i) { normals[faces[i].idx()] = face_normal(mesh, faces[i], arity); },
+            n_threads, 1024);
+    });
+
+    std::vector<char> sharp(mesh.edges_size(), 0);
+    pmp_rosetta::parallel_for(
+        0, sharp.size(),
+        [&](std::size_t i) {
+            const auto e = pmp::Edge(pmp::IndexType(i));
+            if (mesh.is_deleted(e) || mesh.is_boundary(e)) {
+                return;
+            }
+            const auto f0 = mesh.face(mesh.halfedge(e, 0));
+            const auto f1 = mesh.face(mesh.halfedge(e, 1));
+            sharp[i]      = pmp::dot(normals[f0.idx()], normals[f1.idx()]) < feature_cosine;
+        },
+        n_threads, 1024);
+
+    std::size_t n_edges = 0;
+    for (std::size_t i = 0; i < sharp.size(); ++i) {
+        if (sharp[i]) {
+            const auto e                = pmp::Edge(pmp::IndexType(i));
+            efeature[e]                 = true;
+            vfeature[mesh.vertex(e, 0)] = true;
+            vfeature[mesh.vertex(e, 1)] = true;
+            ++n_edges;
+        }
+    }
+    return n_edges;
+}
@@ -0,0 +1,321 @@
+// ============================================================================
+// Parallel garbage collection
+// ============================================================================
+// SurfaceMesh::garbage_collection() compacts in place: it swaps every deleted
+// element with the last live one across all property arrays, then remaps the
+// whole connectivity, one element at a time on one thread.
+// parallel_garbage_collection() numbers the kept elements once, then moves
+// them to the front of every property array concurrently, keeping their
+// order. The property arrays stay the same objects, so property handles
+// remain valid, and only one array is duplicated at a time. What is left for
+// garbage_collection() then is cutting off the deleted tail: it has nothing
+// to swap, and its remapping pass only meets identity maps.
+//
+// compact_into() builds a compacted copy instead, for callers that need the
+// input as it is (see lod.h).
+//
+// Deleted elements never have to be compacted before exporting:
+// export_points(), export_faces(), the geometry exporters and the NumPy
+// helpers skip them. Compact only before code that expects consecutive
+// indices, such as pmp::write() or raw points_view() rows.
+//
+// Properties of types not stored in snapshots can't be gathered generically;
+// meshes carrying such properties use SurfaceMesh::garbage_collection().
+// ============================================================================
+#pragma once
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <pmp/surface_mesh.h>
+
+#include "mesh_allocator.h"
+#include "mesh_buffers.h"
+#include "mesh_copy.h"
+#include "parallel.h"
+
+namespace pmp_rosetta::detail {
+
+    // Old slot of every element kept by the compaction of one kind
+    struct CompactionMap {
+        std::vector<pmp::IndexType> old_of; // new index -> old slot
+        std::vector<pmp::IndexType> new_of; // old slot -> new index, PMP_MAX_INDEX if deleted
+    };
+
+    template <typename Handle, typename IsDeleted>
+    inline CompactionMap compaction_map(std::size_t n_slots, IsDeleted &&is_deleted) {
+        CompactionMap map;
+        map.new_of.assign(n_slots, PMP_MAX_INDEX);
+        for (std::size_t i = 0; i < n_slots; ++i) {
+            if (!is_deleted(Handle(pmp::IndexType(i)))) {
+                map.new_of[i] = pmp::IndexType(map.old_of.size());
+                map.old_of.push_back(pmp::IndexType(i));
+            }
+        }
+        return map;
+    }
+
+    inline bool is_deleted_flag(const std::string &name) {
+        return name == "v:deleted" || name == "e:deleted" || name == "f:deleted";
+    }
+
+    // Add the property `name` of the elements of `kind` of mesh to result,
+    // element i of result taking the value of slot old_of[i] of mesh. Returns
+    // false, adding nothing, if its type is not one of SnapshotTypes.
+    inline bool gather_property(const pmp::SurfaceMesh &mesh, pmp::SurfaceMesh &result, char kind,
+                                const std::string                 &name,
+                                const std::vector<pmp::IndexType> &old_of,
+                                unsigned int                       n_threads) {
+        return find_type(SnapshotTypes{}, [&](auto tag) {
+            using T          = typename decltype(tag)::type;
+            const auto *from = property_vector<T>(mesh, kind, name);
+            if (!from) {
+                return false;
+            }
+            auto &to = make_property_vector<T>(result, kind, name);
+            if constexpr (std::is_same_v<T, bool>) {
+                // Bit-packed: concurrent writes would race
+                for (std::size_t i = 0; i < old_of.size(); ++i) {
+                    to[i] = (*from)[old_of[i]];
+                }
+            } else {
+                pmp_rosetta::parallel_for(
+                    0, old_of.size(), [&](std::size_t i) { to[i] = (*from)[old_of[i]]; },
+                    n_threads);
+            }
+            return true;
+        });
+    }
+
+    // Move the values of the property `name` of the elements of `kind` to
+    // the front of its array, element i taking the value of slot old_of[i].
+    // old_of must be increasing. Returns false if its type is not one of
+    // SnapshotTypes.
+    inline bool compact_property(pmp::SurfaceMesh &mesh, char kind, const std::string &name,
+                                 const std::vector<pmp::IndexType> &old_of,
+                                 unsigned int                       n_threads) {
+        return find_type(SnapshotTypes{}, [&](auto tag) {
+            using T      = typename decltype(tag)::type;
+            auto *values = property_vector<T>(mesh, kind, name);
+            if (!values) {
+                return false;
+            }
+            auto &to = *values;
+            if constexpr (std::is_same_v<T, bool>) {
+                // Bit-packed: concurrent writes would race. Going forward,
+                // old_of[i] >= i has not been overwritten yet.
+                for (std::size_t i = 0; i < old_of.size(); ++i) {
+                    to[i] = to[old_of[i]];
+                }
+            } else {
+                std::vector<T> kept(old_of.size());
+                pmp_rosetta::parallel_for(
+                    0, old_of.size(), [&](std::size_t i) { kept[i] = to[old_of[i]]; },
+                    n_threads);
+                pmp_rosetta::parallel_for(
+                    0, kept.size(), [&](std::size_t i) { to[i] = kept[i]; }, n_threads);
+            }
+            return true;
+        });
+    }
+
+    // Flag the first n_kept elements of `kind` as live, the others as deleted
+    inline void set_deleted_tail(pmp::SurfaceMesh &mesh, char kind, std::size_t n_kept) {
+        auto &deleted = make_property_vector<bool>(mesh, kind, std::string(1, kind) + ":deleted");
+        for (std::size_t i = 0; i < deleted.size(); ++i) {
+            deleted[i] = i >= n_kept;
+        }
+    }
+
+    // Make result a copy of mesh without its deleted elements, with the same
+    // properties in the same order
+    inline void compact_into(pmp::SurfaceMesh &result, const pmp::SurfaceMesh &mesh,
+                             unsigned int n_threads) {
+        for (char kind : {'v', 'h', 'e', 'f'}) {
+            for (const auto &name : property_names(mesh, kind)) {
+                if (!is_connectivity_property(name) && !has_supported_type(mesh, kind, name)) {
+                    result = mesh;
+                    result.garbage_collection();
+                    return;
+                }
+            }
+        }
+
+        const auto vmap = compaction_map<pmp::Vertex>(
+            mesh.vertices_size(), [&](pmp::Vertex v) { return mesh.is_deleted(v); });
+        const auto emap = compaction_map<pmp::Edge>(
+            mesh.edges_size(), [&](pmp::Edge e) { return mesh.is_deleted(e); });
+        const auto fmap = compaction_map<pmp::Face>(
+            mesh.faces_size(), [&](pmp::Face f) { return mesh.is_deleted(f); });
+
+        // Halfedges follow their edge
+        std::vector<pmp::IndexType> h_old_of(2 * emap.old_of.size());
+        for (std::size_t e = 0; e < emap.old_of.size(); ++e) {
+            h_old_of[2 * e]     = 2 * emap.old_of[e];
+            h_old_of[2 * e + 1] = 2 * emap.old_of[e] + 1;
+        }
+        const auto new_halfedge = [&](pmp::Halfedge h) {
+            return pmp::Halfedge(2 * emap.new_of[h.idx() / 2] + (h.idx() & 1));
+        };
+
+        result.clear();
+        result.reserve(vmap.old_of.size(), emap.old_of.size(), fmap.old_of.size());
+        for (std::size_t v = 0; v < vmap.old_of.size(); ++v) {
+            SurfaceMeshAllocator::allocate_vertex(result);
+        }
+        for (std::size_t e = 0; e < emap.old_of.size(); ++e) {
+            SurfaceMeshAllocator::allocate_edge(result, pmp::Vertex(0), pmp::Vertex(0));
+        }
+        for (std::size_t f = 0; f < fmap.old_of.size(); ++f) {
+            SurfaceMeshAllocator::allocate_face(result);
+        }
+
+        pmp_rosetta::parallel_for(
+            0, h_old_of.size(),
+            [&](std::size_t i) {
+                const auto h   = pmp::Halfedge(pmp::IndexType(i));
+                const auto old = pmp::Halfedge(h_old_of[i]);
+                result.set_vertex(h, pmp::Vertex(vmap.new_of[mesh.to_vertex(old).idx()]));
+                result.set_next_halfedge(h, new_halfedge(mesh.next_halfedge(old)));
+                const auto f = mesh.face(old);
+                result.set_face(h, f.is_valid() ? pmp::Face(fmap.new_of[f.idx()]) : pmp::Face());
+            },
+            n_threads);
+        pmp_rosetta::parallel_for(
+            0, vmap.old_of.size(),
+            [&](std::size_t i) {
+                const auto h = mesh.halfedge(pmp::Vertex(vmap.old_of[i]));
+                if (h.is_valid()) {
+                    result.set_halfedge(pmp::Vertex(pmp::IndexType(i)), new_halfedge(h));
+                }
+            },
+            n_threads);
+        pmp_rosetta::parallel_for(
+            0, fmap.old_of.size(),
+            [&](std::size_t i) {
+                const auto h = mesh.halfedge(pmp::Face(fmap.old_of[i]));
+                result.set_halfedge(pmp::Face(pmp::IndexType(i)), new_halfedge(h));
+            },
+            n_threads);
+
+        // The deleted flags of the result are already all false
+        for (char kind : {'v', 'h', 'e', 'f'}) {
+            const auto &old_of = kind == 'v'   ? vmap.old_of
+                                 : kind == 'h' ? h_old_of
+                                 : kind == 'e' ? emap.old_of
+                                               : fmap.old_of;
+            for (const auto &name : property_names(mesh, kind)) {
+                if (!is_connectivity_property(name) && !is_deleted_flag(name)) {
+                    gather_property(mesh, result, kind, name, old_of, n_threads);
+                }
+            }
+        }
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Remove the deleted elements of a mesh, like mesh.garbage_collection(), with
+// the remapping spread over n_threads threads (0: all cores). The kept
+// elements keep their order. As with garbage_collection(), property handles
+// taken before the call stay valid and refer to the renumbered elements.
+inline void parallel_garbage_collection(pmp::SurfaceMesh &mesh, unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    if (!mesh.has_garbage()) {
+        return;
+    }
+    for (char kind : {'v', 'h', 'e', 'f'}) {
+        for (const auto &name : property_names(mesh, kind)) {
+            if (!is_connectivity_property(name) && !has_supported_type(mesh, kind, name)) {
+                mesh.garbage_collection();
+                return;
+            }
+        }
+    }
+
+    const auto vmap = compaction_map<pmp::Vertex>(
+        mesh.vertices_size(), [&](pmp::Vertex v) { return mesh.is_deleted(v); });
+    const auto emap = compaction_map<pmp::Edge>(
+        mesh.edges_size(), [&](pmp::Edge e) { return mesh.is_deleted(e); });
+    const auto fmap = compaction_map<pmp::Face>(
+        mesh.faces_size(), [&](pmp::Face f) { return mesh.is_deleted(f); });
+
+    // Halfedges follow their edge
+    std::vector<pmp::IndexType> h_old_of(2 * emap.old_of.size());
+    for (std::size_t e = 0; e < emap.old_of.size(); ++e) {
+        h_old_of[2 * e]     = 2 * emap.old_of[e];
+        h_old_of[2 * e + 1] = 2 * emap.old_of[e] + 1;
+    }
+    const auto new_halfedge = [&](pmp::Halfedge h) {
+        return h.is_valid() ? pmp::Halfedge(2 * emap.new_of[h.idx() / 2] + (h.idx() & 1))
+                            : pmp::Halfedge();
+    };
+
+    // The new connectivity is read from the old one before anything moves
+    const auto                 nh = h_old_of.size();
+    std::vector<pmp::Vertex>   h_vertex(nh);
+    std::vector<pmp::Halfedge> h_next(nh);
+    std::vector<pmp::Face>     h_face(nh);
+    std::vector<pmp::Halfedge> v_halfedge(vmap.old_of.size());
+    std::vector<pmp::Halfedge> f_halfedge(fmap.old_of.size());
+    pmp_rosetta::parallel_for(
+        0, nh,
+        [&](std::size_t i) {
+            const auto old = pmp::Halfedge(h_old_of[i]);
+            const auto f   = mesh.face(old);
+            h_vertex[i]    = pmp::Vertex(vmap.new_of[mesh.to_vertex(old).idx()]);
+            h_next[i]      = new_halfedge(mesh.next_halfedge(old));
+            h_face[i]      = f.is_valid() ? pmp::Face(fmap.new_of[f.idx()]) : pmp::Face();
+        },
+        n_threads);
+    pmp_rosetta::parallel_for(
+        0, v_halfedge.size(),
+        [&](std::size_t i) {
+            v_halfedge[i] = new_halfedge(mesh.halfedge(pmp::Vertex(vmap.old_of[i])));
+        },
+        n_threads);
+    pmp_rosetta::parallel_for(
+        0, f_halfedge.size(),
+        [&](std::size_t i) {
+            f_halfedge[i] = new_halfedge(mesh.halfedge(pmp::Face(fmap.old_of[i])));
+        },
+        n_threads);
+
+    for (char kind : {'v', 'h', 'e', 'f'}) {
+        const auto &old_of = kind == 'v'   ? vmap.old_of
+                             : kind == 'h' ? h_old_of
+                             : kind == 'e' ? emap.old_of
+                                           : fmap.old_of;
+        for (const auto &name : property_names(mesh, kind)) {
+            if (!is_connectivity_property(name) && !is_deleted_flag(name)) {
+                compact_property(mesh, kind, name, old_of, n_threads);
+            }
+        }
+    }
+
+    // Every kept halfedge is the next of exactly one other, so the previous
+    // links set along with the next ones are written once each
+    pmp_rosetta::parallel_for(
+        0, nh,
+        [&](std::size_t i) {
+            const auto h = pmp::Halfedge(pmp::IndexType(i));
+            mesh.set_vertex(h, h_vertex[i]);
+            mesh.set_next_halfedge(h, h_next[i]);
+            mesh.set_face(h, h_face[i]);
+        },
+        n_threads);
+    pmp_rosetta::parallel_for(
+        0, v_halfedge.size(),
+        [&](std::size_t i) { mesh.set_halfedge(pmp::Vertex(pmp::IndexType(i)), v_halfedge[i]); },
+        n_threads);
+    pmp_rosetta::parallel_for(
+        0, f_halfedge.size(),
+        [&](std::size_t i) { mesh.set_halfedge(pmp::Face(pmp::IndexType(i)), f_halfedge[i]); },
+        n_threads);
+
+    set_deleted_tail(mesh, 'v', vmap.old_of.size());
+    set_deleted_tail(mesh, 'e', emap.old_of.size());
+    set_deleted_tail(mesh, 'f', fmap.old_of.size());
+    mesh.garbage_collection();
+}
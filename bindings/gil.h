@@ -0,0 +1,115 @@
+// ============================================================================
+// Python GIL release for long-running registered functions
+// ============================================================================
+// When this header is compiled into the generated Python module, Python.h is
+// on the include path and ScopedGILRelease gives the interpreter lock back for
+// the duration of a native call, so several Python threads can process
+// independent meshes concurrently. In every other context (generator, JS,
+// WASM...) it compiles to nothing.
+//
+// Usage: name the function once at namespace scope, then register it inside
+// pmp_rosetta::register_all() under the same name:
+//   PMP_PROFILE_NAME(pmp::decimate, "decimate")
+//   PMP_REGISTER_FUNCTION_NOGIL(pmp::decimate, "decimate");
+//
+// Only wrap functions that do not call back into Python. The caller remains
+// responsible for not sharing one SurfaceMesh between concurrent calls.
+// Functions registered this way are also timed under that name while
+// profiling is on (see profiling.h), from Python and from C++ callers alike.
+// ============================================================================
+#pragma once
+
+#include <utility>
+
+#include "profiling.h"
+
+#if __has_include(<Python.h>)
+#include <Python.h>
+#define PMP_ROSETTA_HAS_PYTHON 1
+#endif
+
+namespace pmp_rosetta {
+
+    namespace detail {
+
+        // Whether a and b are the same string; false if either is null
+        constexpr bool same_name(const char *a, const char *b) {
+            if (!a || !b) {
+                return false;
+            }
+            for (; *a && *a == *b; ++a, ++b) {
+            }
+            return *a == *b;
+        }
+
+    } // namespace detail
+
+    // Release the GIL for the lifetime of the object, if the calling thread holds it
+    class ScopedGILRelease {
+    public:
+        ScopedGILRelease() {
+#ifdef PMP_ROSETTA_HAS_PYTHON
+            if (Py_IsInitialized() && PyGILState_Check()) {
+                state_ = PyEval_SaveThread();
+            }
+#endif
+        }
+
+        ~ScopedGILRelease() {
+#ifdef PMP_ROSETTA_HAS_PYTHON
+            if (state_) {
+                PyEval_RestoreThread(state_);
+            }
+#endif
+        }
+
+        ScopedGILRelease(const ScopedGILRelease &)            = delete;
+        ScopedGILRelease &operator=(const ScopedGILRelease &) = delete;
+
+    private:
+#ifdef PMP_ROSETTA_HAS_PYTHON
+        PyThreadState *state_ = nullptr;
+#endif
+    };
+
+    // Same signature as F, but runs F with the GIL released, in a profiling
+    // scope named after its registration (see profiling.h)
+    template <auto F> struct WithoutGIL;
+
+    template <typename R, typename... Args, R (*F)(Args...)> struct WithoutGIL<F> {
+        static R call(Args... args) {
+            ScopedGILRelease release;
+            ProfileScope     scope(profile_name<F>);
+            return F(std::forward<Args>(args)...);
+        }
+    };
+
+} // namespace pmp_rosetta
+
+// Name func for profiling; at namespace scope, before func is registered or submitted
+#define PMP_PROFILE_NAME(func, name)                                                               \
+    namespace pmp_rosetta {                                                                        \
+        template <> inline constexpr const char *profile_name<&func> = name;                       \
+    }
+
+// Same for one overload of a free function, selected by its full signature
+#define PMP_PROFILE_OVERLOADED_NAME(func, name, signature)                                         \
+    namespace pmp_rosetta {                                                                        \
+        template <>                                                                                \
+        inline constexpr const char *profile_name<static_cast<signature>(&func)> = name;           \
+    }
+
+// Register a non-overloaded free function under `name`, releasing the GIL while it runs
+#define PMP_REGISTER_FUNCTION_NOGIL(func, name)                                                    \
+    static_assert(pmp_rosetta::detail::same_name(pmp_rosetta::profile_name<&func>, name),          \
+                  #func " needs PMP_PROFILE_NAME(" #func ", " #name ")");                          \
+    ROSETTA_REGISTER_OVERLOADED_FUNCTION_AS(pmp_rosetta::WithoutGIL<&func>::call, name,            \
+                                            decltype(&func))
+
+// Same for one overload of a free function, selected by its full signature
+#define PMP_REGISTER_OVERLOADED_FUNCTION_NOGIL(func, name, signature)                              \
+    static_assert(pmp_rosetta::detail::same_name(                                                  \
+                      pmp_rosetta::profile_name<static_cast<signature>(&func)>, name),             \
+                  #func " needs PMP_PROFILE_OVERLOADED_NAME(" #func ", " #name ", ...)");          \
+    ROSETTA_REGISTER_OVERLOADED_FUNCTION_AS(                                                       \
+        pmp_rosetta::WithoutGIL<static_cast<signature>(&func)>::call, name, signature)
@@ -0,0 +1,483 @@
+// ============================================================================
+// Asynchronous jobs on a shared native executor
+// ============================================================================
+// PMP_REGISTER_FUNCTION_ASYNC(func, name) registers a variant of a function
+// that queues the call on a process-wide executor and returns a Job at once.
+// The executor runs a few jobs at a time (each one still uses the thread pool
+// of parallel.h for its own kernels) and holds a bounded number of queued
+// ones: a submission to a full queue blocks, with the GIL released, until a
+// job starts. job_queue_full() lets an event loop wait for room instead.
+//
+// Arguments are copied into the job, except non-const references (the mesh
+// an algorithm works on), which are kept as references: the caller keeps
+// such an object alive and leaves it alone until the job is over.
+//
+// Every job that leaves the queue or finishes writes a byte to
+// job_notify_fd(), the read end of a non-blocking pipe, so an event loop can
+// watch it (asyncio add_reader, see pmp_async.py) and then check done() on
+// its pending jobs and job_queue_full(). There is no pipe on Windows (-1).
+//
+//   Job job = uniform_remeshing_async(mesh, 0.01, 10, true);
+//   ... job.done(), job.wait(-1), job.error()
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <any>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <pmp/exceptions.h>
+
+#include "gil.h"
+#include "parallel.h"
+#include "profiling.h"
+
+namespace pmp_rosetta::detail {
+
+    enum class JobStatus { Queued, Running, Done, Failed, Cancelled };
+
+    struct JobState {
+        std::mutex                            mutex;
+        std::condition_variable               over;
+        JobStatus                             status = JobStatus::Queued;
+        std::string                           error;
+        std::any                              result;
+        std::function<std::any()>             work;
+        std::chrono::steady_clock::time_point submitted = std::chrono::steady_clock::now();
+        double                                queued_seconds = 0;
+        double                                run_seconds    = 0;
+    };
+
+    // Pipe written once per job start or end
+    class JobNotifier {
+    public:
+        JobNotifier() {
+#ifndef _WIN32
+            if (::pipe(fds_) == 0) {
+                for (int fd : fds_) {
+                    ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+                    ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+                }
+            }
+#endif
+        }
+
+        ~JobNotifier() {
+#ifndef _WIN32
+            for (int fd : fds_) {
+                if (fd >= 0) {
+                    ::close(fd);
+                }
+            }
+#endif
+        }
+
+        JobNotifier(const JobNotifier &)            = delete;
+        JobNotifier &operator=(const JobNotifier &) = delete;
+
+        int read_fd() const { return fds_[0]; }
+
+        // A full pipe already wakes its reader: dropping the byte is fine
+        void notify() {
+#ifndef _WIN32
+            if (fds_[1] >= 0) {
+                const char byte = 1;
+                [[maybe_unused]] const auto n = ::write(fds_[1], &byte, 1);
+            }
+#endif
+        }
+
+    private:
+        int fds_[2] = {-1, -1};
+    };
+
+    inline JobNotifier &job_notifier() {
+        static JobNotifier notifier;
+        return notifier;
+    }
+
+    class JobExecutor {
+    public:
+        JobExecutor(std::size_t n_workers, std::size_t max_queued)
+            : n_workers_(resolve_threads(n_workers)),
+              max_queued_(std::max<std::size_t>(max_queued, 1)) {}
+
+        // Queued jobs are cancelled, running ones finish
+        ~JobExecutor() {
+            std::deque<std::shared_ptr<JobState>> dropped;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+                dropped.swap(queue_);
+            }
+            for (auto &job : dropped) {
+                finish(*job, JobStatus::Cancelled, "job executor shut down", {});
+            }
+            wake_.notify_all();
+            room_.notify_all();
+            for (auto &w : workers_) {
+                w.join();
+            }
+        }
+
+        JobExecutor(const JobExecutor &)            = delete;
+        JobExecutor &operator=(const JobExecutor &) = delete;
+
+        std::size_t n_workers() const { return n_workers_; }
+        std::size_t max_queued() const { return max_queued_; }
+
+        // Block while the queue is full. Workers start on first use.
+        void submit(std::shared_ptr<JobState> job) {
+            std::unique_lock<std::mutex> lock(mutex_);
+            room_.wait(lock, [this] { return stop_ || queue_.size() < max_queued_; });
+            if (stop_) {
+                throw pmp::InvalidInputException("job executor shut down");
+            }
+            queue_.push_back(std::move(job));
+            if (workers_.size() < n_workers_ && queue_.size() > idle_) {
+                workers_.emplace_back([this] { run(); });
+            }
+            wake_.notify_one();
+        }
+
+        // Remove a job that has not started yet
+        bool cancel(const std::shared_ptr<JobState> &job) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                const auto                  it = std::find(queue_.begin(), queue_.end(), job);
+                if (it == queue_.end()) {
+                    return false;
+                }
+                queue_.erase(it);
+            }
+            room_.notify_one();
+            finish(*job, JobStatus::Cancelled, "cancelled", {});
+            return true;
+        }
+
+        std::size_t n_queued() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return queue_.size();
+        }
+
+        std::size_t n_running() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return running_;
+        }
+
+        bool busy() const {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return !queue_.empty() || running_ > 0;
+        }
+
+        static void finish(JobState &job, JobStatus status, std::string error, std::any result) {
+            {
+                std::lock_guard<std::mutex> lock(job.mutex);
+                job.status = status;
+                job.error  = std::move(error);
+                job.result = std::move(result);
+                job.work   = nullptr; // drops the copied arguments
+            }
+            job.over.notify_all();
+            job_notifier().notify();
+        }
+
+    private:
+        void run() {
+            for (;;) {
+                std::shared_ptr<JobState> job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    ++idle_;
+                    wake_.wait(lock, [this] { return stop_ || !queue_.empty(); });
+                    --idle_;
+                    if (queue_.empty()) {
+                        return; // stopping
+                    }
+                    job = std::move(queue_.front());
+                    queue_.pop_front();
+                    ++running_;
+                }
+                room_.notify_one();
+                job_notifier().notify();
+
+                const auto                start = std::chrono::steady_clock::now();
+                std::function<std::any()> work;
+                {
+                    std::lock_guard<std::mutex> lock(job->mutex);
+                    job->status = JobStatus::Running;
+                    job->queued_seconds =
+                        std::chrono::duration<double>(start - job->submitted).count();
+                    work.swap(job->work);
+                }
+                auto        status = JobStatus::Done;
+                std::string error;
+                std::any    result;
+                try {
+                    result = work();
+                } catch (const std::exception &e) {
+                    status = JobStatus::Failed;
+                    error  = e.what();
+                } catch (...) {
+                    status = JobStatus::Failed;
+                    error  = "unknown error";
+                }
+                work = nullptr;
+                {
+                    std::lock_guard<std::mutex> lock(job->mutex);
+                    job->run_seconds =
+                        std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                            .count();
+                }
+                {
+                    // Leave running_ before finish() wakes anyone, so busy() no longer
+                    // counts this job
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    --running_;
+                }
+                finish(*job, status, std::move(error), std::move(result));
+            }
+        }
+
+        const std::size_t n_workers_;
+        const std::size_t max_queued_;
+
+        mutable std::mutex                    mutex_;
+        std::condition_variable               wake_; // a job was queued
+        std::condition_variable               room_; // a queued job left the queue
+        std::deque<std::shared_ptr<JobState>> queue_;
+        std::vector<std::thread>              workers_;
+        std::size_t                           idle_    = 0;
+        std::size_t                           running_ = 0;
+        bool                                  stop_    = false;
+    };
+
+    struct JobExecutorHolder {
+        std::mutex                   mutex;
+        std::shared_ptr<JobExecutor> executor;
+    };
+
+    // Workers notify job_notifier() until ~JobExecutor joins them, so the
+    // notifier is constructed first: statics are destroyed in reverse order
+    inline JobExecutorHolder &job_executor_holder() {
+        job_notifier();
+        static JobExecutorHolder holder;
+        return holder;
+    }
+
+    // Two jobs at a time by default: each one spreads its kernels over all
+    // cores already, more would mostly add memory. The copy keeps the
+    // executor alive while it is used, even if set_job_limits() replaces it.
+    inline std::shared_ptr<JobExecutor> job_executor() {
+        auto                       &h = job_executor_holder();
+        std::lock_guard<std::mutex> lock(h.mutex);
+        if (!h.executor) {
+            h.executor =
+                std::make_shared<JobExecutor>(std::min<std::size_t>(resolve_threads(0), 2), 64);
+        }
+        return h.executor;
+    }
+
+    // How an argument of type T is kept in a job: non-const lvalue
+    // references as references, everything else by value
+    template <typename T>
+    using JobArgument =
+        std::conditional_t<std::is_lvalue_reference_v<T> &&
+                               !std::is_const_v<std::remove_reference_t<T>>,
+                           std::reference_wrapper<std::remove_reference_t<T>>, std::decay_t<T>>;
+
+} // namespace pmp_rosetta::detail
+
+// Handle on a queued, running or finished asynchronous call. Copies refer to
+// the same job.
+class Job {
+public:
+    Job() = default;
+
+    explicit Job(std::shared_ptr<pmp_rosetta::detail::JobState> state)
+        : state_(std::move(state)) {}
+
+    // One of "queued", "running", "done", "failed", "cancelled"
+    std::string status() const {
+        using pmp_rosetta::detail::JobStatus;
+        switch (current()) {
+            case JobStatus::Queued:
+                return "queued";
+            case JobStatus::Running:
+                return "running";
+            case JobStatus::Done:
+                return "done";
+            case JobStatus::Failed:
+                return "failed";
+            default:
+                return "cancelled";
+        }
+    }
+
+    // Whether the job is over, whichever way
+    bool done() const {
+        const auto s = current();
+        return s != pmp_rosetta::detail::JobStatus::Queued &&
+               s != pmp_rosetta::detail::JobStatus::Running;
+    }
+
+    bool ok() const { return current() == pmp_rosetta::detail::JobStatus::Done; }
+
+    // Message of the exception of a failed job, or why it was cancelled
+    std::string error() const {
+        if (!state_) {
+            return "empty job";
+        }
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->error;
+    }
+
+    // Block until the job is over, for at most timeout_seconds when that is
+    // non-negative. Returns done().
+    bool wait(double timeout_seconds) const {
+        if (!state_) {
+            return true;
+        }
+        pmp_rosetta::ScopedGILRelease release;
+        std::unique_lock<std::mutex>  lock(state_->mutex);
+        const auto                    over = [&] {
+            return state_->status != pmp_rosetta::detail::JobStatus::Queued &&
+                   state_->status != pmp_rosetta::detail::JobStatus::Running;
+        };
+        if (timeout_seconds < 0) {
+            state_->over.wait(lock, over);
+            return true;
+        }
+        return state_->over.wait_for(lock, std::chrono::duration<double>(timeout_seconds), over);
+    }
+
+    // Take the job out of the queue if it has not started. Returns whether it
+    // was cancelled; a running job always completes.
+    bool cancel() { return state_ && pmp_rosetta::detail::job_executor()->cancel(state_); }
+
+    // Time spent in the queue, and running
+    double queued_seconds() const {
+        return timing(&pmp_rosetta::detail::JobState::queued_seconds);
+    }
+    double run_seconds() const { return timing(&pmp_rosetta::detail::JobState::run_seconds); }
+
+    // Return value of a finished job of a function returning R. Throws for
+    // jobs that are not done or returned something else.
+    template <typename R> R result() const {
+        if (!ok()) {
+            throw pmp::InvalidInputException("Job::result: job is " + status());
+        }
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        const auto                 *value = std::any_cast<R>(&state_->result);
+        if (!value) {
+            throw pmp::InvalidInputException("Job::result: job returned another type");
+        }
+        return *value;
+    }
+
+private:
+    pmp_rosetta::detail::JobStatus current() const {
+        if (!state_) {
+            return pmp_rosetta::detail::JobStatus::Cancelled;
+        }
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->status;
+    }
+
+    double timing(double pmp_rosetta::detail::JobState::*field) const {
+        if (!state_) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return (*state_).*field;
+    }
+
+    std::shared_ptr<pmp_rosetta::detail::JobState> state_;
+};
+
+namespace pmp_rosetta {
+
+    template <auto F> struct Async;
+
+    // Queue F(args...) on the job executor: the signature of F, returning a Job
+    template <typename R, typename... Args, R (*F)(Args...)> struct Async<F> {
+        static Job submit(Args... args) {
+            auto job  = std::make_shared<detail::JobState>();
+            job->work = [stored = std::tuple<detail::JobArgument<Args>...>(
+                             std::forward<Args>(args)...)]() mutable -> std::any {
+                ProfileScope scope(profile_name<F>);
+                return std::apply(
+                    [](auto &...a) -> std::any {
+                        if constexpr (std::is_void_v<R>) {
+                            F(a...);
+                            return {};
+                        } else {
+                            return F(a...);
+                        }
+                    },
+                    stored);
+            };
+            profile_count("jobs.submitted", 1);
+            detail::job_executor()->submit(job);
+            return Job(std::move(job));
+        }
+    };
+
+} // namespace pmp_rosetta
+
+// Change the number of jobs run at a time (0: one per core) and of queued
+// jobs before submissions block. Only while no job is queued or running.
+inline void set_job_limits(unsigned int n_workers, unsigned int max_queued) {
+    auto                       &h = pmp_rosetta::detail::job_executor_holder();
+    std::lock_guard<std::mutex> lock(h.mutex);
+    if (h.executor && h.executor->busy()) {
+        throw pmp::InvalidInputException("set_job_limits: jobs are queued or running");
+    }
+    h.executor = std::make_shared<pmp_rosetta::detail::JobExecutor>(n_workers, max_queued);
+}
+
+inline std::size_t job_workers() {
+    return pmp_rosetta::detail::job_executor()->n_workers();
+}
+
+inline std::size_t jobs_queued() {
+    return pmp_rosetta::detail::job_executor()->n_queued();
+}
+
+inline std::size_t jobs_running() {
+    return pmp_rosetta::detail::job_executor()->n_running();
+}
+
+// Whether a submission would block now
+inline bool job_queue_full() {
+    const auto e = pmp_rosetta::detail::job_executor();
+    return e->n_queued() >= e->max_queued();
+}
+
+inline int job_notify_fd() {
+    return pmp_rosetta::detail::job_notifier().read_fd();
+}
+
+// Register func's queueing variant under `name`; the job runs are timed under
+// func's PMP_PROFILE_NAME
+#define PMP_REGISTER_FUNCTION_ASYNC(func, name)                                                    \
+    ROSETTA_REGISTER_OVERLOADED_FUNCTION_AS(                                                       \
+        pmp_rosetta::WithoutGIL<&pmp_rosetta::Async<&func>::submit>::call, name,                   \
+        decltype(&pmp_rosetta::Async<&func>::submit))
@@ -0,0 +1,576 @@
+// ============================================================================
+// Cached Laplacian systems
+// ============================================================================
+// pmp::implicit_smoothing(), pmp::harmonic_parameterization() and
+// pmp::lscm_parameterization() assemble and factorize a sparse system from
+// scratch on every call. LaplacianSystem assembles the cotangent (or uniform)
+// Laplacian and mass matrix of a mesh once, and keeps the Cholesky (LDLT)
+// factorization of each system it solved:
+// - the symbolic analysis is redone only when the connectivity changes;
+// - the numeric factorization only when the geometry is updated or, for
+//   smoothing, when the timestep differs from the previous call;
+// so repeated solves with the same settings cost one back-substitution.
+//
+// Each call checks the connectivity of the mesh it is given and rebuilds
+// everything if it changed. Vertex moves are not picked up automatically:
+// the operators stay those of the geometry the system was built from until
+// update_geometry() is called. Copies share the same cached state.
+// ============================================================================
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Sparse>
+
+#include <pmp/algorithms/differential_geometry.h>
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "gil.h"
+#include "parallel.h"
+
+namespace pmp_rosetta::detail {
+
+    using SparseMatrix = Eigen::SparseMatrix<double>;
+    using LDLTSolver   = Eigen::SimplicialLDLT<SparseMatrix>;
+
+    // Fingerprint of the connectivity of a mesh
+    struct TopologySignature {
+        std::size_t   vertices_size = 0;
+        std::size_t   n_vertices    = 0;
+        std::size_t   n_edges       = 0;
+        std::size_t   n_faces       = 0;
+        std::uint64_t hash          = 0;
+
+        explicit TopologySignature(const pmp::SurfaceMesh &mesh)
+            : vertices_size(mesh.vertices_size()), n_vertices(mesh.n_vertices()),
+              n_edges(mesh.n_edges()), n_faces(mesh.n_faces()) {
+            // FNV-1a over the target vertex of every halfedge
+            hash = 0xcbf29ce484222325ull;
+            for (auto h : mesh.halfedges()) {
+                hash = (hash ^ h.idx()) * 0x100000001b3ull;
+                hash = (hash ^ mesh.to_vertex(h).idx()) * 0x100000001b3ull;
+            }
+        }
+
+        TopologySignature() = default;
+
+        bool operator==(const TopologySignature &) const = default;
+    };
+
+    // One cached linear system: its free unknowns (PMP_MAX_INDEX for fixed
+    // ones) and factorization
+    struct CachedSolve {
+        std::vector<pmp::IndexType> free_of;
+        std::size_t                 n_free   = 0;
+        bool                        analyzed = false;
+        bool                        factored = false;
+        double                      timestep = 0;
+        LDLTSolver                  solver;
+
+        void reset() {
+            free_of.clear();
+            n_free   = 0;
+            analyzed = false;
+            factored = false;
+        }
+
+        // Number the unknowns that are not fixed
+        void set_free(const std::vector<char> &fixed) {
+            free_of.assign(fixed.size(), PMP_MAX_INDEX);
+            n_free = 0;
+            for (std::size_t i = 0; i < fixed.size(); ++i) {
+                if (!fixed[i]) {
+                    free_of[i] = pmp::IndexType(n_free++);
+                }
+            }
+            analyzed = factored = false;
+        }
+
+        void factorize(const SparseMatrix &A) {
+            if (!analyzed) {
+                solver.analyzePattern(A);
+                analyzed = true;
+            }
+            solver.factorize(A);
+            if (solver.info() != Eigen::Success) {
+                factored = false;
+                throw pmp::SolverException("LaplacianSystem: factorization failed");
+            }
+            factored = true;
+        }
+
+        Eigen::MatrixXd solve(const Eigen::MatrixXd &B) const {
+            Eigen::MatrixXd X = solver.solve(B);
+            if (solver.info() != Eigen::Success) {
+                throw pmp::SolverException("LaplacianSystem: solve failed");
+            }
+            return X;
+        }
+    };
+
+    struct LaplacianState {
+        bool              uniform = false;
+        TopologySignature signature;
+
+        // Vertices in compact order, and the compact index of each slot
+        std::vector<pmp::Vertex>    vertices;
+        std::vector<pmp::IndexType> index_of;
+        std::vector<char>           boundary;
+
+        // Edges as compact vertex pairs, with their cotangent weight
+        // (cot alpha + cot beta) / 2 and the weight used by the Laplacian
+        std::vector<std::array<pmp::IndexType, 2>> edges;
+        std::vector<double>                        cotan;
+        std::vector<double>                        weights;
+        std::vector<double>                        mass;
+
+        // Boundary edges as (from, to) of their interior halfedge
+        std::vector<std::array<pmp::IndexType, 2>> boundary_edges;
+
+        CachedSolve    smoothing;
+        CachedSolve    harmonic;
+        CachedSolve    lscm;
+        pmp::IndexType lscm_pin         = 0; // vertex pinned at (1, 0)
+        std::size_t    n_factorizations = 0;
+        std::mutex     mutex;
+    };
+
+    // Cotangent of the angle at c in the triangle (a, b, c)
+    inline double cotan_at(const pmp::Point &a, const pmp::Point &b, const pmp::Point &c) {
+        const pmp::dvec3 u = pmp::dvec3(a) - pmp::dvec3(c);
+        const pmp::dvec3 v = pmp::dvec3(b) - pmp::dvec3(c);
+        const double     s = norm(cross(u, v));
+        return s > std::numeric_limits<double>::min() ? dot(u, v) / s : 0.0;
+    }
+
+    inline void assemble_connectivity(LaplacianState &s, const pmp::SurfaceMesh &mesh) {
+        s.signature = TopologySignature(mesh);
+        s.vertices.clear();
+        s.vertices.reserve(mesh.n_vertices());
+        s.index_of.assign(mesh.vertices_size(), PMP_MAX_INDEX);
+        for (auto v : mesh.vertices()) {
+            s.index_of[v.idx()] = pmp::IndexType(s.vertices.size());
+            s.vertices.push_back(v);
+        }
+        s.boundary.resize(s.vertices.size());
+        for (std::size_t i = 0; i < s.vertices.size(); ++i) {
+            s.boundary[i] = mesh.is_boundary(s.vertices[i]);
+        }
+
+        s.edges.clear();
+        s.boundary_edges.clear();
+        s.edges.reserve(mesh.n_edges());
+        for (auto e : mesh.edges()) {
+            s.edges.push_back({s.index_of[mesh.vertex(e, 0).idx()],
+                               s.index_of[mesh.vertex(e, 1).idx()]});
+            if (mesh.is_boundary(e)) {
+                auto h = mesh.halfedge(e, 0);
+                if (mesh.is_boundary(h)) {
+                    h = mesh.opposite_halfedge(h);
+                }
+                s.boundary_edges.push_back({s.index_of[mesh.from_vertex(h).idx()],
+                                            s.index_of[mesh.to_vertex(h).idx()]});
+            }
+        }
+
+        s.smoothing.reset();
+        s.harmonic.reset();
+        s.lscm.reset();
+    }
+
+    inline void assemble_geometry(LaplacianState &s, const pmp::SurfaceMesh &mesh) {
+        std::vector<pmp::Edge> edges;
+        edges.reserve(s.edges.size());
+        for (auto e : mesh.edges()) {
+            edges.push_back(e);
+        }
+
+        s.cotan.resize(edges.size());
+        parallel_for(0, edges.size(), [&](std::size_t i) {
+            double w = 0;
+            for (unsigned k = 0; k < 2; ++k) {
+                const auto h = mesh.halfedge(edges[i], k);
+                if (!mesh.is_boundary(h)) {
+                    w += cotan_at(mesh.position(mesh.from_vertex(h)),
+                                  mesh.position(mesh.to_vertex(h)),
+                                  mesh.position(mesh.to_vertex(mesh.next_halfedge(h))));
+                }
+            }
+            s.cotan[i] = w / 2;
+        });
+        s.weights = s.uniform ? std::vector<double>(edges.size(), 1.0) : s.cotan;
+
+        s.mass.resize(s.vertices.size());
+        parallel_for(0, s.vertices.size(), [&](std::size_t i) {
+            s.mass[i] = s.uniform ? double(mesh.valence(s.vertices[i]))
+                                  : pmp::voronoi_area(mesh, s.vertices[i]);
+        });
+
+        // Values changed: the symbolic analyses are still valid
+        s.smoothing.factored = false;
+        s.harmonic.factored  = false;
+        s.lscm.reset();
+    }
+
+    // m * M + t * (D - W) restricted to the free unknowns of `solve`, where
+    // W holds the edge weights and D their row sums
+    inline SparseMatrix assemble_laplacian(const LaplacianState &s, const CachedSolve &solve,
+                                           double m, double t) {
+        std::vector<Eigen::Triplet<double>> triplets;
+        triplets.reserve(s.vertices.size() + 2 * s.edges.size());
+        std::vector<double> diagonal(s.vertices.size(), 0);
+        for (std::size_t i = 0; i < s.vertices.size(); ++i) {
+            diagonal[i] = m * s.mass[i];
+        }
+        for (std::size_t e = 0; e < s.edges.size(); ++e) {
+            const auto [a, b] = s.edges[e];
+            const double w    = t * s.weights[e];
+            diagonal[a] += w;
+            diagonal[b] += w;
+            const auto fa = solve.free_of[a], fb = solve.free_of[b];
+            if (fa != PMP_MAX_INDEX && fb != PMP_MAX_INDEX) {
+                triplets.emplace_back(fa, fb, -w);
+                triplets.emplace_back(fb, fa, -w);
+            }
+        }
+        for (std::size_t i = 0; i < s.vertices.size(); ++i) {
+            if (solve.free_of[i] != PMP_MAX_INDEX) {
+                triplets.emplace_back(solve.free_of[i], solve.free_of[i], diagonal[i]);
+            }
+        }
+        SparseMatrix A(solve.n_free, solve.n_free);
+        A.setFromTriplets(triplets.begin(), triplets.end());
+        return A;
+    }
+
+    // Boundary vertex loop containing the first boundary vertex
+    inline std::vector<pmp::Vertex> first_boundary_loop(const pmp::SurfaceMesh &mesh) {
+        std::vector<pmp::Vertex> loop;
+        for (auto h : mesh.halfedges()) {
+            if (!mesh.is_boundary(h)) {
+                continue;
+            }
+            auto hh = h;
+            do {
+                loop.push_back(mesh.to_vertex(hh));
+                hh = mesh.next_halfedge(hh);
+            } while (hh != h);
+            break;
+        }
+        return loop;
+    }
+
+} // namespace pmp_rosetta::detail
+
+class LaplacianSystem {
+public:
+    LaplacianSystem() = default;
+
+    explicit LaplacianSystem(const pmp::SurfaceMesh &mesh, bool use_uniform_laplace = false)
+        : state_(std::make_shared<pmp_rosetta::detail::LaplacianState>()) {
+        state_->uniform = use_uniform_laplace;
+        rebuild(mesh);
+    }
+
+    bool        empty() const { return !state_ || state_->vertices.empty(); }
+    std::size_t n_vertices() const { return state_ ? state_->vertices.size() : 0; }
+
+    // Number of numeric factorizations done so far, to check reuse
+    std::size_t n_factorizations() const { return state_ ? state_->n_factorizations : 0; }
+
+    // Whether mesh has the connectivity the system was built for
+    bool matches(const pmp::SurfaceMesh &mesh) const {
+        return state_ && state_->signature == pmp_rosetta::detail::TopologySignature(mesh);
+    }
+
+    // Re-assemble the matrices from the current vertex positions. Keeps the
+    // symbolic factorizations when the connectivity did not change.
+    void update_geometry(const pmp::SurfaceMesh &mesh) {
+        auto                         &s = state("update_geometry");
+        pmp_rosetta::ScopedGILRelease release;
+        std::lock_guard<std::mutex>   lock(s.mutex);
+        if (!sync(mesh)) {
+            pmp_rosetta::detail::assemble_geometry(s, mesh);
+        }
+    }
+
+    // Same as pmp::implicit_smoothing(mesh, timestep, iterations,
+    // use_uniform_laplace, rescale), with the operator of the cached
+    // geometry: boundary vertices stay fixed, and with rescale the surface
+    // area and centroid are restored afterwards.
+    void implicit_smoothing(pmp::SurfaceMesh &mesh, pmp::Scalar timestep, unsigned int iterations,
+                            bool rescale) {
+        using namespace pmp_rosetta::detail;
+        auto                         &s = state("implicit_smoothing");
+        pmp_rosetta::ScopedGILRelease release;
+        std::lock_guard<std::mutex>   lock(s.mutex);
+        sync(mesh);
+
+        auto &solve = s.smoothing;
+        if (solve.free_of.empty()) {
+            solve.set_free(s.boundary);
+        }
+        if (solve.n_free == 0 || iterations == 0) {
+            return;
+        }
+        if (!solve.factored || solve.timestep != double(timestep)) {
+            solve.factorize(assemble_laplacian(s, solve, 1, timestep));
+            solve.timestep = timestep;
+            ++s.n_factorizations;
+        }
+
+        const pmp::Point  center_before = pmp::centroid(mesh);
+        const pmp::Scalar area_before   = pmp::surface_area(mesh);
+
+        Eigen::MatrixXd B(solve.n_free, 3);
+        for (unsigned int iter = 0; iter < iterations; ++iter) {
+            for (std::size_t i = 0; i < s.vertices.size(); ++i) {
+                if (solve.free_of[i] != PMP_MAX_INDEX) {
+                    const auto &p = mesh.position(s.vertices[i]);
+                    for (int k = 0; k < 3; ++k) {
+                        B(solve.free_of[i], k) = s.mass[i] * p[k];
+                    }
+                }
+            }
+            // Fixed neighbors move to the right hand side
+            for (std::size_t e = 0; e < s.edges.size(); ++e) {
+                const auto [a, b] = s.edges[e];
+                const double w    = timestep * s.weights[e];
+                const auto   fa = solve.free_of[a], fb = solve.free_of[b];
+                if ((fa == PMP_MAX_INDEX) == (fb == PMP_MAX_INDEX)) {
+                    continue;
+                }
+                const auto  f = fa != PMP_MAX_INDEX ? fa : fb;
+                const auto &p = mesh.position(s.vertices[fa != PMP_MAX_INDEX ? b : a]);
+                for (int k = 0; k < 3; ++k) {
+                    B(f, k) += w * p[k];
+                }
+            }
+
+            const Eigen::MatrixXd X = solve.solve(B);
+            for (std::size_t i = 0; i < s.vertices.size(); ++i) {
+                if (solve.free_of[i] != PMP_MAX_INDEX) {
+                    const auto f = solve.free_of[i];
+                    mesh.position(s.vertices[i]) = pmp::Point(X(f, 0), X(f, 1), X(f, 2));
+                }
+            }
+        }
+
+        if (rescale) {
+            const pmp::Point  center_after = pmp::centroid(mesh);
+            const pmp::Scalar area_after   = pmp::surface_area(mesh);
+            const pmp::Scalar scale        = std::sqrt(area_before / area_after);
+            for (auto v : mesh.vertices()) {
+                auto &p = mesh.position(v);
+                p       = (p - center_after) * scale + center_before;
+            }
+        }
+    }
+
+    // Same as pmp::harmonic_parameterization(): the first boundary loop is
+    // mapped to a circle by arc length, the interior by solving the Laplace
+    // equation. Writes "v:tex".
+    void harmonic_parameterization(pmp::SurfaceMesh &mesh) {
+        using namespace pmp_rosetta::detail;
+        auto                         &s = state("harmonic_parameterization");
+        pmp_rosetta::ScopedGILRelease release;
+        std::lock_guard<std::mutex>   lock(s.mutex);
+        sync(mesh);
+
+        const auto loop = first_boundary_loop(mesh);
+        if (loop.empty()) {
+            throw pmp::InvalidInputException("Mesh has no boundary.");
+        }
+
+        auto &solve = s.harmonic;
+        if (solve.free_of.empty()) {
+            std::vector<char> fixed(s.vertices.size(), 0);
+            for (auto v : loop) {
+                fixed[s.index_of[v.idx()]] = 1;
+            }
+            solve.set_free(fixed);
+        }
+
+        // Boundary positions from the current arc lengths
+        auto                tex = mesh.vertex_property<pmp::TexCoord>("v:tex");
+        std::vector<double> length(loop.size() + 1, 0);
+        for (std::size_t i = 0; i < loop.size(); ++i) {
+            const auto &next = mesh.position(loop[(i + 1) % loop.size()]);
+            length[i + 1]    = length[i] + double(distance(mesh.position(loop[i]), next));
+        }
+        for (std::size_t i = 0; i < loop.size(); ++i) {
+            const double angle = 2 * std::numbers::pi * length[i] / length.back();
+            tex[loop[i]] = pmp::TexCoord(0.5 + 0.5 * std::cos(angle), 0.5 + 0.5 * std::sin(angle));
+        }
+        if (solve.n_free == 0) {
+            return;
+        }
+        if (!solve.factored) {
+            solve.factorize(assemble_laplacian(s, solve, 0, 1));
+            ++s.n_factorizations;
+        }
+
+        Eigen::MatrixXd B = Eigen::MatrixXd::Zero(solve.n_free, 2);
+        for (std::size_t e = 0; e < s.edges.size(); ++e) {
+            const auto [a, b] = s.edges[e];
+            const auto fa = solve.free_of[a], fb = solve.free_of[b];
+            if ((fa == PMP_MAX_INDEX) == (fb == PMP_MAX_INDEX)) {
+                continue;
+            }
+            const auto  f = fa != PMP_MAX_INDEX ? fa : fb;
+            const auto &t = tex[s.vertices[fa != PMP_MAX_INDEX ? b : a]];
+            B(f, 0) += s.weights[e] * t[0];
+            B(f, 1) += s.weights[e] * t[1];
+        }
+        const Eigen::MatrixXd X = solve.solve(B);
+        for (std::size_t i = 0; i < s.vertices.size(); ++i) {
+            if (solve.free_of[i] != PMP_MAX_INDEX) {
+                const auto f       = solve.free_of[i];
+                tex[s.vertices[i]] = pmp::TexCoord(X(f, 0), X(f, 1));
+            }
+        }
+    }
+
+    // Least squares conformal map (Lévy et al.) with cotangent weights: two
+    // far apart boundary vertices are pinned, the result is scaled into the
+    // unit square. Writes "v:tex".
+    void lscm_parameterization(pmp::SurfaceMesh &mesh) {
+        using namespace pmp_rosetta::detail;
+        auto                         &s = state("lscm_parameterization");
+        pmp_rosetta::ScopedGILRelease release;
+        std::lock_guard<std::mutex>   lock(s.mutex);
+        sync(mesh);
+
+        if (s.boundary_edges.empty()) {
+            throw pmp::InvalidInputException("Mesh has no boundary.");
+        }
+
+        // Pin a boundary vertex at (0, 0) and the boundary vertex farthest
+        // from it at (1, 0); unknowns are (u, v) interleaved
+        auto &solve = s.lscm;
+        const auto pin0 = s.boundary_edges.front()[0];
+        if (solve.free_of.empty()) {
+            const auto &p0   = mesh.position(s.vertices[pin0]);
+            auto        pin1 = pin0;
+            pmp::Scalar far  = 0;
+            for (std::size_t i = 0; i < s.vertices.size(); ++i) {
+                const auto d = distance(p0, mesh.position(s.vertices[i]));
+                if (s.boundary[i] && d > far) {
+                    far  = d;
+                    pin1 = pmp::IndexType(i);
+                }
+            }
+            if (pin1 == pin0) {
+                throw pmp::InvalidInputException("LaplacianSystem: degenerate boundary");
+            }
+            std::vector<char> fixed(2 * s.vertices.size(), 0);
+            fixed[2 * pin0] = fixed[2 * pin0 + 1] = 1;
+            fixed[2 * pin1] = fixed[2 * pin1 + 1] = 1;
+            solve.set_free(fixed);
+            s.lscm_pin = pin1;
+        }
+        const auto pin1 = s.lscm_pin;
+
+        // Hessian of the conformal energy: Dirichlet energy, one Laplacian
+        // per coordinate, minus the signed area enclosed by the boundary.
+        // Only the right hand side is needed once the matrix is factored.
+        std::vector<Eigen::Triplet<double>> triplets;
+        std::vector<double>                 fixed_value(2 * s.vertices.size(), 0);
+        fixed_value[2 * pin1] = 1;
+        Eigen::VectorXd B     = Eigen::VectorXd::Zero(solve.n_free);
+        const auto      add   = [&](std::size_t r, std::size_t c, double value) {
+            const auto fr = solve.free_of[r], fc = solve.free_of[c];
+            if (fr == PMP_MAX_INDEX) {
+                return;
+            }
+            if (fc == PMP_MAX_INDEX) {
+                B(fr) -= value * fixed_value[c];
+            } else if (!solve.factored) {
+                triplets.emplace_back(fr, fc, value);
+            }
+        };
+        for (std::size_t e = 0; e < s.edges.size(); ++e) {
+            const auto [a, b] = s.edges[e];
+            const double w    = s.cotan[e];
+            for (std::size_t k = 0; k < 2; ++k) {
+                add(2 * a + k, 2 * a + k, w);
+                add(2 * b + k, 2 * b + k, w);
+                add(2 * a + k, 2 * b + k, -w);
+                add(2 * b + k, 2 * a + k, -w);
+            }
+        }
+        for (const auto &[i, j] : s.boundary_edges) {
+            // area term (u_i v_j - u_j v_i) / 2
+            add(2 * i, 2 * j + 1, -0.5);
+            add(2 * j + 1, 2 * i, -0.5);
+            add(2 * j, 2 * i + 1, 0.5);
+            add(2 * i + 1, 2 * j, 0.5);
+        }
+        if (!solve.factored) {
+            SparseMatrix A(solve.n_free, solve.n_free);
+            A.setFromTriplets(triplets.begin(), triplets.end());
+            solve.factorize(A);
+            ++s.n_factorizations;
+        }
+        const Eigen::MatrixXd X = solve.solve(B);
+
+        auto tex = mesh.vertex_property<pmp::TexCoord>("v:tex");
+
+        std::vector<Eigen::Vector2d> uv(s.vertices.size());
+
+        Eigen::Vector2d lo = Eigen::Vector2d::Constant(std::numeric_limits<double>::max());
+        Eigen::Vector2d hi = -lo;
+        for (std::size_t i = 0; i < s.vertices.size(); ++i) {
+            for (std::size_t k = 0; k < 2; ++k) {
+                const auto f = solve.free_of[2 * i + k];
+                uv[i][k]     = f != PMP_MAX_INDEX ? X(f, 0) : fixed_value[2 * i + k];
+            }
+            lo = lo.cwiseMin(uv[i]);
+            hi = hi.cwiseMax(uv[i]);
+        }
+        const double extent = (hi - lo).maxCoeff();
+        const double scale  = extent > 0 ? 1 / extent : 1;
+        for (std::size_t i = 0; i < s.vertices.size(); ++i) {
+            const Eigen::Vector2d t = (uv[i] - lo) * scale;
+            tex[s.vertices[i]]      = pmp::TexCoord(t[0], t[1]);
+        }
+    }
+
+private:
+    pmp_rosetta::detail::LaplacianState &state(const char *what) const {
+        if (!state_) {
+            throw pmp::InvalidInputException(std::string("LaplacianSystem::") + what +
+                                             ": empty system");
+        }
+        return *state_;
+    }
+
+    void rebuild(const pmp::SurfaceMesh &mesh) {
+        if (!mesh.is_triangle_mesh()) {
+            throw pmp::InvalidInputException("Input is not a triangle mesh!");
+        }
+        pmp_rosetta::detail::assemble_connectivity(*state_, mesh);
+        pmp_rosetta::detail::assemble_geometry(*state_, mesh);
+    }
+
+    // Rebuild if the connectivity changed; returns whether it did
+    bool sync(const pmp::SurfaceMesh &mesh) {
+        if (matches(mesh)) {
+            return false;
+        }
+        rebuild(mesh);
+        return true;
+    }
+
+    std::shared_ptr<pmp_rosetta::detail::LaplacianState> state_;
+};
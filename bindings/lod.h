@@ -0,0 +1,190 @@
+// ============================================================================
+// Levels of detail from a single decimation run
+// ============================================================================
+// Building levels with copy_mesh() + decimate() per level recomputes the
+// quadrics and the collapse queue from the full mesh every time.
+// build_lod_chain() runs one QuadricDecimator (see decimation.h) down through
+// all targets, largest first: its quadrics and queue carry over from level to
+// level, and a compacted copy of the working mesh is taken whenever a target
+// is reached. The collapses are recorded, so vertex_map() can tell, for any
+// level, which vertex every input vertex was merged into (e.g. to carry
+// per-vertex data over to the levels).
+//
+// The simplification is that of parallel_decimate()'s serial path, with
+// "v:feature" vertices kept. The levels keep the properties of the input,
+// compacted as by parallel_garbage_collection() (see compact_into()).
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <pmp/exceptions.h>
+#include <pmp/io/io.h>
+#include <pmp/surface_mesh.h>
+
+#include "decimation.h"
+#include "garbage_collection.h"
+#include "mesh_copy.h"
+#include "parallel.h"
+#include "profiling.h"
+
+namespace pmp_rosetta::detail {
+
+    struct LodChainState {
+        std::size_t                   n_input_vertices = 0;
+        std::vector<pmp::SurfaceMesh> levels;      // in the order of the targets
+        std::vector<std::size_t>      n_collapses; // collapses done before each level
+        std::vector<Collapse>         collapses;   // in input (compacted) vertex numbering
+    };
+
+} // namespace pmp_rosetta::detail
+
+class LodChain {
+public:
+    LodChain() = default;
+
+    // Decimate a triangle mesh down to each of targets (vertex counts, in
+    // any order) in one run, over n_threads threads (0: all cores) for the
+    // copies. Level i is the mesh at targets[i] vertices, or with fewer
+    // vertices left when no legal collapse remained.
+    LodChain(const pmp::SurfaceMesh &mesh, const std::vector<unsigned int> &targets,
+             unsigned int n_threads)
+        : state_(std::make_shared<pmp_rosetta::detail::LodChainState>()) {
+        using namespace pmp_rosetta::detail;
+        pmp_rosetta::ProfileScope scope("lod.build");
+
+        if (!mesh.is_triangle_mesh()) {
+            throw pmp::InvalidInputException("Input is not a triangle mesh!");
+        }
+        auto            &s = *state_;
+        pmp::SurfaceMesh work;
+        if (mesh.has_garbage()) {
+            compact_into(work, mesh, n_threads);
+        } else {
+            work = mesh;
+        }
+        s.n_input_vertices = work.n_vertices();
+        s.levels.resize(targets.size());
+        s.n_collapses.resize(targets.size());
+
+        std::vector<std::size_t> order(targets.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(),
+                         [&](std::size_t a, std::size_t b) { return targets[a] > targets[b]; });
+
+        QuadricDecimator decimator(work);
+        const auto       features = work.get_vertex_property<bool>("v:feature");
+        if (features) {
+            for (auto v : work.vertices()) {
+                if (features[v]) {
+                    decimator.lock(v);
+                }
+            }
+        }
+        decimator.record_collapses(&s.collapses);
+
+        for (auto i : order) {
+            {
+                pmp_rosetta::ProfileScope phase("lod.decimate");
+                decimator.decimate(targets[i]);
+            }
+            pmp_rosetta::ProfileScope phase("lod.level");
+            s.n_collapses[i] = s.collapses.size();
+            if (work.has_garbage()) {
+                compact_into(s.levels[i], work, n_threads);
+            } else {
+                s.levels[i] = work;
+            }
+        }
+    }
+
+    std::size_t n_levels() const { return state_ ? state_->levels.size() : 0; }
+    std::size_t n_input_vertices() const { return state_ ? state_->n_input_vertices : 0; }
+    std::size_t n_vertices(std::size_t level) const { return mesh(level).n_vertices(); }
+    std::size_t n_faces(std::size_t level) const { return mesh(level).n_faces(); }
+
+    // Number of collapses from the input to a level
+    std::size_t n_collapses(std::size_t level) const {
+        mesh(level);
+        return state_->n_collapses[level];
+    }
+
+    // Copy a level into target, reusing its storage (see mesh_copy.h)
+    void level(std::size_t level, pmp::SurfaceMesh &target) const {
+        copy_mesh_into(target, mesh(level));
+    }
+
+    const pmp::SurfaceMesh &mesh(std::size_t level) const {
+        if (level >= n_levels()) {
+            throw pmp::InvalidInputException("LodChain: no level " + std::to_string(level));
+        }
+        return state_->levels[level];
+    }
+
+    // For every vertex of the input (numbered without its deleted vertices),
+    // the vertex of a level it was merged into
+    std::vector<pmp::IndexType> vertex_map(std::size_t level) const {
+        const auto  n_collapses = this->n_collapses(level);
+        const auto &collapses   = state_->collapses;
+        const auto  n           = state_->n_input_vertices;
+
+        std::vector<pmp::IndexType> parent(n);
+        std::iota(parent.begin(), parent.end(), pmp::IndexType(0));
+        for (std::size_t i = 0; i < n_collapses; ++i) {
+            parent[collapses[i].from] = collapses[i].to;
+        }
+
+        // Survivors keep their order in the level
+        std::vector<pmp::IndexType> rank(n, PMP_MAX_INDEX);
+        pmp::IndexType              n_kept = 0;
+        for (std::size_t v = 0; v < n; ++v) {
+            if (parent[v] == v) {
+                rank[v] = n_kept++;
+            }
+        }
+
+        std::vector<pmp::IndexType> map(n);
+        for (std::size_t v = 0; v < n; ++v) {
+            auto root = pmp::IndexType(v);
+            while (parent[root] != root) {
+                root = parent[root];
+            }
+            // Shorten the chain for the vertices merged later
+            for (auto u = pmp::IndexType(v); parent[u] != root;) {
+                const auto next = parent[u];
+                parent[u]       = root;
+                u               = next;
+            }
+            map[v] = rank[root];
+        }
+        return map;
+    }
+
+private:
+    std::shared_ptr<pmp_rosetta::detail::LodChainState> state_;
+};
+
+// LodChain(mesh, targets, n_threads), without holding the GIL
+inline LodChain build_lod_chain(const pmp::SurfaceMesh          &mesh,
+                                const std::vector<unsigned int> &targets, unsigned int n_threads) {
+    return LodChain(mesh, targets, n_threads);
+}
+
+// Write level i of chain to paths[i] with pmp::write(), the levels in
+// parallel over n_threads threads (0: all cores)
+inline void write_lod_chain(const LodChain &chain, const std::vector<std::string> &paths,
+                            const pmp::IOFlags &flags, unsigned int n_threads) {
+    if (paths.size() != chain.n_levels()) {
+        throw pmp::InvalidInputException("write_lod_chain: got " + std::to_string(paths.size()) +
+                                         " paths for " + std::to_string(chain.n_levels()) +
+                                         " levels");
+    }
+    pmp_rosetta::ProfileScope scope("lod.write");
+    pmp_rosetta::parallel_for(
+        0, paths.size(), [&](std::size_t i) { pmp::write(chain.mesh(i), paths[i], flags); },
+        n_threads, 1);
+}
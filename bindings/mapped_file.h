@@ -0,0 +1,89 @@
+// ============================================================================
+// Memory-mapped files
+// ============================================================================
+// POSIX mmap with private pages: the mapping can be written to without ever
+// modifying the file (copy-on-write). Clean pages are backed by the file, so
+// they do not count against process memory the way a read buffer does.
+// On Windows the file is read into memory instead.
+// ============================================================================
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <pmp/exceptions.h>
+
+namespace pmp_rosetta {
+
+    // Read-only file mapping with private (copy-on-write) pages
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string &path) {
+#ifdef _WIN32
+            // No mmap: read the file into an 8-byte aligned buffer instead
+            std::ifstream in(path, std::ios::binary);
+            if (!in) {
+                throw pmp::IOException("Failed to open file: " + path);
+            }
+            in.seekg(0, std::ios::end);
+            size_ = std::size_t(in.tellg());
+            in.seekg(0, std::ios::beg);
+            buffer_.resize((size_ + 7) / 8);
+            in.read(reinterpret_cast<char *>(buffer_.data()), std::streamsize(size_));
+            data_ = reinterpret_cast<char *>(buffer_.data());
+#else
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw pmp::IOException("Failed to open file: " + path);
+            }
+            struct stat st;
+            if (::fstat(fd, &st) != 0) {
+                ::close(fd);
+                throw pmp::IOException("Failed to stat file: " + path);
+            }
+            size_ = std::size_t(st.st_size);
+            if (size_ > 0) {
+                void *data = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+                if (data == MAP_FAILED) {
+                    ::close(fd);
+                    throw pmp::IOException("Failed to map file: " + path);
+                }
+                data_ = static_cast<char *>(data);
+            }
+            ::close(fd);
+#endif
+        }
+
+        ~MappedFile() {
+#ifndef _WIN32
+            if (data_) {
+                ::munmap(data_, size_);
+            }
+#endif
+        }
+
+        MappedFile(const MappedFile &)            = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        char       *data() const { return data_; }
+        std::size_t size() const { return size_; }
+
+    private:
+        char       *data_ = nullptr;
+        std::size_t size_ = 0;
+#ifdef _WIN32
+        std::vector<std::uint64_t> buffer_;
+#endif
+    };
+
+} // namespace pmp_rosetta
@@ -0,0 +1,45 @@
+// ============================================================================
+// Element allocation for meshes rebuilt from arrays
+// ============================================================================
+// SurfaceMesh only adds edges and faces through add_face(), which checks and
+// links them one at a time. Snapshots, copy_mesh_into(), compaction and
+// parallel subdivision know the whole connectivity up front: they allocate
+// the element slots with the protected new_vertex() / new_edge() /
+// new_face() of SurfaceMesh, then fill in the links through its public
+// setters and the property values through property vectors.
+//
+// Only this protected API is used, no private member: the property arrays,
+// the deleted counts and the garbage state stay owned by SurfaceMesh.
+// ============================================================================
+#pragma once
+
+#include <pmp/surface_mesh.h>
+
+namespace pmp_rosetta::detail {
+
+    // Element allocation is protected in SurfaceMesh. Pointers to these
+    // members, formed through a derived class, give access to them when
+    // rebuilding connectivity from stored arrays.
+    struct SurfaceMeshAllocator : pmp::SurfaceMesh {
+        static pmp::Vertex allocate_vertex(pmp::SurfaceMesh &mesh) {
+            constexpr auto f =
+                static_cast<pmp::Vertex (pmp::SurfaceMesh::*)()>(&SurfaceMeshAllocator::new_vertex);
+            return (mesh.*f)();
+        }
+
+        static pmp::Halfedge allocate_edge(pmp::SurfaceMesh &mesh, pmp::Vertex start,
+                                           pmp::Vertex end) {
+            constexpr auto f =
+                static_cast<pmp::Halfedge (pmp::SurfaceMesh::*)(pmp::Vertex, pmp::Vertex)>(
+                    &SurfaceMeshAllocator::new_edge);
+            return (mesh.*f)(start, end);
+        }
+
+        static pmp::Face allocate_face(pmp::SurfaceMesh &mesh) {
+            constexpr auto f =
+                static_cast<pmp::Face (pmp::SurfaceMesh::*)()>(&SurfaceMeshAllocator::new_face);
+            return (mesh.*f)();
+        }
+    };
+
+} // namespace pmp_rosetta::detail
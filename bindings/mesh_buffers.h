@@ -0,0 +1,418 @@
+// ============================================================================
+// Contiguous buffer import/export for pmp::SurfaceMesh
+// ============================================================================
+// Bulk conversions between a SurfaceMesh and flat arrays owned by the caller.
+// Buffers are passed as raw addresses (e.g. numpy's `array.ctypes.data`) so
+// that no per-element conversion happens in the binding layer; see
+// pmp_numpy.py for the Python side.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "triangles.h"
+
+// Size in bytes of pmp::Scalar, so that raw buffers can be viewed with the right dtype
+inline std::size_t scalar_size() {
+    return sizeof(pmp::Scalar);
+}
+
+// Size in bytes of pmp::IndexType, the element type of exported index buffers
+inline std::size_t index_size() {
+    return sizeof(pmp::IndexType);
+}
+
+namespace pmp_rosetta::detail {
+
+    // Cast an address received from the bindings back to a typed pointer
+    template <typename T>
+    inline T *buffer_cast(std::uintptr_t address, std::size_t count, const char *what) {
+        if (address == 0 && count > 0) {
+            throw pmp::InvalidInputException(std::string(what) + ": null buffer");
+        }
+        return reinterpret_cast<T *>(address);
+    }
+
+    // Location of one face inside a flat index buffer
+    struct FaceRange {
+        std::size_t begin;
+        std::size_t size;
+    };
+
+    // Decode either a fixed-arity buffer (arity >= 3) or a VTK-style buffer
+    // [n, v0, ..., vn-1, n, ...] (arity == 0) into per-face ranges.
+    inline std::vector<FaceRange> decode_faces(const std::int64_t *faces, std::size_t n_values,
+                                               unsigned int arity) {
+        std::vector<FaceRange> ranges;
+        if (arity == 0) {
+            for (std::size_t i = 0; i < n_values;) {
+                const std::int64_t n = faces[i];
+                if (n < 3 || std::uint64_t(n) > n_values - i - 1) {
+                    throw pmp::InvalidInputException("build_mesh: malformed face at offset " +
+                                                     std::to_string(i));
+                }
+                ranges.push_back({i + 1, std::size_t(n)});
+                i += std::size_t(n) + 1;
+            }
+        } else {
+            if (arity < 3 || n_values % arity != 0) {
+                throw pmp::InvalidInputException("build_mesh: index count is not a multiple of " +
+                                                 std::to_string(arity));
+            }
+            ranges.reserve(n_values / arity);
+            for (std::size_t i = 0; i < n_values; i += arity) {
+                ranges.push_back({i, arity});
+            }
+        }
+        return ranges;
+    }
+
+    // Total number of face corners
+    inline std::size_t count_corners(const std::vector<FaceRange> &ranges) {
+        std::size_t n = 0;
+        for (const auto &r : ranges) {
+            n += r.size;
+        }
+        return n;
+    }
+
+    // Flag faces that SurfaceMesh::add_face() would reject when adding them
+    // in order: repeated vertices, or a directed edge already used by an
+    // earlier accepted face (complex edge or inconsistent orientation).
+    // Equal halfedge keys are grouped by sorting them once, then one pass in
+    // face order lets each accepted face claim its groups, instead of relying
+    // on add_face() throwing mid-construction.
+    template <typename Index>
+    inline std::vector<bool> reject_faces(const Index *faces, const std::vector<FaceRange> &ranges,
+                                          std::size_t n_points) {
+        std::vector<bool> rejected(ranges.size(), false);
+
+        // (from << 32 | to, corner), corners numbered in face order
+        std::vector<std::pair<std::uint64_t, std::size_t>> keys;
+        keys.reserve(count_corners(ranges));
+
+        for (std::size_t f = 0; f < ranges.size(); ++f) {
+            const auto *idx = faces + ranges[f].begin;
+            const auto  n   = ranges[f].size;
+            for (std::size_t i = 0; i < n; ++i) {
+                if (std::int64_t(idx[i]) < 0 || std::uint64_t(idx[i]) >= n_points) {
+                    throw pmp::InvalidInputException("build_mesh: vertex index " +
+                                                     std::to_string(idx[i]) + " out of range");
+                }
+                for (std::size_t j = 0; j < i; ++j) {
+                    if (idx[i] == idx[j]) {
+                        rejected[f] = true;
+                    }
+                }
+                const auto from = std::uint64_t(idx[i]);
+                const auto to   = std::uint64_t(idx[(i + 1) % n]);
+                keys.emplace_back(from << 32 | to, keys.size());
+            }
+        }
+
+        std::sort(keys.begin(), keys.end());
+
+        // Group of every corner's directed edge
+        std::vector<std::size_t> group(keys.size());
+        std::size_t              n_groups = 0;
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            if (i == 0 || keys[i].first != keys[i - 1].first) {
+                ++n_groups;
+            }
+            group[keys[i].second] = n_groups - 1;
+        }
+
+        // A face with repeated vertices is never added, so claims nothing
+        std::vector<char> claimed(n_groups, 0);
+        for (std::size_t f = 0, corner = 0; f < ranges.size(); corner += ranges[f++].size) {
+            const auto n = ranges[f].size;
+            for (std::size_t i = 0; i < n && !rejected[f]; ++i) {
+                rejected[f] = claimed[group[corner + i]] != 0;
+            }
+            if (!rejected[f]) {
+                for (std::size_t i = 0; i < n; ++i) {
+                    claimed[group[corner + i]] = 1;
+                }
+            }
+        }
+        return rejected;
+    }
+
+    // SurfaceMesh::add_face() that leaves the mesh as it was when it throws.
+    // Its topology checks run before any change, but the re-linking of
+    // patches around the face's vertices can still fail after relinking some
+    // of them: the next halfedge of every halfedge entering those vertices is
+    // saved beforehand and restored then. saved is scratch space.
+    inline bool try_add_face(pmp::SurfaceMesh &mesh, const std::vector<pmp::Vertex> &vertices,
+                             std::vector<std::pair<pmp::Halfedge, pmp::Halfedge>> &saved) {
+        saved.clear();
+        for (auto v : vertices) {
+            if (mesh.is_valid(v) && !mesh.is_isolated(v)) {
+                for (auto h : mesh.halfedges(v)) {
+                    const auto in = mesh.opposite_halfedge(h);
+                    saved.emplace_back(in, mesh.next_halfedge(in));
+                }
+            }
+        }
+        try {
+            mesh.add_face(vertices);
+            return true;
+        } catch (const pmp::TopologyException &) {
+            for (const auto &[h, next] : saved) {
+                mesh.set_next_halfedge(h, next);
+            }
+            return false;
+        }
+    }
+
+    // Add the faces of a flat index buffer that were not rejected by
+    // reject_faces(). Returns the number of faces skipped because they would
+    // make the mesh non-manifold.
+    template <typename Index>
+    inline std::size_t add_faces(pmp::SurfaceMesh &mesh, const Index *faces,
+                                 const std::vector<FaceRange> &ranges,
+                                 const std::vector<bool>      &rejected) {
+        std::size_t                                          n_skipped = 0;
+        std::vector<pmp::Vertex>                             face_vertices;
+        std::vector<std::pair<pmp::Halfedge, pmp::Halfedge>> saved;
+        for (std::size_t f = 0; f < ranges.size(); ++f) {
+            if (rejected[f]) {
+                ++n_skipped;
+                continue;
+            }
+            face_vertices.clear();
+            for (std::size_t i = 0; i < ranges[f].size; ++i) {
+                face_vertices.emplace_back(pmp::IndexType(faces[ranges[f].begin + i]));
+            }
+            if (!try_add_face(mesh, face_vertices, saved)) {
+                // Complex vertex: the face cannot be glued to its neighbors
+                ++n_skipped;
+            }
+        }
+        return n_skipped;
+    }
+
+    // Map from vertex slot to its index once deleted vertices are dropped.
+    // Empty when the mesh holds no garbage, i.e. when the map is the identity.
+    inline std::vector<pmp::IndexType> compact_vertex_map(const pmp::SurfaceMesh &mesh) {
+        std::vector<pmp::IndexType> map;
+        if (!mesh.has_garbage()) {
+            return map;
+        }
+        map.assign(mesh.vertices_size(), PMP_MAX_INDEX);
+        pmp::IndexType next = 0;
+        for (auto v : mesh.vertices()) {
+            map[v.idx()] = next++;
+        }
+        return map;
+    }
+
+    inline void check_capacity(std::size_t needed, std::size_t capacity, const char *what) {
+        if (capacity < needed) {
+            throw pmp::InvalidInputException(std::string(what) + ": output buffer holds " +
+                                             std::to_string(capacity) + " values, " +
+                                             std::to_string(needed) + " needed");
+        }
+    }
+
+    template <typename... Ts> struct TypeList {};
+
+    // Property value types that snapshots store and the property helpers of
+    // the bindings handle
+    using SnapshotTypes =
+        TypeList<float, double, int, unsigned int, bool, pmp::Vector<float, 2>,
+                 pmp::Vector<float, 3>, pmp::Vector<double, 2>, pmp::Vector<double, 3>>;
+
+    // Call f(std::type_identity<T>{}) for each T until it returns true
+    template <typename F, typename... Ts> inline bool find_type(TypeList<Ts...>, F &&f) {
+        return (f(std::type_identity<Ts>{}) || ...);
+    }
+
+    // Properties maintained by SurfaceMesh itself, stored as dedicated arrays
+    inline bool is_builtin_property(const std::string &name) {
+        return name == "v:connectivity" || name == "h:connectivity" ||
+               name == "f:connectivity" || name == "v:point" || name == "v:deleted" ||
+               name == "e:deleted" || name == "f:deleted";
+    }
+
+    // Storage of the property `name` of type T attached to the elements of
+    // `kind` ('v'ertices, 'h'alfedges, 'e'dges or 'f'aces), or nullptr if the
+    // mesh has no such property with that exact type.
+    template <typename T>
+    inline std::vector<T> *property_vector(const pmp::SurfaceMesh &mesh, char kind,
+                                           const std::string &name) {
+        switch (kind) {
+            case 'v':
+                if (auto p = mesh.get_vertex_property<T>(name)) {
+                    return &p.vector();
+                }
+                break;
+            case 'h':
+                if (auto p = mesh.get_halfedge_property<T>(name)) {
+                    return &p.vector();
+                }
+                break;
+            case 'e':
+                if (auto p = mesh.get_edge_property<T>(name)) {
+                    return &p.vector();
+                }
+                break;
+            case 'f':
+                if (auto p = mesh.get_face_property<T>(name)) {
+                    return &p.vector();
+                }
+                break;
+        }
+        return nullptr;
+    }
+
+    // Same as property_vector(), adding the property if it does not exist yet
+    template <typename T>
+    inline std::vector<T> &make_property_vector(pmp::SurfaceMesh &mesh, char kind,
+                                                const std::string &name) {
+        switch (kind) {
+            case 'v':
+                return mesh.vertex_property<T>(name).vector();
+            case 'h':
+                return mesh.halfedge_property<T>(name).vector();
+            case 'e':
+                return mesh.edge_property<T>(name).vector();
+            case 'f':
+                return mesh.face_property<T>(name).vector();
+        }
+        throw pmp::InvalidInputException(std::string("unknown property kind '") + kind + "'");
+    }
+
+    // Names of the properties attached to the elements of `kind`
+    inline std::vector<std::string> property_names(const pmp::SurfaceMesh &mesh, char kind) {
+        switch (kind) {
+            case 'v':
+                return mesh.vertex_properties();
+            case 'h':
+                return mesh.halfedge_properties();
+            case 'e':
+                return mesh.edge_properties();
+            case 'f':
+                return mesh.face_properties();
+        }
+        return {};
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Build a mesh in one native pass from a flat point buffer (n_points * 3
+// pmp::Scalar) and an int64 face buffer holding either fixed-arity faces
+// (arity >= 3) or VTK-style [n, v0, ..., vn-1, ...] faces (arity == 0).
+// The mesh is cleared first. Returns the number of faces that were skipped
+// because they would make the mesh non-manifold.
+inline std::size_t build_mesh(pmp::SurfaceMesh &mesh, std::uintptr_t points, std::size_t n_points,
+                              std::uintptr_t faces, std::size_t n_face_values,
+                              unsigned int arity) {
+    using namespace pmp_rosetta::detail;
+
+    const auto *p   = buffer_cast<const pmp::Scalar>(points, n_points, "build_mesh");
+    const auto *idx = buffer_cast<const std::int64_t>(faces, n_face_values, "build_mesh");
+
+    const auto ranges   = decode_faces(idx, n_face_values, arity);
+    const auto rejected = reject_faces(idx, ranges, n_points);
+
+    mesh.clear();
+    mesh.reserve(n_points, count_corners(ranges) / 2, ranges.size());
+
+    for (std::size_t i = 0; i < n_points; ++i) {
+        mesh.add_vertex(pmp::Point(p[3 * i], p[3 * i + 1], p[3 * i + 2]));
+    }
+
+    return add_faces(mesh, idx, ranges, rejected);
+}
+
+// Number of face corners, i.e. the size of the connectivity buffer filled by export_faces()
+inline std::size_t n_face_indices(const pmp::SurfaceMesh &mesh) {
+    std::size_t n = 0;
+    for (auto f : mesh.faces()) {
+        n += mesh.valence(f);
+    }
+    return n;
+}
+
+// Copy the positions of the non-deleted vertices into a caller-provided
+// buffer of n_vertices() * 3 pmp::Scalar. Row i is the vertex numbered i by
+// export_faces(..., compact = true). Returns the number of vertices written.
+inline std::size_t export_points(const pmp::SurfaceMesh &mesh, std::uintptr_t out,
+                                 std::size_t capacity) {
+    using namespace pmp_rosetta::detail;
+
+    check_capacity(mesh.n_vertices() * 3, capacity, "export_points");
+    auto *dst = buffer_cast<pmp::Scalar>(out, capacity, "export_points");
+
+    for (auto v : mesh.vertices()) {
+        const auto &p = mesh.position(v);
+        *dst++        = p[0];
+        *dst++        = p[1];
+        *dst++        = p[2];
+    }
+    return mesh.n_vertices();
+}
+
+// Write the face connectivity of the non-deleted faces into caller-provided
+// pmp::IndexType buffers, without garbage collecting the mesh.
+//   indices: n_face_indices() vertex indices, face after face
+//   offsets: n_faces() + 1 CSR offsets into indices (may be 0 to skip, e.g.
+//            for a pure triangle mesh)
+// With compact = true, vertex indices refer to rows of export_points();
+// otherwise they are raw vertex slots, matching the zero-copy points view.
+// Returns the number of faces written.
+inline std::size_t export_faces(const pmp::SurfaceMesh &mesh, std::uintptr_t indices,
+                                std::size_t n_indices, std::uintptr_t offsets,
+                                std::size_t n_offsets, bool compact) {
+    using namespace pmp_rosetta::detail;
+
+    const auto n_corners = n_face_indices(mesh);
+    check_capacity(n_corners, n_indices, "export_faces");
+    if (offsets != 0) {
+        check_capacity(mesh.n_faces() + 1, n_offsets, "export_faces");
+    }
+
+    auto *idx = buffer_cast<pmp::IndexType>(indices, n_indices, "export_faces");
+    auto *off =
+        offsets != 0 ? buffer_cast<pmp::IndexType>(offsets, n_offsets, "export_faces") : nullptr;
+
+    const auto map = compact ? compact_vertex_map(mesh) : std::vector<pmp::IndexType>();
+
+    pmp::IndexType n = 0;
+    if (n_corners == 3 * mesh.n_faces()) {
+        // Every face has at least three corners: all are triangles
+        for (auto f : mesh.faces()) {
+            if (off) {
+                *off++ = n;
+            }
+            for (auto v : triangle_vertices(mesh, f)) {
+                idx[n++] = map.empty() ? v.idx() : map[v.idx()];
+            }
+        }
+        if (off) {
+            *off = n;
+        }
+        return mesh.n_faces();
+    }
+    for (auto f : mesh.faces()) {
+        if (off) {
+            *off++ = n;
+        }
+        for (auto v : mesh.vertices(f)) {
+            idx[n++] = map.empty() ? v.idx() : map[v.idx()];
+        }
+    }
+    if (off) {
+        *off = n;
+    }
+    return mesh.n_faces();
+}
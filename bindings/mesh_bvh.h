@@ -0,0 +1,147 @@
+// ============================================================================
+// Batched spatial queries on a SurfaceMesh
+// ============================================================================
+// MeshBVH wraps a TriangleBVH built once from a triangle mesh and answers
+// whole batches of queries in one call, spread over a thread pool. Inputs and
+// outputs are caller-owned contiguous buffers passed by address, like the
+// buffer functions of mesh_buffers.h (see pmp_numpy.py for NumPy wrappers):
+//   points, origins, directions: n * 3 pmp::Scalar
+//   faces:                       n pmp::IndexType, raw face indices of the
+//                                mesh the tree was built from
+// Output buffers passed as 0 are not written. The batched queries release
+// the Python GIL while they run.
+// ============================================================================
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "bvh.h"
+#include "gil.h"
+#include "mesh_buffers.h"
+#include "parallel.h"
+
+class MeshBVH {
+public:
+    MeshBVH() = default;
+
+    // The tree keeps a copy of the triangles: later changes to the mesh are not seen
+    explicit MeshBVH(const pmp::SurfaceMesh &mesh)
+        : bvh_(std::make_shared<const pmp_rosetta::TriangleBVH>(mesh)) {}
+
+    bool        empty() const { return !bvh_ || bvh_->empty(); }
+    std::size_t n_triangles() const { return bvh_ ? bvh_->n_triangles() : 0; }
+
+    // Closest surface point, its distance and its face, for each of n points.
+    // Returns n.
+    std::size_t closest_points(std::uintptr_t points, std::size_t n, std::uintptr_t out_points,
+                               std::uintptr_t out_distances, std::uintptr_t out_faces,
+                               unsigned int n_threads) const {
+        using namespace pmp_rosetta::detail;
+
+        const auto &bvh       = tree("closest_points");
+        const auto *p         = buffer_cast<const pmp::Scalar>(points, 3 * n, "closest_points");
+        auto       *nearest   = optional_buffer<pmp::Scalar>(out_points, 3 * n);
+        auto       *distances = optional_buffer<pmp::Scalar>(out_distances, n);
+        auto       *faces     = optional_buffer<pmp::IndexType>(out_faces, n);
+
+        pmp_rosetta::ScopedGILRelease release;
+
+        pmp_rosetta::parallel_for(
+            0, n,
+            [&](std::size_t i) {
+                const auto nn = bvh.nearest(pmp::Point(p[3 * i], p[3 * i + 1], p[3 * i + 2]));
+                if (nearest) {
+                    for (int k = 0; k < 3; ++k) {
+                        nearest[3 * i + k] = nn.point[k];
+                    }
+                }
+                if (distances) {
+                    distances[i] = nn.distance;
+                }
+                if (faces) {
+                    faces[i] = nn.face.idx();
+                }
+            },
+            n_threads, 256);
+        return n;
+    }
+
+    // First hit of each of n rays origin + t * direction, t >= 0. Misses get
+    // t = infinity and face PMP_MAX_INDEX. Returns the number of hits.
+    std::size_t ray_intersect(std::uintptr_t origins, std::uintptr_t directions, std::size_t n,
+                              std::uintptr_t out_t, std::uintptr_t out_faces,
+                              unsigned int n_threads) const {
+        using namespace pmp_rosetta::detail;
+
+        const auto &bvh   = tree("ray_intersect");
+        const auto *o     = buffer_cast<const pmp::Scalar>(origins, 3 * n, "ray_intersect");
+        const auto *d     = buffer_cast<const pmp::Scalar>(directions, 3 * n, "ray_intersect");
+        auto       *t     = optional_buffer<pmp::Scalar>(out_t, n);
+        auto       *faces = optional_buffer<pmp::IndexType>(out_faces, n);
+
+        pmp_rosetta::ScopedGILRelease release;
+
+        std::atomic<std::size_t> n_hits{0};
+        pmp_rosetta::parallel_for(
+            0, n,
+            [&](std::size_t i) {
+                const auto hit =
+                    bvh.intersect(pmp::Point(o[3 * i], o[3 * i + 1], o[3 * i + 2]),
+                                  pmp::Point(d[3 * i], d[3 * i + 1], d[3 * i + 2]));
+                if (hit.face.is_valid()) {
+                    n_hits.fetch_add(1, std::memory_order_relaxed);
+                }
+                if (t) {
+                    t[i] = hit.t;
+                }
+                if (faces) {
+                    faces[i] = hit.face.idx();
+                }
+            },
+            n_threads, 256);
+        return n_hits;
+    }
+
+    // Generalized winding number at each of n points: ~1 inside and ~0
+    // outside a closed, outward oriented surface; threshold at 0.5 for an
+    // inside test that tolerates holes. beta trades accuracy for speed (2 is
+    // a good default, larger is more accurate). Returns n.
+    std::size_t winding_numbers(std::uintptr_t points, std::size_t n, std::uintptr_t out,
+                                pmp::Scalar beta, unsigned int n_threads) const {
+        using namespace pmp_rosetta::detail;
+
+        const auto &bvh = tree("winding_numbers");
+        const auto *p   = buffer_cast<const pmp::Scalar>(points, 3 * n, "winding_numbers");
+        auto       *w   = buffer_cast<pmp::Scalar>(out, n, "winding_numbers");
+
+        pmp_rosetta::ScopedGILRelease release;
+
+        pmp_rosetta::parallel_for(
+            0, n,
+            [&](std::size_t i) {
+                w[i] = bvh.winding_number(pmp::Point(p[3 * i], p[3 * i + 1], p[3 * i + 2]), beta);
+            },
+            n_threads, 64);
+        return n;
+    }
+
+private:
+    const pmp_rosetta::TriangleBVH &tree(const char *what) const {
+        if (empty()) {
+            throw pmp::InvalidInputException(std::string("MeshBVH::") + what + ": empty tree");
+        }
+        return *bvh_;
+    }
+
+    template <typename T> static T *optional_buffer(std::uintptr_t address, std::size_t count) {
+        return address ? pmp_rosetta::detail::buffer_cast<T>(address, count, "MeshBVH") : nullptr;
+    }
+
+    std::shared_ptr<const pmp_rosetta::TriangleBVH> bvh_;
+};
@@ -0,0 +1,188 @@
+// ============================================================================
+// Copying a mesh into an existing one
+// ============================================================================
+// `dst = src` (and copy_mesh()) frees every property array of dst and clones
+// the arrays of src, so a loop that restores a working mesh from a source
+// before each run allocates the whole mesh every time. copy_mesh_into()
+// instead grows dst to the element counts of src and assigns the property
+// arrays one by one: std::vector assignment keeps the existing storage when
+// it is large enough, so once dst was reserve()d for src the copy does not
+// touch the heap.
+//
+// Through the API of SurfaceMesh, elements can be added but not cut off
+// without garbage_collection(), which releases storage, and its deleted
+// counts cannot be set. The copy therefore falls back to `dst = src` when
+// dst has more element slots than src, when either mesh holds deleted
+// elements, and when a property has a type not stored in snapshots.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <pmp/surface_mesh.h>
+
+#include "mesh_allocator.h"
+#include "mesh_buffers.h"
+#include "parallel.h"
+
+namespace pmp_rosetta::detail {
+
+    inline bool is_connectivity_property(const std::string &name) {
+        return name == "v:connectivity" || name == "h:connectivity" || name == "f:connectivity";
+    }
+
+    inline bool has_supported_type(const pmp::SurfaceMesh &mesh, char kind,
+                                   const std::string &name) {
+        return find_type(SnapshotTypes{}, [&](auto tag) {
+            using T = typename decltype(tag)::type;
+            return property_vector<T>(mesh, kind, name) != nullptr;
+        });
+    }
+
+    // Whether every property of both meshes can be copied through
+    // property_vector(), and a property of dst sharing a name with one of src
+    // also has its type (otherwise the value arrays could not be assigned)
+    inline bool copyable_properties(const pmp::SurfaceMesh &dst, const pmp::SurfaceMesh &src) {
+        for (char kind : {'v', 'h', 'e', 'f'}) {
+            for (const auto *mesh : {&dst, &src}) {
+                for (const auto &name : property_names(*mesh, kind)) {
+                    if (!is_connectivity_property(name) && !has_supported_type(*mesh, kind, name)) {
+                        return false;
+                    }
+                }
+            }
+            for (const auto &name : property_names(dst, kind)) {
+                if (is_connectivity_property(name)) {
+                    continue;
+                }
+                const bool same_type = find_type(SnapshotTypes{}, [&](auto tag) {
+                    using T = typename decltype(tag)::type;
+                    return property_vector<T>(dst, kind, name) &&
+                           property_vector<T>(src, kind, name);
+                });
+                const auto names = property_names(src, kind);
+                if (!same_type && std::find(names.begin(), names.end(), name) != names.end()) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Remove the custom properties of dst that src does not have
+    inline void remove_missing_properties(pmp::SurfaceMesh &dst, const pmp::SurfaceMesh &src) {
+        for (char kind : {'v', 'h', 'e', 'f'}) {
+            for (const auto &name : property_names(dst, kind)) {
+                if (is_builtin_property(name) || has_supported_type(src, kind, name)) {
+                    continue;
+                }
+                find_type(SnapshotTypes{}, [&](auto tag) {
+                    using T = typename decltype(tag)::type;
+                    switch (kind) {
+                        case 'v':
+                            if (auto p = dst.get_vertex_property<T>(name)) {
+                                dst.remove_vertex_property(p);
+                                return true;
+                            }
+                            break;
+                        case 'h':
+                            if (auto p = dst.get_halfedge_property<T>(name)) {
+                                dst.remove_halfedge_property(p);
+                                return true;
+                            }
+                            break;
+                        case 'e':
+                            if (auto p = dst.get_edge_property<T>(name)) {
+                                dst.remove_edge_property(p);
+                                return true;
+                            }
+                            break;
+                        case 'f':
+                            if (auto p = dst.get_face_property<T>(name)) {
+                                dst.remove_face_property(p);
+                                return true;
+                            }
+                            break;
+                    }
+                    return false;
+                });
+            }
+        }
+    }
+
+    // Assign the value arrays of every property of src (built-in ones apart
+    // from connectivity included) to the same property of dst
+    inline void copy_property_values(pmp::SurfaceMesh &dst, const pmp::SurfaceMesh &src) {
+        for (char kind : {'v', 'h', 'e', 'f'}) {
+            for (const auto &name : property_names(src, kind)) {
+                if (is_connectivity_property(name)) {
+                    continue;
+                }
+                find_type(SnapshotTypes{}, [&](auto tag) {
+                    using T          = typename decltype(tag)::type;
+                    const auto *from = property_vector<T>(src, kind, name);
+                    if (!from) {
+                        return false;
+                    }
+                    make_property_vector<T>(dst, kind, name) = *from;
+                    return true;
+                });
+            }
+        }
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Make dst a copy of src (connectivity and all properties), reusing the
+// storage of dst. Returns true if the copy was made in place, false if it
+// fell back to `dst = src` (see above). Views of dst stay valid when the
+// copy is made in place and dst had at least the capacity src needs.
+inline bool copy_mesh_into(pmp::SurfaceMesh &dst, const pmp::SurfaceMesh &src) {
+    using namespace pmp_rosetta::detail;
+
+    if (&dst == &src) {
+        return true;
+    }
+    if (src.has_garbage() || dst.has_garbage() || dst.vertices_size() > src.vertices_size() ||
+        dst.edges_size() > src.edges_size() || dst.faces_size() > src.faces_size() ||
+        !copyable_properties(dst, src)) {
+        dst = src;
+        return false;
+    }
+
+    remove_missing_properties(dst, src);
+    dst.reserve(src.vertices_size(), src.edges_size(), src.faces_size());
+    while (dst.vertices_size() < src.vertices_size()) {
+        SurfaceMeshAllocator::allocate_vertex(dst);
+    }
+    while (dst.edges_size() < src.edges_size()) {
+        SurfaceMeshAllocator::allocate_edge(dst, pmp::Vertex(0), pmp::Vertex(1));
+    }
+    while (dst.faces_size() < src.faces_size()) {
+        SurfaceMeshAllocator::allocate_face(dst);
+    }
+
+    // src has no deleted elements: every halfedge is the next of exactly one
+    // other, so the previous links set along with the next ones are written
+    // once each
+    pmp_rosetta::parallel_for(0, src.halfedges_size(), [&](std::size_t i) {
+        const auto h = pmp::Halfedge(pmp::IndexType(i));
+        dst.set_vertex(h, src.to_vertex(h));
+        dst.set_next_halfedge(h, src.next_halfedge(h));
+        dst.set_face(h, src.face(h));
+    });
+    pmp_rosetta::parallel_for(0, src.vertices_size(), [&](std::size_t i) {
+        const auto v = pmp::Vertex(pmp::IndexType(i));
+        dst.set_halfedge(v, src.halfedge(v));
+    });
+    pmp_rosetta::parallel_for(0, src.faces_size(), [&](std::size_t i) {
+        const auto f = pmp::Face(pmp::IndexType(i));
+        dst.set_halfedge(f, src.halfedge(f));
+    });
+
+    // Positions and deleted flags are among the property values
+    copy_property_values(dst, src);
+    return true;
+}
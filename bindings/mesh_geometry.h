@@ -0,0 +1,196 @@
+// ============================================================================
+// Per-element differential geometry as arrays
+// ============================================================================
+// pmp::curvature(), pmp::vertex_normals() and pmp::face_normals() store their
+// results in mesh properties, one element at a time. The functions below
+// compute the same quantities over a thread pool and write them into
+// caller-owned contiguous buffers (see pmp_numpy.py for NumPy wrappers).
+// Every element only gathers from its own neighborhood, so the loops need no
+// synchronization. Vertex rows follow export_points(), face rows
+// export_faces(). Output buffers passed as 0 are not written. The bindings
+// release the Python GIL while these functions run.
+// ============================================================================
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <pmp/algorithms/differential_geometry.h>
+#include <pmp/algorithms/normals.h>
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "mesh_buffers.h"
+#include "parallel.h"
+#include "triangles.h"
+
+namespace pmp_rosetta::detail {
+
+    // Output buffer of at least count elements, or nullptr when not requested
+    template <typename T>
+    inline T *optional_output(std::uintptr_t address, std::size_t count, std::size_t capacity,
+                              const char *what) {
+        if (address == 0) {
+            return nullptr;
+        }
+        check_capacity(count, capacity, what);
+        return buffer_cast<T>(address, capacity, what);
+    }
+
+    // Handles of a mesh range, for indexed parallel loops
+    template <typename Handle, typename Range> std::vector<Handle> handles(Range range) {
+        std::vector<Handle> result;
+        for (auto h : range) {
+            result.push_back(h);
+        }
+        return result;
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Per-vertex minimum, maximum, mean and Gaussian curvature of a triangle
+// mesh, n_vertices() pmp::Scalar each, from pmp::vertex_curvature() (the
+// operators of pmp::curvature() without tensor fitting or smoothing).
+// Boundary vertices get the average of their interior neighbors. Returns the
+// number of vertices written.
+inline std::size_t export_curvatures(const pmp::SurfaceMesh &mesh, std::uintptr_t out_min,
+                                     std::uintptr_t out_max, std::uintptr_t out_mean,
+                                     std::uintptr_t out_gauss, std::size_t capacity,
+                                     unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    if (!mesh.is_triangle_mesh()) {
+        throw pmp::InvalidInputException("Input is not a triangle mesh!");
+    }
+    const std::size_t n = mesh.n_vertices();
+    auto *kmin  = optional_output<pmp::Scalar>(out_min, n, capacity, "export_curvatures");
+    auto *kmax  = optional_output<pmp::Scalar>(out_max, n, capacity, "export_curvatures");
+    auto *mean  = optional_output<pmp::Scalar>(out_mean, n, capacity, "export_curvatures");
+    auto *gauss = optional_output<pmp::Scalar>(out_gauss, n, capacity, "export_curvatures");
+
+    const auto vertices = handles<pmp::Vertex>(mesh.vertices());
+    const auto map      = compact_vertex_map(mesh);
+    const auto row      = [&](pmp::Vertex v) { return map.empty() ? v.idx() : map[v.idx()]; };
+
+    std::vector<pmp::VertexCurvature> k(n);
+    std::vector<char>                 interior(n, 0);
+    pmp_rosetta::parallel_for(
+        0, n,
+        [&](std::size_t i) {
+            const auto v = vertices[i];
+            if (!mesh.is_isolated(v) && !mesh.is_boundary(v)) {
+                interior[i] = 1;
+                k[i]        = pmp::vertex_curvature(mesh, v);
+            }
+        },
+        n_threads, 256);
+
+    // Boundary vertices only read interior values, which are final
+    pmp_rosetta::parallel_for(
+        0, n,
+        [&](std::size_t i) {
+            if (interior[i] || mesh.is_isolated(vertices[i])) {
+                return;
+            }
+            pmp::VertexCurvature sum;
+            int                  count = 0;
+            for (auto w : mesh.vertices(vertices[i])) {
+                const auto j = row(w);
+                if (interior[j]) {
+                    sum.min += k[j].min;
+                    sum.max += k[j].max;
+                    sum.mean += k[j].mean;
+                    sum.gauss += k[j].gauss;
+                    ++count;
+                }
+            }
+            if (count > 0) {
+                k[i].min   = sum.min / count;
+                k[i].max   = sum.max / count;
+                k[i].mean  = sum.mean / count;
+                k[i].gauss = sum.gauss / count;
+            }
+        },
+        n_threads, 256);
+
+    for (std::size_t i = 0; i < n; ++i) {
+        if (kmin) {
+            kmin[i] = pmp::Scalar(k[i].min);
+        }
+        if (kmax) {
+            kmax[i] = pmp::Scalar(k[i].max);
+        }
+        if (mean) {
+            mean[i] = pmp::Scalar(k[i].mean);
+        }
+        if (gauss) {
+            gauss[i] = pmp::Scalar(k[i].gauss);
+        }
+    }
+    return n;
+}
+
+// Vertex normals as computed by pmp::vertex_normal(), n_vertices() * 3
+// pmp::Scalar. Returns the number of vertices written.
+inline std::size_t export_vertex_normals(const pmp::SurfaceMesh &mesh, std::uintptr_t out,
+                                         std::size_t capacity, unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    check_capacity(mesh.n_vertices() * 3, capacity, "export_vertex_normals");
+    auto *dst = buffer_cast<pmp::Scalar>(out, capacity, "export_vertex_normals");
+
+    const auto vertices = handles<pmp::Vertex>(mesh.vertices());
+    with_arity(mesh, [&](auto arity) {
+        pmp_rosetta::parallel_for(
+            0, vertices.size(),
+            [&](std::size_t i) {
+                const auto n = vertex_normal(mesh, vertices[i], arity);
+                for (int k = 0; k < 3; ++k) {
+                    dst[3 * i + k] = n[k];
+                }
+            },
+            n_threads, 256);
+    });
+    return vertices.size();
+}
+
+// Face normals as computed by pmp::face_normal(), n_faces() * 3 pmp::Scalar.
+// Returns the number of faces written.
+inline std::size_t export_face_normals(const pmp::SurfaceMesh &mesh, std::uintptr_t out,
+                                       std::size_t capacity, unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    check_capacity(mesh.n_faces() * 3, capacity, "export_face_normals");
+    auto *dst = buffer_cast<pmp::Scalar>(out, capacity, "export_face_normals");
+
+    const auto faces = handles<pmp::Face>(mesh.faces());
+    with_arity(mesh, [&](auto arity) {
+        pmp_rosetta::parallel_for(
+            0, faces.size(),
+            [&](std::size_t i) {
+                const auto n = face_normal(mesh, faces[i], arity);
+                for (int k = 0; k < 3; ++k) {
+                    dst[3 * i + k] = n[k];
+                }
+            },
+            n_threads, 256);
+    });
+    return faces.size();
+}
+
+// Mixed Voronoi area of every vertex (pmp::voronoi_area()), n_vertices()
+// pmp::Scalar. Returns the number of vertices written.
+inline std::size_t export_vertex_areas(const pmp::SurfaceMesh &mesh, std::uintptr_t out,
+                                       std::size_t capacity, unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    check_capacity(mesh.n_vertices(), capacity, "export_vertex_areas");
+    auto *dst = buffer_cast<pmp::Scalar>(out, capacity, "export_vertex_areas");
+
+    const auto vertices = handles<pmp::Vertex>(mesh.vertices());
+    pmp_rosetta::parallel_for(
+        0, vertices.size(),
+        [&](std::size_t i) { dst[i] = pmp::Scalar(pmp::voronoi_area(mesh, vertices[i])); },
+        n_threads, 256);
+    return vertices.size();
+}
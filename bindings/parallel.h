@@ -0,0 +1,240 @@
+// ============================================================================
+// Native threading utilities shared by the parallel kernels
+// ============================================================================
+// - ThreadPool:   fixed set of workers, one task deque per worker; idle
+//                 workers steal from the back of the other deques.
+// - shared_pool(): process-wide pool used by parallel_for().
+// - parallel_for(): chunked loop over an index range. The calling thread
+//                 takes part in the work, so nested calls (e.g. a parallel
+//                 kernel inside a batch task) can never deadlock.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace pmp_rosetta {
+
+    // Number of threads to use for a requested count, 0 meaning "all cores"
+    inline std::size_t resolve_threads(std::size_t n_threads) {
+        if (n_threads == 0) {
+            n_threads = std::thread::hardware_concurrency();
+        }
+        return std::max<std::size_t>(n_threads, 1);
+    }
+
+    class ThreadPool {
+    public:
+        explicit ThreadPool(std::size_t n_threads = 0) {
+            const auto n = resolve_threads(n_threads);
+            for (std::size_t i = 0; i < n; ++i) {
+                queues_.push_back(std::make_unique<Queue>());
+            }
+            for (std::size_t i = 0; i < n; ++i) {
+                workers_.emplace_back([this, i] { run(i); });
+            }
+        }
+
+        // Finishes the queued tasks before joining the workers
+        ~ThreadPool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stop_ = true;
+            }
+            wake_.notify_all();
+            for (auto &w : workers_) {
+                w.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool &)            = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+
+        std::size_t size() const { return workers_.size(); }
+
+        // Queue a task. Tasks are spread round-robin over the worker deques.
+        void submit(std::function<void()> task) {
+            const auto i = next_queue_++ % queues_.size();
+            {
+                std::lock_guard<std::mutex> lock(queues_[i]->mutex);
+                queues_[i]->tasks.push_back(std::move(task));
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                ++queued_;
+                ++pending_;
+            }
+            wake_.notify_one();
+        }
+
+        // Block until every submitted task has run. Rethrows the first
+        // exception escaping a task, if any.
+        void wait() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            idle_.wait(lock, [this] { return pending_ == 0; });
+            if (error_) {
+                auto error = error_;
+                error_     = nullptr;
+                std::rethrow_exception(error);
+            }
+        }
+
+    private:
+        struct Queue {
+            std::mutex                        mutex;
+            std::deque<std::function<void()>> tasks;
+        };
+
+        // Own deque first (FIFO), then steal from the back of the others
+        bool pop(std::size_t self, std::function<void()> &task) {
+            for (std::size_t k = 0; k < queues_.size(); ++k) {
+                auto                       &q = *queues_[(self + k) % queues_.size()];
+                std::lock_guard<std::mutex> lock(q.mutex);
+                if (q.tasks.empty()) {
+                    continue;
+                }
+                if (k == 0) {
+                    task = std::move(q.tasks.front());
+                    q.tasks.pop_front();
+                } else {
+                    task = std::move(q.tasks.back());
+                    q.tasks.pop_back();
+                }
+                return true;
+            }
+            return false;
+        }
+
+        void run(std::size_t self) {
+            std::function<void()> task;
+            for (;;) {
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    wake_.wait(lock, [this] { return stop_ || queued_ > 0; });
+                    if (queued_ == 0) {
+                        return; // stopping and drained
+                    }
+                }
+                // Another worker may have taken the task in between
+                if (!pop(self, task)) {
+                    continue;
+                }
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    --queued_;
+                }
+                try {
+                    task();
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    if (!error_) {
+                        error_ = std::current_exception();
+                    }
+                }
+                task = nullptr;
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (--pending_ == 0) {
+                    idle_.notify_all();
+                }
+            }
+        }
+
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread>            workers_;
+        std::atomic<std::size_t>            next_queue_{0};
+
+        std::mutex              mutex_;
+        std::condition_variable wake_;
+        std::condition_variable idle_;
+        std::size_t             queued_  = 0; // in the deques
+        std::size_t             pending_ = 0; // queued or running
+        bool                    stop_    = false;
+        std::exception_ptr      error_;
+    };
+
+    // Process-wide pool used by parallel_for(), leaving one core to the caller
+    inline ThreadPool &shared_pool() {
+        static ThreadPool pool(std::max<std::size_t>(resolve_threads(0) - 1, 1));
+        return pool;
+    }
+
+    // Call fn(i) for every i in [begin, end), split in chunks of `grain`
+    // indices over at most n_threads threads (0 = all cores). Exceptions
+    // thrown by fn are rethrown in the calling thread.
+    template <typename Fn>
+    void parallel_for(std::size_t begin, std::size_t end, Fn &&fn, std::size_t n_threads = 0,
+                      std::size_t grain = 1024) {
+        if (end <= begin) {
+            return;
+        }
+        grain                  = std::max<std::size_t>(grain, 1);
+        const auto n_chunks    = (end - begin + grain - 1) / grain;
+        const auto max_threads = std::min(resolve_threads(n_threads), shared_pool().size() + 1);
+        const auto n_helpers   = std::min(max_threads, n_chunks) - 1;
+
+        if (n_helpers == 0) {
+            for (auto i = begin; i < end; ++i) {
+                fn(i);
+            }
+            return;
+        }
+
+        struct State {
+            std::atomic<std::size_t> next{0};
+            std::size_t              done = 0;
+            std::mutex               mutex;
+            std::condition_variable  finished;
+            std::exception_ptr       error;
+        };
+        auto state = std::make_shared<State>();
+
+        // Helpers may start after the loop is over: they only touch fn
+        // through a chunk they managed to claim, and keep `state` alive.
+        auto *body = &fn;
+        auto  work = [state, body, begin, end, grain, n_chunks] {
+            for (;;) {
+                const auto chunk = state->next++;
+                if (chunk >= n_chunks) {
+                    return;
+                }
+                try {
+                    const auto first = begin + chunk * grain;
+                    const auto last  = std::min(first + grain, end);
+                    for (auto i = first; i < last; ++i) {
+                        (*body)(i);
+                    }
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(state->mutex);
+                    if (!state->error) {
+                        state->error = std::current_exception();
+                    }
+                }
+                std::lock_guard<std::mutex> lock(state->mutex);
+                if (++state->done == n_chunks) {
+                    state->finished.notify_all();
+                }
+            }
+        };
+
+        for (std::size_t k = 0; k < n_helpers; ++k) {
+            shared_pool().submit(work);
+        }
+        work();
+
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&] { return state->done == n_chunks; });
+        if (state->error) {
+            std::rethrow_exception(state->error);
+        }
+    }
+
+} // namespace pmp_rosetta
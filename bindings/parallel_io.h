@@ -0,0 +1,707 @@
+// ============================================================================
+// Multithreaded mesh reader for OBJ, binary STL and binary PLY
+// ============================================================================
+// The file is memory-mapped, split in chunks that are parsed in parallel
+// straight into a pre-reserved SurfaceMesh, so loading scales with cores and
+// no copy of the file is ever held in process memory.
+//
+// Only geometry and connectivity are read (no normals, colors or texture
+// coordinates). Formats or variants not handled here (ASCII STL, ASCII or
+// big-endian PLY, OFF...) fall back to pmp::read().
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <pmp/exceptions.h>
+#include <pmp/io/io.h>
+#include <pmp/surface_mesh.h>
+
+#include "mapped_file.h"
+#include "mesh_buffers.h"
+#include "parallel.h"
+#include "profiling.h"
+
+// Read-side counterpart of pmp::IOFlags
+struct ReadFlags {
+    // Use the multithreaded reader when the format supports it
+    bool use_parallel = true;
+
+    // Number of threads, 0 for all cores
+    unsigned int n_threads = 0;
+
+    // Size in bytes of the text chunks parsed by each task
+    std::size_t chunk_size = std::size_t(8) << 20;
+};
+
+namespace pmp_rosetta::detail {
+
+    inline const char *skip_blanks(const char *p, const char *end) {
+        while (p < end && (*p == ' ' || *p == '\t' || *p == '\r')) {
+            ++p;
+        }
+        return p;
+    }
+
+    inline const char *skip_line(const char *p, const char *end) {
+        p = static_cast<const char *>(std::memchr(p, '\n', std::size_t(end - p)));
+        return p ? p + 1 : end;
+    }
+
+    // Parse a decimal integer at p, advancing p. Returns false if there is none.
+    inline bool parse_integer(const char *&p, const char *end, std::int64_t &value) {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p++ == '-';
+        }
+        if (p == end || !std::isdigit(static_cast<unsigned char>(*p))) {
+            return false;
+        }
+        std::int64_t v = 0;
+        while (p < end && std::isdigit(static_cast<unsigned char>(*p))) {
+            v = 10 * v + (*p++ - '0');
+        }
+        value = negative ? -v : v;
+        return true;
+    }
+
+    // Parse a floating point number at p, advancing p. Bounded by `end`, so
+    // it works on memory-mapped text that is not zero-terminated.
+    inline bool parse_real(const char *&p, const char *end, double &value) {
+        static constexpr double powers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                            1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                            1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p++ == '-';
+        }
+
+        std::uint64_t mantissa = 0;
+        int           exponent = 0;
+        int           n_digits = 0;
+        bool          any      = false;
+        for (; p < end && std::isdigit(static_cast<unsigned char>(*p)); ++p, any = true) {
+            if (n_digits < 19) {
+                mantissa = 10 * mantissa + std::uint64_t(*p - '0');
+                n_digits += mantissa != 0;
+            } else {
+                ++exponent;
+            }
+        }
+        if (p < end && *p == '.') {
+            for (++p; p < end && std::isdigit(static_cast<unsigned char>(*p)); ++p, any = true) {
+                if (n_digits < 19) {
+                    mantissa = 10 * mantissa + std::uint64_t(*p - '0');
+                    n_digits += mantissa != 0;
+                    --exponent;
+                }
+            }
+        }
+        if (!any) {
+            return false;
+        }
+        if (p < end && (*p == 'e' || *p == 'E')) {
+            const char  *q = p + 1;
+            std::int64_t e = 0;
+            if (parse_integer(q, end, e)) {
+                exponent += int(std::clamp<std::int64_t>(e, -1000, 1000));
+                p = q;
+            }
+        }
+
+        double v = double(mantissa);
+        if (exponent >= 0 && exponent <= 22) {
+            v *= powers[exponent];
+        } else if (exponent < 0 && exponent >= -22) {
+            v /= powers[-exponent];
+        } else {
+            // Two steps, so that the scale factor does not overflow near the limits
+            v *= std::pow(10.0, exponent / 2);
+            v *= std::pow(10.0, exponent - exponent / 2);
+        }
+        value = negative ? -v : v;
+        return true;
+    }
+
+    // Split [begin, end) into pieces of about chunk_size bytes ending on a newline
+    inline std::vector<const char *> split_lines(const char *begin, const char *end,
+                                                 std::size_t chunk_size) {
+        std::vector<const char *> bounds{begin};
+        chunk_size = std::max<std::size_t>(chunk_size, 1 << 12);
+        for (const char *p = begin; std::size_t(end - p) > chunk_size;) {
+            p = skip_line(p + chunk_size, end);
+            if (p < end) {
+                bounds.push_back(p);
+            }
+        }
+        bounds.push_back(end);
+        return bounds;
+    }
+
+    // ------------------------------------------------------------------------
+    // OBJ
+    // ------------------------------------------------------------------------
+
+    struct ObjChunk {
+        std::size_t n_vertices = 0;
+        std::size_t n_faces    = 0;
+        std::size_t n_corners  = 0;
+    };
+
+    // Line type at p: 'v' for a vertex, 'f' for a face, 0 otherwise
+    inline char obj_line_type(const char *p, const char *end) {
+        if (end - p >= 2 && (p[1] == ' ' || p[1] == '\t') && (p[0] == 'v' || p[0] == 'f')) {
+            return p[0];
+        }
+        return 0;
+    }
+
+    // Count the corners of the face whose first token starts at p
+    inline std::size_t obj_count_corners(const char *p, const char *end) {
+        std::size_t n = 0;
+        for (;;) {
+            p = skip_blanks(p, end);
+            if (p == end || *p == '\n' || *p == '#') {
+                return n;
+            }
+            ++n;
+            while (p < end && !std::isspace(static_cast<unsigned char>(*p))) {
+                ++p;
+            }
+        }
+    }
+
+    inline ObjChunk obj_count(const char *p, const char *end) {
+        ObjChunk c;
+        for (; p < end; p = skip_line(p, end)) {
+            p = skip_blanks(p, end);
+            switch (obj_line_type(p, end)) {
+                case 'v':
+                    ++c.n_vertices;
+                    break;
+                case 'f':
+                    if (const auto n = obj_count_corners(p + 2, end); n >= 3) {
+                        ++c.n_faces;
+                        c.n_corners += n;
+                    }
+                    break;
+            }
+        }
+        return c;
+    }
+
+    // Parse one chunk, writing its vertices and faces at the offsets given by
+    // the prefix sums of the counts of the previous chunks. Corners that do
+    // not resolve to a vertex index are stored as PMP_MAX_INDEX.
+    inline void obj_parse(const char *p, const char *end, const ObjChunk &offset,
+                          pmp::Point *points, pmp::IndexType *corners, FaceRange *faces) {
+        std::size_t vertex = offset.n_vertices;
+        std::size_t face   = offset.n_faces;
+        std::size_t corner = offset.n_corners;
+
+        for (; p < end; p = skip_line(p, end)) {
+            p = skip_blanks(p, end);
+            const char type = obj_line_type(p, end);
+            if (type == 'v') {
+                double xyz[3] = {0, 0, 0};
+                p += 2;
+                for (double &x : xyz) {
+                    p = skip_blanks(p, end);
+                    if (!parse_real(p, end, x)) {
+                        throw pmp::IOException("OBJ: invalid vertex " + std::to_string(vertex));
+                    }
+                }
+                points[vertex++] = pmp::Point(pmp::Scalar(xyz[0]), pmp::Scalar(xyz[1]),
+                                              pmp::Scalar(xyz[2]));
+            } else if (type == 'f') {
+                const auto n = obj_count_corners(p + 2, end);
+                if (n < 3) {
+                    continue;
+                }
+                faces[face++] = {corner, n};
+                p += 2;
+                for (std::size_t i = 0; i < n; ++i) {
+                    p = skip_blanks(p, end);
+                    std::int64_t idx = 0;
+                    if (!parse_integer(p, end, idx) || idx == 0) {
+                        throw pmp::IOException("OBJ: invalid face " + std::to_string(face - 1));
+                    }
+                    // 1-based, negative values are relative to the last vertex
+                    const auto v      = idx > 0 ? idx - 1 : std::int64_t(vertex) + idx;
+                    corners[corner++] = v < 0 || v >= std::int64_t(PMP_MAX_INDEX)
+                                            ? PMP_MAX_INDEX
+                                            : pmp::IndexType(v);
+                    // Skip texture coordinate / normal indices
+                    while (p < end && !std::isspace(static_cast<unsigned char>(*p))) {
+                        ++p;
+                    }
+                }
+            }
+        }
+    }
+
+    // 1-based line number of the face-th face of the file, for error messages
+    inline std::size_t obj_face_line(const std::vector<const char *> &bounds,
+                                     const std::vector<ObjChunk> &offsets, std::size_t face) {
+        std::size_t chunk = 0;
+        while (offsets[chunk + 1].n_faces <= face) {
+            ++chunk;
+        }
+        std::size_t n_faces = offsets[chunk].n_faces;
+        const char *p       = bounds[chunk];
+        for (; p < bounds[chunk + 1]; p = skip_line(p, bounds[chunk + 1])) {
+            const char *q = skip_blanks(p, bounds[chunk + 1]);
+            if (obj_line_type(q, bounds[chunk + 1]) == 'f' &&
+                obj_count_corners(q + 2, bounds[chunk + 1]) >= 3 && n_faces++ == face) {
+                break;
+            }
+        }
+        return 1 + std::size_t(std::count(bounds.front(), p, '\n'));
+    }
+
+    // Throw for the first face referring to a vertex the file does not have
+    inline void obj_check_indices(const std::string &path, const std::vector<const char *> &bounds,
+                                  const std::vector<ObjChunk> &offsets,
+                                  const std::vector<pmp::IndexType> &corners,
+                                  const std::vector<FaceRange> &faces, unsigned int n_threads) {
+        const auto               n          = bounds.size() - 1;
+        const auto               n_vertices = offsets[n].n_vertices;
+        std::vector<std::size_t> bad(n, faces.size());
+        parallel_for(
+            0, n,
+            [&](std::size_t i) {
+                for (auto f = offsets[i].n_faces; f < offsets[i + 1].n_faces; ++f) {
+                    const auto *idx = corners.data() + faces[f].begin;
+                    for (std::size_t k = 0; k < faces[f].size; ++k) {
+                        if (idx[k] >= n_vertices) {
+                            bad[i] = f;
+                            return;
+                        }
+                    }
+                }
+            },
+            n_threads, 1);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            if (bad[i] < faces.size()) {
+                throw pmp::IOException("OBJ: face vertex index out of range in " + path +
+                                       ", line " +
+                                       std::to_string(obj_face_line(bounds, offsets, bad[i])));
+            }
+        }
+    }
+
+    inline void read_obj_parallel(pmp::SurfaceMesh &mesh, const MappedFile &file,
+                                  const std::string &path, const ReadFlags &flags) {
+        const char *data   = file.data();
+        const auto  bounds = split_lines(data, data + file.size(), flags.chunk_size);
+        const auto  n      = bounds.size() - 1;
+
+        std::vector<ObjChunk> counts(n);
+        {
+            ProfileScope scope("read_mesh.count");
+            parallel_for(
+                0, n, [&](std::size_t i) { counts[i] = obj_count(bounds[i], bounds[i + 1]); },
+                flags.n_threads, 1);
+        }
+
+        // Exclusive prefix sums give each chunk its output offsets
+        std::vector<ObjChunk> offsets(n + 1);
+        for (std::size_t i = 0; i < n; ++i) {
+            offsets[i + 1].n_vertices = offsets[i].n_vertices + counts[i].n_vertices;
+            offsets[i + 1].n_faces    = offsets[i].n_faces + counts[i].n_faces;
+            offsets[i + 1].n_corners  = offsets[i].n_corners + counts[i].n_corners;
+        }
+        const auto &total = offsets[n];
+
+        mesh.clear();
+        mesh.reserve(total.n_vertices, 0, 0);
+        for (std::size_t i = 0; i < total.n_vertices; ++i) {
+            mesh.add_vertex(pmp::Point(0, 0, 0));
+        }
+
+        std::vector<pmp::IndexType> corners(total.n_corners);
+        std::vector<FaceRange>      faces(total.n_faces);
+        {
+            ProfileScope scope("read_mesh.parse");
+            parallel_for(
+                0, n,
+                [&](std::size_t i) {
+                    obj_parse(bounds[i], bounds[i + 1], offsets[i], mesh.positions().data(),
+                              corners.data(), faces.data());
+                },
+                flags.n_threads, 1);
+        }
+
+        obj_check_indices(path, bounds, offsets, corners, faces, flags.n_threads);
+
+        // Edges and faces are only allocated once the scratch buffers of
+        // reject_faces() are released
+        ProfileScope scope("read_mesh.build");
+        const auto   rejected = reject_faces(corners.data(), faces, total.n_vertices);
+        mesh.reserve(total.n_vertices, total.n_corners / 2, total.n_faces);
+        add_faces(mesh, corners.data(), faces, rejected);
+    }
+
+    // ------------------------------------------------------------------------
+    // Binary STL
+    // ------------------------------------------------------------------------
+
+    // Build a mesh from a triangle soup (3 points per triangle), welding
+    // identical points into one vertex. Faces that would make the mesh
+    // non-manifold are skipped and flagged in the result. Fills corners with
+    // the vertex of every point.
+    inline std::vector<bool> add_triangle_soup(pmp::SurfaceMesh                        &mesh,
+                                               const std::vector<std::array<float, 3>> &points,
+                                               std::vector<std::int64_t>               &corners) {
+        const std::size_t n_corners = points.size();
+
+        // Weld identical points: sort corner ids by position, then number the
+        // unique positions in order of first appearance
+        std::vector<std::uint32_t> order(n_corners);
+        std::iota(order.begin(), order.end(), 0u);
+        std::sort(order.begin(), order.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return points[a] < points[b] || (points[a] == points[b] && a < b);
+        });
+
+        std::vector<std::uint32_t> first(n_corners);
+        for (std::size_t i = 0; i < n_corners; ++i) {
+            const bool same = i > 0 && points[order[i]] == points[order[i - 1]];
+            first[order[i]] = same ? first[order[i - 1]] : order[i];
+        }
+
+        corners.resize(n_corners);
+        std::size_t n_vertices = 0;
+        mesh.clear();
+        mesh.reserve(n_corners / 6 + 2, n_corners / 2, n_corners / 3);
+        for (std::size_t c = 0; c < n_corners; ++c) {
+            if (first[c] == c) {
+                const auto &p = points[c];
+                corners[c]    = std::int64_t(n_vertices++);
+                mesh.add_vertex(pmp::Point(p[0], p[1], p[2]));
+            } else {
+                corners[c] = corners[first[c]];
+            }
+        }
+
+        const auto faces    = decode_faces(corners.data(), n_corners, 3);
+        auto       rejected = reject_faces(corners.data(), faces, n_vertices);
+
+        std::vector<pmp::Vertex>                             triangle(3);
+        std::vector<std::pair<pmp::Halfedge, pmp::Halfedge>> saved;
+        for (std::size_t f = 0; f < faces.size(); ++f) {
+            if (rejected[f]) {
+                continue;
+            }
+            for (int k = 0; k < 3; ++k) {
+                triangle[k] = pmp::Vertex(pmp::IndexType(corners[3 * f + k]));
+            }
+            // Complex vertex: the face cannot be glued to its neighbors
+            rejected[f] = !try_add_face(mesh, triangle, saved);
+        }
+        return rejected;
+    }
+
+    inline void add_triangle_soup(pmp::SurfaceMesh                        &mesh,
+                                  const std::vector<std::array<float, 3>> &points) {
+        std::vector<std::int64_t> corners;
+        add_triangle_soup(mesh, points, corners);
+    }
+
+    inline bool is_binary_stl(const MappedFile &file) {
+        if (file.size() < 84) {
+            return false;
+        }
+        std::uint32_t n = 0;
+        std::memcpy(&n, file.data() + 80, sizeof(n));
+        return file.size() == 84 + 50 * std::size_t(n);
+    }
+
+    inline void read_stl_parallel(pmp::SurfaceMesh &mesh, const MappedFile &file,
+                                  const ReadFlags &flags) {
+        std::uint32_t n_triangles = 0;
+        std::memcpy(&n_triangles, file.data() + 80, sizeof(n_triangles));
+        const std::size_t n_corners = 3 * std::size_t(n_triangles);
+
+        // Decode all corners in parallel: 12 bytes normal, 3 x 12 bytes points
+        std::vector<std::array<float, 3>> points(n_corners);
+        {
+            ProfileScope scope("read_mesh.decode");
+            parallel_for(
+                0, n_triangles,
+                [&](std::size_t t) {
+                    const char *facet = file.data() + 84 + 50 * t + 12;
+                    std::memcpy(points[3 * t].data(), facet, 36);
+                },
+                flags.n_threads);
+        }
+
+        ProfileScope scope("read_mesh.weld");
+        add_triangle_soup(mesh, points);
+    }
+
+    // ------------------------------------------------------------------------
+    // Binary little-endian PLY
+    // ------------------------------------------------------------------------
+
+    // Size in bytes of a PLY scalar type, 0 if unknown
+    inline std::size_t ply_type_size(const std::string &type) {
+        if (type == "char" || type == "uchar" || type == "int8" || type == "uint8") {
+            return 1;
+        }
+        if (type == "short" || type == "ushort" || type == "int16" || type == "uint16") {
+            return 2;
+        }
+        if (type == "int" || type == "uint" || type == "int32" || type == "uint32" ||
+            type == "float" || type == "float32") {
+            return 4;
+        }
+        if (type == "double" || type == "float64") {
+            return 8;
+        }
+        return 0;
+    }
+
+    // Read a PLY scalar of the given type at p as a double
+    inline double ply_value(const char *p, const std::string &type) {
+        auto get = [p](auto v) {
+            std::memcpy(&v, p, sizeof(v));
+            return double(v);
+        };
+        if (type == "char" || type == "int8") return get(std::int8_t());
+        if (type == "uchar" || type == "uint8") return get(std::uint8_t());
+        if (type == "short" || type == "int16") return get(std::int16_t());
+        if (type == "ushort" || type == "uint16") return get(std::uint16_t());
+        if (type == "int" || type == "int32") return get(std::int32_t());
+        if (type == "uint" || type == "uint32") return get(std::uint32_t());
+        if (type == "float" || type == "float32") return get(float());
+        return get(double());
+    }
+
+    struct PlyProperty {
+        std::string name;
+        std::string type;       // value type
+        std::string count_type; // non-empty for list properties
+    };
+
+    struct PlyElement {
+        std::string              name;
+        std::size_t              count = 0;
+        std::vector<PlyProperty> properties;
+    };
+
+    struct PlyHeader {
+        bool                    binary_le = false;
+        std::size_t             data_offset = 0;
+        std::vector<PlyElement> elements;
+    };
+
+    // Parse the header. Returns false for files this reader does not handle.
+    inline bool parse_ply_header(const MappedFile &file, PlyHeader &header) {
+        const char *end = file.data() + file.size();
+        const char *p   = file.data();
+        if (file.size() < 4 || std::strncmp(p, "ply", 3) != 0) {
+            return false;
+        }
+        for (p = skip_line(p, end); p < end;) {
+            const char *eol = skip_line(p, end);
+            std::istringstream line(std::string(p, eol));
+            p = eol;
+
+            std::string keyword;
+            line >> keyword;
+            if (keyword == "format") {
+                std::string format;
+                line >> format;
+                header.binary_le = format == "binary_little_endian";
+            } else if (keyword == "element") {
+                PlyElement e;
+                line >> e.name >> e.count;
+                header.elements.push_back(e);
+            } else if (keyword == "property") {
+                if (header.elements.empty()) {
+                    return false;
+                }
+                PlyProperty prop;
+                line >> prop.type;
+                if (prop.type == "list") {
+                    line >> prop.count_type >> prop.type;
+                }
+                line >> prop.name;
+                header.elements.back().properties.push_back(prop);
+            } else if (keyword == "end_header") {
+                header.data_offset = std::size_t(p - file.data());
+                break;
+            }
+        }
+
+        const std::uint16_t probe = 1;
+        const bool little_endian = *reinterpret_cast<const unsigned char *>(&probe) == 1;
+        return header.binary_le && little_endian && header.data_offset > 0;
+    }
+
+    inline bool read_ply_parallel(pmp::SurfaceMesh &mesh, const MappedFile &file,
+                                  const ReadFlags &flags) {
+        ProfileScope scope("read_mesh.ply");
+
+        PlyHeader header;
+        if (!parse_ply_header(file, header)) {
+            return false;
+        }
+
+        const char *p   = file.data() + header.data_offset;
+        const char *end = file.data() + file.size();
+
+        auto stride_of = [](const PlyElement &e) {
+            std::size_t stride = 0;
+            for (const auto &prop : e.properties) {
+                const auto size = ply_type_size(prop.type);
+                if (!prop.count_type.empty() || size == 0) {
+                    return std::size_t(0);
+                }
+                stride += size;
+            }
+            return stride;
+        };
+
+        bool done_vertices = false;
+        for (const auto &element : header.elements) {
+            if (element.name == "vertex") {
+                const auto stride = stride_of(element);
+                if (stride == 0 || std::size_t(end - p) < stride * element.count) {
+                    return false;
+                }
+
+                // Offsets and types of x, y, z inside a vertex record
+                std::size_t offsets[3] = {0, 0, 0};
+                std::string types[3];
+                int         found  = 0;
+                std::size_t offset = 0;
+                for (const auto &prop : element.properties) {
+                    const int axis = prop.name == "x" ? 0 : prop.name == "y" ? 1
+                                                        : prop.name == "z"   ? 2
+                                                                             : -1;
+                    if (axis >= 0) {
+                        offsets[axis] = offset;
+                        types[axis]   = prop.type;
+                        ++found;
+                    }
+                    offset += ply_type_size(prop.type);
+                }
+                if (found != 3) {
+                    return false;
+                }
+
+                mesh.clear();
+                for (std::size_t i = 0; i < element.count; ++i) {
+                    mesh.add_vertex(pmp::Point(0, 0, 0));
+                }
+                auto *points = mesh.positions().data();
+                parallel_for(
+                    0, element.count,
+                    [&](std::size_t i) {
+                        const char *record = p + i * stride;
+                        for (int k = 0; k < 3; ++k) {
+                            points[i][k] = pmp::Scalar(ply_value(record + offsets[k], types[k]));
+                        }
+                    },
+                    flags.n_threads);
+                p += stride * element.count;
+                done_vertices = true;
+            } else if (element.name == "face" && done_vertices) {
+                // Variable-size records: decode sequentially into a flat buffer
+                std::vector<pmp::IndexType> corners;
+                std::vector<FaceRange>      faces;
+                corners.reserve(3 * element.count);
+                faces.reserve(element.count);
+                for (std::size_t f = 0; f < element.count; ++f) {
+                    for (const auto &prop : element.properties) {
+                        const bool is_list = !prop.count_type.empty();
+                        const auto size    = ply_type_size(prop.type);
+                        const auto count_size = is_list ? ply_type_size(prop.count_type) : 0;
+                        if (size == 0 || (is_list && count_size == 0) ||
+                            std::size_t(end - p) < count_size + size) {
+                            throw pmp::IOException("PLY: truncated face data");
+                        }
+                        if (!is_list) {
+                            p += size;
+                            continue;
+                        }
+                        const auto n = std::size_t(ply_value(p, prop.count_type));
+                        p += count_size;
+                        if (std::size_t(end - p) < n * size) {
+                            throw pmp::IOException("PLY: truncated face data");
+                        }
+                        if (prop.name == "vertex_indices" || prop.name == "vertex_index") {
+                            if (n >= 3) {
+                                faces.push_back({corners.size(), n});
+                                for (std::size_t i = 0; i < n; ++i) {
+                                    const auto v = ply_value(p + i * size, prop.type);
+                                    if (v < 0 || v >= double(mesh.n_vertices())) {
+                                        throw pmp::IOException(
+                                            "PLY: face vertex index out of range");
+                                    }
+                                    corners.push_back(pmp::IndexType(v));
+                                }
+                            }
+                        }
+                        p += n * size;
+                    }
+                }
+
+                const auto rejected = reject_faces(corners.data(), faces, mesh.n_vertices());
+                mesh.reserve(mesh.n_vertices(), corners.size() / 2, faces.size());
+                add_faces(mesh, corners.data(), faces, rejected);
+                return true;
+            } else {
+                // Skip other elements, as long as their records have a fixed size
+                const auto stride = stride_of(element);
+                if (stride == 0 || std::size_t(end - p) < stride * element.count) {
+                    return false;
+                }
+                p += stride * element.count;
+            }
+        }
+        return done_vertices;
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Read a mesh, using the multithreaded reader for OBJ, binary STL and binary
+// little-endian PLY files when flags.use_parallel is set, pmp::read() otherwise.
+inline void read_mesh(pmp::SurfaceMesh &mesh, const std::filesystem::path &path,
+                      const ReadFlags &flags) {
+    using namespace pmp_rosetta::detail;
+
+    auto ext = path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return char(std::tolower(c)); });
+
+    if (flags.use_parallel && (ext == ".obj" || ext == ".stl" || ext == ".ply")) {
+        const pmp_rosetta::MappedFile file(path.string());
+        if (ext == ".obj") {
+            read_obj_parallel(mesh, file, path.string(), flags);
+            return;
+        }
+        if (ext == ".stl" && is_binary_stl(file)) {
+            read_stl_parallel(mesh, file, flags);
+            return;
+        }
+        if (ext == ".ply" && read_ply_parallel(mesh, file, flags)) {
+            return;
+        }
+    }
+
+    pmp::read(mesh, path);
+}
@@ -11,6 +11,8 @@
 
 #include <rosetta/rosetta.h>
 
+#include <cstdint>
+
 // PMP headers - Core
 #include <pmp/bounding_box.h>
 #include <pmp/surface_mesh.h>
@@ -36,6 +38,33 @@
 // PMP headers - IO
 #include <pmp/io/io.h>
 
+// Local helpers
+#include "batch.h"
+#include "batch_geodesics.h"
+#include "compact_mesh.h"
+#include "decimation.h"
+#include "explicit_smoothing.h"
+#include "feature_detection.h"
+#include "garbage_collection.h"
+#include "gil.h"
+#include "jobs.h"
+#include "laplacian.h"
+#include "lod.h"
+#include "mesh_buffers.h"
+#include "mesh_bvh.h"
+#include "mesh_copy.h"
+#include "mesh_geometry.h"
+#include "parallel_io.h"
+#include "profiling.h"
+#include "properties.h"
+#include "remesher.h"
+#include "remeshing.h"
+#include "render_buffers.h"
+#include "result_cache.h"
+#include "snapshot.h"
+#include "subdivision.h"
+#include "tiled.h"
+
 // NOTE: Do NOT use "using namespace pmp;" here - we need fully qualified names
 // for the overload macros to generate correct code.
 
@@ -49,6 +78,80 @@ inline void load_mesh(pmp::SurfaceMesh &mesh, const std::filesystem::path &filep
     pmp::read(mesh, filepath);
 }
 
+// Report of a finished parallel_decimate_async() job
+inline DecimationReport job_decimation_report(const Job &job) {
+    return job.result<DecimationReport>();
+}
+
+// Levels of a finished build_lod_chain_async() job
+inline LodChain job_lod_chain(const Job &job) {
+    return job.result<LodChain>();
+}
+
+// Profiling names of the functions registered with the *_NOGIL macros below,
+// matching their registered names (see gil.h). Given here rather than in
+// register_all() so that C++ callers are timed under them too.
+PMP_PROFILE_NAME(pmp::decimate, "decimate")
+PMP_PROFILE_NAME(parallel_decimate, "parallel_decimate")
+PMP_PROFILE_NAME(build_lod_chain, "build_lod_chain")
+PMP_PROFILE_NAME(write_lod_chain, "write_lod_chain")
+PMP_PROFILE_NAME(pmp::explicit_smoothing, "explicit_smoothing")
+PMP_PROFILE_NAME(pmp::implicit_smoothing, "implicit_smoothing")
+PMP_PROFILE_NAME(parallel_explicit_smoothing, "parallel_explicit_smoothing")
+PMP_PROFILE_NAME(pmp::uniform_remeshing, "uniform_remeshing")
+PMP_PROFILE_NAME(pmp::adaptive_remeshing, "adaptive_remeshing")
+PMP_PROFILE_NAME(parallel_uniform_remeshing, "parallel_uniform_remeshing")
+PMP_PROFILE_NAME(parallel_adaptive_remeshing, "parallel_adaptive_remeshing")
+PMP_PROFILE_NAME(uniform_remeshing_onto, "uniform_remeshing_onto")
+PMP_PROFILE_NAME(adaptive_remeshing_onto, "adaptive_remeshing_onto")
+PMP_PROFILE_NAME(pmp::loop_subdivision, "loop_subdivision")
+PMP_PROFILE_NAME(pmp::catmull_clark_subdivision, "catmull_clark_subdivision")
+PMP_PROFILE_NAME(pmp::quad_tri_subdivision, "quad_tri_subdivision")
+PMP_PROFILE_NAME(parallel_loop_subdivision, "parallel_loop_subdivision")
+PMP_PROFILE_NAME(parallel_catmull_clark_subdivision, "parallel_catmull_clark_subdivision")
+PMP_PROFILE_NAME(parallel_quad_tri_subdivision, "parallel_quad_tri_subdivision")
+PMP_PROFILE_NAME(pmp::vertex_normals, "vertex_normals")
+PMP_PROFILE_NAME(pmp::face_normals, "face_normals")
+PMP_PROFILE_NAME(pmp::detect_features, "detect_features")
+PMP_PROFILE_NAME(parallel_detect_features, "parallel_detect_features")
+PMP_PROFILE_NAME(pmp::fill_hole, "fill_hole")
+PMP_PROFILE_NAME(pmp::curvature, "curvature")
+PMP_PROFILE_NAME(pmp::harmonic_parameterization, "harmonic_parameterization")
+PMP_PROFILE_NAME(pmp::lscm_parameterization, "lscm_parameterization")
+PMP_PROFILE_OVERLOADED_NAME(pmp::triangulate, "triangulate", void (*)(pmp::SurfaceMesh &))
+PMP_PROFILE_OVERLOADED_NAME(pmp::read, "read",
+                            void (*)(pmp::SurfaceMesh &, const std::filesystem::path &))
+PMP_PROFILE_NAME(read_mesh, "read_mesh")
+PMP_PROFILE_NAME(load_mesh, "load_mesh")
+PMP_PROFILE_NAME(copy_mesh_into, "copy_mesh_into")
+PMP_PROFILE_NAME(parallel_garbage_collection, "parallel_garbage_collection")
+PMP_PROFILE_OVERLOADED_NAME(pmp::write, "write",
+                            void (*)(const pmp::SurfaceMesh &, const std::filesystem::path &,
+                                     const pmp::IOFlags &))
+PMP_PROFILE_NAME(save_snapshot, "save_snapshot")
+PMP_PROFILE_NAME(open_snapshot, "open_snapshot")
+PMP_PROFILE_NAME(export_compact_points, "export_compact_points")
+PMP_PROFILE_NAME(export_compact_faces, "export_compact_faces")
+PMP_PROFILE_NAME(expand_compact_mesh, "expand_compact_mesh")
+PMP_PROFILE_NAME(process_batch, "process_batch")
+PMP_PROFILE_NAME(process_tiled, "process_tiled")
+PMP_PROFILE_NAME(build_mesh, "build_mesh")
+PMP_PROFILE_NAME(export_curvatures, "export_curvatures")
+PMP_PROFILE_NAME(export_vertex_normals, "export_vertex_normals")
+PMP_PROFILE_NAME(export_face_normals, "export_face_normals")
+PMP_PROFILE_NAME(export_vertex_areas, "export_vertex_areas")
+PMP_PROFILE_NAME(export_render_buffers, "export_render_buffers")
+PMP_PROFILE_NAME(geodesic_distances, "geodesic_distances")
+PMP_PROFILE_NAME(mesh_content_hash, "mesh_content_hash")
+PMP_PROFILE_NAME(result_key, "result_key")
+PMP_PROFILE_NAME(cached_uniform_remeshing, "cached_uniform_remeshing")
+PMP_PROFILE_NAME(cached_adaptive_remeshing, "cached_adaptive_remeshing")
+PMP_PROFILE_NAME(cached_decimate, "cached_decimate")
+PMP_PROFILE_NAME(cached_loop_subdivision, "cached_loop_subdivision")
+PMP_PROFILE_NAME(cached_catmull_clark_subdivision, "cached_catmull_clark_subdivision")
+PMP_PROFILE_NAME(cached_quad_tri_subdivision, "cached_quad_tri_subdivision")
+PMP_PROFILE_NAME(write_chrome_trace, "write_chrome_trace")
+
 namespace pmp_rosetta {
 
     inline void register_all() {
@@ -79,6 +182,12 @@ namespace pmp_rosetta {
             .field("use_face_normals", &pmp::IOFlags::use_face_normals)
             .field("use_face_colors", &pmp::IOFlags::use_face_colors);
 
+        ROSETTA_REGISTER_CLASS(ReadFlags)
+            .constructor<>()
+            .field("use_parallel", &ReadFlags::use_parallel)
+            .field("n_threads", &ReadFlags::n_threads)
+            .field("chunk_size", &ReadFlags::chunk_size);
+
         // ========================================================================
         // Core Types
         // ========================================================================
@@ -115,8 +224,24 @@ namespace pmp_rosetta {
             .method("clear", &pmp::SurfaceMesh::clear)
             .method("reserve", &pmp::SurfaceMesh::reserve)
             .method("garbage_collection", &pmp::SurfaceMesh::garbage_collection)
+            .method("has_garbage", &pmp::SurfaceMesh::has_garbage)
+            // Raw property storage, including slots of deleted elements
+            .method("vertices_size", &pmp::SurfaceMesh::vertices_size)
+            .method("faces_size", &pmp::SurfaceMesh::faces_size)
+            // Address of the "v:point" storage: vertices_size() rows of 3 contiguous scalars.
+            // Valid until the next topology change or garbage_collection() on this mesh.
+            .lambda_method<std::uintptr_t>("points_address",
+                                           [](pmp::SurfaceMesh &self) {
+                                               static_assert(sizeof(pmp::Point) ==
+                                                             3 * sizeof(pmp::Scalar));
+                                               auto &points = self.positions();
+                                               return reinterpret_cast<std::uintptr_t>(
+                                                   points.empty() ? nullptr : points.data());
+                                           })
             .lambda_method_const<std::vector<pmp::Scalar>>("vertices",
                                                            [](const pmp::SurfaceMesh &self) {
+                                                               pmp_rosetta::ProfileScope scope(
+                                                                   "SurfaceMesh.vertices");
                                                                std::vector<pmp::Scalar> pos;
                                                                pos.reserve(self.n_vertices() * 3);
                                                                for (auto v : self.vertices()) {
@@ -128,51 +253,140 @@ namespace pmp_rosetta {
                                                                }
                                                                return pos;
                                                            })
-            .lambda_method<std::vector<pmp::IndexType>>("indices",
-                                                        [](const pmp::SurfaceMesh &self) {
-                                                            std::vector<pmp::IndexType> indices;
-                                                            indices.reserve(self.n_faces() * 3);
-                                                            for (auto f : self.faces()) {
-                                                                for (auto v : self.vertices(f)) {
-                                                                    indices.push_back(v.idx());
-                                                                }
-                                                            }
-                                                            return indices;
-                                                        });
+            .lambda_method<std::vector<pmp::IndexType>>(
+                "indices", [](const pmp::SurfaceMesh &self) {
+                    // Face corners, numbered consistently with "vertices" above
+                    pmp_rosetta::ProfileScope   scope("SurfaceMesh.indices");
+                    std::vector<pmp::IndexType> indices(n_face_indices(self));
+                    export_faces(self, reinterpret_cast<std::uintptr_t>(indices.data()),
+                                 indices.size(), 0, 0, true);
+                    return indices;
+                });
 
         // ========================================================================
         // Algorithms - Non-overloaded functions (simple registration)
+        // Long-running algorithms release the Python GIL while they run (see gil.h)
         // ========================================================================
 
         // Decimation
-        ROSETTA_REGISTER_FUNCTION(pmp::decimate);
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::decimate, "decimate");
+
+        // Patch-parallel decimation with a quality report (see decimation.h)
+        ROSETTA_REGISTER_CLASS(DecimationReport)
+            .constructor<>()
+            .field("n_vertices", &DecimationReport::n_vertices)
+            .field("n_faces", &DecimationReport::n_faces)
+            .field("n_patches", &DecimationReport::n_patches)
+            .field("patch_seconds", &DecimationReport::patch_seconds)
+            .field("finish_seconds", &DecimationReport::finish_seconds)
+            .field("total_seconds", &DecimationReport::total_seconds)
+            .field("max_error", &DecimationReport::max_error)
+            .field("mean_error", &DecimationReport::mean_error)
+            .field("compared", &DecimationReport::compared)
+            .field("serial_seconds", &DecimationReport::serial_seconds)
+            .field("serial_max_error", &DecimationReport::serial_max_error)
+            .field("serial_mean_error", &DecimationReport::serial_mean_error);
+
+        PMP_REGISTER_FUNCTION_NOGIL(parallel_decimate, "parallel_decimate");
+
+        // Levels of detail from one decimation run (see lod.h)
+        ROSETTA_REGISTER_CLASS(LodChain)
+            .constructor<>()
+            .method("n_levels", &LodChain::n_levels)
+            .method("n_input_vertices", &LodChain::n_input_vertices)
+            .method("n_vertices", &LodChain::n_vertices)
+            .method("n_faces", &LodChain::n_faces)
+            .method("n_collapses", &LodChain::n_collapses)
+            .method("level", &LodChain::level)
+            .method("vertex_map", &LodChain::vertex_map);
+        PMP_REGISTER_FUNCTION_NOGIL(build_lod_chain, "build_lod_chain");
+        PMP_REGISTER_FUNCTION_NOGIL(write_lod_chain, "write_lod_chain");
 
         // Smoothing
-        ROSETTA_REGISTER_FUNCTION(pmp::explicit_smoothing);
-        ROSETTA_REGISTER_FUNCTION(pmp::implicit_smoothing);
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::explicit_smoothing, "explicit_smoothing");
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::implicit_smoothing, "implicit_smoothing");
+
+        // explicit_smoothing over a CSR one-ring matrix, multithreaded (see explicit_smoothing.h)
+        PMP_REGISTER_FUNCTION_NOGIL(parallel_explicit_smoothing, "parallel_explicit_smoothing");
+
+        // Laplacian system with cached factorizations, for repeated implicit
+        // smoothing and parameterization of one connectivity (see laplacian.h)
+        ROSETTA_REGISTER_CLASS(LaplacianSystem)
+            .constructor<>()
+            .constructor<const pmp::SurfaceMesh &, bool>()
+            .method("empty", &LaplacianSystem::empty)
+            .method("n_vertices", &LaplacianSystem::n_vertices)
+            .method("n_factorizations", &LaplacianSystem::n_factorizations)
+            .method("matches", &LaplacianSystem::matches)
+            .method("update_geometry", &LaplacianSystem::update_geometry)
+            .method("implicit_smoothing", &LaplacianSystem::implicit_smoothing)
+            .method("harmonic_parameterization", &LaplacianSystem::harmonic_parameterization)
+            .method("lscm_parameterization", &LaplacianSystem::lscm_parameterization);
 
         // Remeshing
-        ROSETTA_REGISTER_FUNCTION(pmp::uniform_remeshing);
-        ROSETTA_REGISTER_FUNCTION(pmp::adaptive_remeshing);
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::uniform_remeshing, "uniform_remeshing");
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::adaptive_remeshing, "adaptive_remeshing");
+
+        // Multithreaded remeshing, with an extra n_threads argument (see remeshing.h)
+        PMP_REGISTER_FUNCTION_NOGIL(parallel_uniform_remeshing, "parallel_uniform_remeshing");
+        PMP_REGISTER_FUNCTION_NOGIL(parallel_adaptive_remeshing, "parallel_adaptive_remeshing");
+
+        // Reusable reference surface for repeated remeshing of one input
+        ROSETTA_REGISTER_CLASS(RemeshingReference)
+            .constructor<>()
+            .constructor<const pmp::SurfaceMesh &>()
+            .method("empty", &RemeshingReference::empty)
+            .method("n_vertices", &RemeshingReference::n_vertices)
+            .method("n_faces", &RemeshingReference::n_faces);
+
+        PMP_REGISTER_FUNCTION_NOGIL(uniform_remeshing_onto, "uniform_remeshing_onto");
+        PMP_REGISTER_FUNCTION_NOGIL(adaptive_remeshing_onto, "adaptive_remeshing_onto");
+
+        // Iteration by iteration remeshing on a background thread, with
+        // cancellation, snapshots and warm starts (see remesher.h)
+        ROSETTA_REGISTER_CLASS(Remesher)
+            .constructor<>()
+            .constructor<const pmp::SurfaceMesh &, const RemeshingReference &, unsigned int>()
+            .method("set_uniform", &Remesher::set_uniform)
+            .method("set_adaptive", &Remesher::set_adaptive)
+            .method("set_warm_start_tolerance", &Remesher::set_warm_start_tolerance)
+            .method("reset", &Remesher::reset)
+            .method("start", &Remesher::start)
+            .method("cancel", &Remesher::cancel)
+            .method("wait", &Remesher::wait)
+            .method("running", &Remesher::running)
+            .method("cancelled", &Remesher::cancelled)
+            .method("warm_started", &Remesher::warm_started)
+            .method("iterations_done", &Remesher::iterations_done)
+            .method("version", &Remesher::version)
+            .method("fetch", &Remesher::fetch);
 
         // Subdivision
-        ROSETTA_REGISTER_FUNCTION(pmp::loop_subdivision);
-        ROSETTA_REGISTER_FUNCTION(pmp::catmull_clark_subdivision);
-        ROSETTA_REGISTER_FUNCTION(pmp::quad_tri_subdivision);
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::loop_subdivision, "loop_subdivision");
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::catmull_clark_subdivision, "catmull_clark_subdivision");
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::quad_tri_subdivision, "quad_tri_subdivision");
+
+        // Multithreaded subdivision, refined mesh allocated once (see subdivision.h)
+        PMP_REGISTER_FUNCTION_NOGIL(parallel_loop_subdivision, "parallel_loop_subdivision");
+        PMP_REGISTER_FUNCTION_NOGIL(parallel_catmull_clark_subdivision,
+                                    "parallel_catmull_clark_subdivision");
+        PMP_REGISTER_FUNCTION_NOGIL(parallel_quad_tri_subdivision,
+                                    "parallel_quad_tri_subdivision");
 
         // Normals
-        ROSETTA_REGISTER_FUNCTION(pmp::vertex_normals);
-        ROSETTA_REGISTER_FUNCTION(pmp::face_normals);
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::vertex_normals, "vertex_normals");
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::face_normals, "face_normals");
 
         // Features
-        ROSETTA_REGISTER_FUNCTION(pmp::detect_features);
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::detect_features, "detect_features");
+        PMP_REGISTER_FUNCTION_NOGIL(parallel_detect_features, "parallel_detect_features");
         ROSETTA_REGISTER_FUNCTION(pmp::clear_features);
 
         // Hole Filling
-        ROSETTA_REGISTER_FUNCTION(pmp::fill_hole);
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::fill_hole, "fill_hole");
 
         // Curvature
-        ROSETTA_REGISTER_FUNCTION(pmp::curvature);
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::curvature, "curvature");
 
         // Shapes (Primitives)
         ROSETTA_REGISTER_FUNCTION(pmp::tetrahedron);
@@ -187,8 +401,8 @@ namespace pmp_rosetta {
         ROSETTA_REGISTER_FUNCTION(pmp::torus);
 
         // Parameterization
-        ROSETTA_REGISTER_FUNCTION(pmp::harmonic_parameterization);
-        ROSETTA_REGISTER_FUNCTION(pmp::lscm_parameterization);
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::harmonic_parameterization, "harmonic_parameterization");
+        PMP_REGISTER_FUNCTION_NOGIL(pmp::lscm_parameterization, "lscm_parameterization");
 
         // Utilities (non-overloaded)
         ROSETTA_REGISTER_FUNCTION(pmp::bounds);
@@ -204,7 +418,8 @@ namespace pmp_rosetta {
         // Triangulation has two overloads:
         //   void triangulate(SurfaceMesh& mesh)
         //   void triangulate(SurfaceMesh& mesh, Face f)
-        ROSETTA_REGISTER_OVERLOADED_FUNCTION(pmp::triangulate, void (*)(pmp::SurfaceMesh &));
+        PMP_REGISTER_OVERLOADED_FUNCTION_NOGIL(pmp::triangulate, "triangulate",
+                                               void (*)(pmp::SurfaceMesh &));
         ROSETTA_REGISTER_OVERLOADED_FUNCTION_AS(pmp::triangulate, "triangulate_face",
                                                 void (*)(pmp::SurfaceMesh &, pmp::Face));
 
@@ -217,20 +432,280 @@ namespace pmp_rosetta {
         // ========================================================================
 
         // void read(SurfaceMesh& mesh, const std::filesystem::path& file)
-        ROSETTA_REGISTER_OVERLOADED_FUNCTION(
-            pmp::read, void (*)(pmp::SurfaceMesh &, const std::filesystem::path &));
+        PMP_REGISTER_OVERLOADED_FUNCTION_NOGIL(
+            pmp::read, "read", void (*)(pmp::SurfaceMesh &, const std::filesystem::path &));
+
+        // Multithreaded OBJ / binary STL / binary PLY reader (see parallel_io.h)
+        PMP_REGISTER_FUNCTION_NOGIL(read_mesh, "read_mesh");
 
         // Load mesh entirely in C++ and return it
-        ROSETTA_REGISTER_FUNCTION(load_mesh);
+        PMP_REGISTER_FUNCTION_NOGIL(load_mesh, "load_mesh");
 
         // Copy mesh in C++
         ROSETTA_REGISTER_FUNCTION(copy_mesh);
 
+        // Copy a mesh into an existing one, reusing its storage (see mesh_copy.h)
+        PMP_REGISTER_FUNCTION_NOGIL(copy_mesh_into, "copy_mesh_into");
+
+        // Multithreaded garbage collection (see garbage_collection.h)
+        PMP_REGISTER_FUNCTION_NOGIL(parallel_garbage_collection, "parallel_garbage_collection");
+
         // void write(const SurfaceMesh& mesh, const std::filesystem::path& file, const IOFlags&
         // flags)
-        ROSETTA_REGISTER_OVERLOADED_FUNCTION(pmp::write, void (*)(const pmp::SurfaceMesh &,
-                                                                  const std::filesystem::path &,
-                                                                  const pmp::IOFlags &));
+        PMP_REGISTER_OVERLOADED_FUNCTION_NOGIL(pmp::write, "write",
+                                               void (*)(const pmp::SurfaceMesh &,
+                                                        const std::filesystem::path &,
+                                                        const pmp::IOFlags &));
+
+        // Binary snapshots: memory-mapped, no parsing on load (see snapshot.h)
+        PMP_REGISTER_FUNCTION_NOGIL(save_snapshot, "save_snapshot");
+        PMP_REGISTER_FUNCTION_NOGIL(open_snapshot, "open_snapshot");
+
+        ROSETTA_REGISTER_CLASS(MeshSnapshot)
+            .constructor<>()
+            .constructor<const std::string &>()
+            .method("n_vertices", &MeshSnapshot::n_vertices)
+            .method("n_edges", &MeshSnapshot::n_edges)
+            .method("n_faces", &MeshSnapshot::n_faces)
+            .method("n_face_indices", &MeshSnapshot::n_face_indices)
+            .method("points_address", &MeshSnapshot::points_address)
+            .method("face_offsets_address", &MeshSnapshot::face_offsets_address)
+            .method("face_indices_address", &MeshSnapshot::face_indices_address)
+            .method("property_names", &MeshSnapshot::property_names)
+            .method("to_mesh", &MeshSnapshot::to_mesh);
+
+        // Quantized read-only storage, decoded by the exporters (see compact_mesh.h)
+        ROSETTA_REGISTER_CLASS(CompactMesh)
+            .constructor<>()
+            .constructor<const pmp::SurfaceMesh &, unsigned int, unsigned int>()
+            .method("n_vertices", &CompactMesh::n_vertices)
+            .method("n_faces", &CompactMesh::n_faces)
+            .method("n_face_indices", &CompactMesh::n_face_indices)
+            .method("is_triangle_mesh", &CompactMesh::is_triangle_mesh)
+            .method("position_bits", &CompactMesh::position_bits)
+            .method("max_error", &CompactMesh::max_error)
+            .method("memory_bytes", &CompactMesh::memory_bytes)
+            .lambda_method_const<std::vector<pmp::Scalar>>(
+                "vertices", [](const CompactMesh &self) {
+                    pmp_rosetta::ProfileScope scope("CompactMesh.vertices");
+                    std::vector<pmp::Scalar>  points(self.n_vertices() * 3);
+                    self.decode_points(points.data(), 0);
+                    return points;
+                })
+            .lambda_method_const<std::vector<pmp::IndexType>>(
+                "indices", [](const CompactMesh &self) {
+                    pmp_rosetta::ProfileScope   scope("CompactMesh.indices");
+                    std::vector<pmp::IndexType> indices(self.n_face_indices());
+                    self.decode_faces(indices.data(), nullptr, 0);
+                    return indices;
+                });
+        PMP_REGISTER_FUNCTION_NOGIL(export_compact_points, "export_compact_points");
+        PMP_REGISTER_FUNCTION_NOGIL(export_compact_faces, "export_compact_faces");
+        PMP_REGISTER_FUNCTION_NOGIL(expand_compact_mesh, "expand_compact_mesh");
+
+        // ========================================================================
+        // Batch processing (see batch.h)
+        // ========================================================================
+
+        ROSETTA_REGISTER_CLASS(BatchPipeline)
+            .constructor<>()
+            .field("triangulate", &BatchPipeline::triangulate)
+            .field("remesh_edge_length", &BatchPipeline::remesh_edge_length)
+            .field("remesh_relative", &BatchPipeline::remesh_relative)
+            .field("remesh_iterations", &BatchPipeline::remesh_iterations)
+            .field("remesh_projection", &BatchPipeline::remesh_projection)
+            .field("decimate_vertices", &BatchPipeline::decimate_vertices)
+            .field("decimate_ratio", &BatchPipeline::decimate_ratio)
+            .field("use_binary", &BatchPipeline::use_binary);
+
+        ROSETTA_REGISTER_CLASS(BatchResult)
+            .constructor<>()
+            .field("input", &BatchResult::input)
+            .field("output", &BatchResult::output)
+            .field("ok", &BatchResult::ok)
+            .field("error", &BatchResult::error)
+            .field("n_vertices", &BatchResult::n_vertices)
+            .field("n_faces", &BatchResult::n_faces)
+            .field("read_seconds", &BatchResult::read_seconds)
+            .field("process_seconds", &BatchResult::process_seconds)
+            .field("write_seconds", &BatchResult::write_seconds)
+            .field("total_seconds", &BatchResult::total_seconds);
+
+        PMP_REGISTER_FUNCTION_NOGIL(process_batch, "process_batch");
+
+        // Out-of-core tiled processing of a large binary STL file (see tiled.h)
+        ROSETTA_REGISTER_CLASS(TiledPipeline)
+            .constructor<>()
+            .field("tile_triangles", &TiledPipeline::tile_triangles)
+            .field("remesh_edge_length", &TiledPipeline::remesh_edge_length)
+            .field("remesh_relative", &TiledPipeline::remesh_relative)
+            .field("remesh_iterations", &TiledPipeline::remesh_iterations)
+            .field("remesh_projection", &TiledPipeline::remesh_projection)
+            .field("decimate_ratio", &TiledPipeline::decimate_ratio)
+            .field("smoothing_iterations", &TiledPipeline::smoothing_iterations)
+            .field("smoothing_uniform", &TiledPipeline::smoothing_uniform)
+            .field("seam_pass", &TiledPipeline::seam_pass);
+
+        ROSETTA_REGISTER_CLASS(TiledReport)
+            .constructor<>()
+            .field("n_tiles", &TiledReport::n_tiles)
+            .field("n_seam_tiles", &TiledReport::n_seam_tiles)
+            .field("n_input_triangles", &TiledReport::n_input_triangles)
+            .field("n_output_triangles", &TiledReport::n_output_triangles)
+            .field("max_tile_triangles", &TiledReport::max_tile_triangles)
+            .field("n_skipped_triangles", &TiledReport::n_skipped_triangles)
+            .field("first_pass_seconds", &TiledReport::first_pass_seconds)
+            .field("seam_pass_seconds", &TiledReport::seam_pass_seconds)
+            .field("total_seconds", &TiledReport::total_seconds);
+
+        PMP_REGISTER_FUNCTION_NOGIL(process_tiled, "process_tiled");
+
+        // ========================================================================
+        // Buffer import/export (see mesh_buffers.h)
+        // ========================================================================
+
+        // Bulk construction from contiguous point/face buffers
+        PMP_REGISTER_FUNCTION_NOGIL(build_mesh, "build_mesh");
+
+        // Compact export into caller-provided buffers (no garbage collection needed)
+        ROSETTA_REGISTER_FUNCTION(n_face_indices);
+        ROSETTA_REGISTER_FUNCTION(export_points);
+        ROSETTA_REGISTER_FUNCTION(export_faces);
+
+        // Multithreaded curvature, normals and areas into caller buffers (see mesh_geometry.h)
+        PMP_REGISTER_FUNCTION_NOGIL(export_curvatures, "export_curvatures");
+        PMP_REGISTER_FUNCTION_NOGIL(export_vertex_normals, "export_vertex_normals");
+        PMP_REGISTER_FUNCTION_NOGIL(export_face_normals, "export_face_normals");
+        PMP_REGISTER_FUNCTION_NOGIL(export_vertex_areas, "export_vertex_areas");
+
+        // Positions, normals and VTK or GL indices for drawing, in one pass (see render_buffers.h)
+        ROSETTA_REGISTER_FUNCTION(n_render_indices);
+        PMP_REGISTER_FUNCTION_NOGIL(export_render_buffers, "export_render_buffers");
+
+        // Named properties as typed arrays (see properties.h)
+        ROSETTA_REGISTER_CLASS(PropertyInfo)
+            .constructor<>()
+            .field("name", &PropertyInfo::name)
+            .field("kind", &PropertyInfo::kind)
+            .field("type", &PropertyInfo::type)
+            .field("components", &PropertyInfo::components)
+            .field("size", &PropertyInfo::size)
+            .field("address", &PropertyInfo::address);
+
+        ROSETTA_REGISTER_FUNCTION(list_properties);
+        ROSETTA_REGISTER_FUNCTION(property_info);
+        ROSETTA_REGISTER_FUNCTION(add_property);
+        ROSETTA_REGISTER_FUNCTION(remove_property);
+        ROSETTA_REGISTER_FUNCTION(read_property);
+        ROSETTA_REGISTER_FUNCTION(write_property);
+
+        // Distance fields for many seed sets, one thread per set (see batch_geodesics.h)
+        PMP_REGISTER_FUNCTION_NOGIL(geodesic_distances, "geodesic_distances");
+
+        // Results cached by input content and arguments (see result_cache.h)
+        ROSETTA_REGISTER_CLASS(ResultCache)
+            .constructor<>()
+            .constructor<const std::string &, std::uint64_t>()
+            .method("directory", &ResultCache::directory)
+            .method("hits", &ResultCache::hits)
+            .method("misses", &ResultCache::misses)
+            .method("contains", &ResultCache::contains)
+            .method("load", &ResultCache::load)
+            .method("store", &ResultCache::store)
+            .method("trim", &ResultCache::trim)
+            .method("clear", &ResultCache::clear);
+
+        PMP_REGISTER_FUNCTION_NOGIL(mesh_content_hash, "mesh_content_hash");
+        PMP_REGISTER_FUNCTION_NOGIL(result_key, "result_key");
+        PMP_REGISTER_FUNCTION_NOGIL(cached_uniform_remeshing, "cached_uniform_remeshing");
+        PMP_REGISTER_FUNCTION_NOGIL(cached_adaptive_remeshing, "cached_adaptive_remeshing");
+        PMP_REGISTER_FUNCTION_NOGIL(cached_decimate, "cached_decimate");
+        PMP_REGISTER_FUNCTION_NOGIL(cached_loop_subdivision, "cached_loop_subdivision");
+        PMP_REGISTER_FUNCTION_NOGIL(cached_catmull_clark_subdivision,
+                                    "cached_catmull_clark_subdivision");
+        PMP_REGISTER_FUNCTION_NOGIL(cached_quad_tri_subdivision, "cached_quad_tri_subdivision");
+
+        // Asynchronous variants of the long-running algorithms, queued on a
+        // shared native executor (see jobs.h)
+        ROSETTA_REGISTER_CLASS(Job)
+            .constructor<>()
+            .method("status", &Job::status)
+            .method("done", &Job::done)
+            .method("ok", &Job::ok)
+            .method("error", &Job::error)
+            .method("wait", &Job::wait)
+            .method("cancel", &Job::cancel)
+            .method("queued_seconds", &Job::queued_seconds)
+            .method("run_seconds", &Job::run_seconds);
+
+        ROSETTA_REGISTER_FUNCTION(set_job_limits);
+        ROSETTA_REGISTER_FUNCTION(job_workers);
+        ROSETTA_REGISTER_FUNCTION(jobs_queued);
+        ROSETTA_REGISTER_FUNCTION(jobs_running);
+        ROSETTA_REGISTER_FUNCTION(job_queue_full);
+        ROSETTA_REGISTER_FUNCTION(job_notify_fd);
+        ROSETTA_REGISTER_FUNCTION(job_decimation_report);
+        ROSETTA_REGISTER_FUNCTION(job_lod_chain);
+
+        PMP_REGISTER_FUNCTION_ASYNC(pmp::decimate, "decimate_async");
+        PMP_REGISTER_FUNCTION_ASYNC(parallel_decimate, "parallel_decimate_async");
+        PMP_REGISTER_FUNCTION_ASYNC(build_lod_chain, "build_lod_chain_async");
+        PMP_REGISTER_FUNCTION_ASYNC(pmp::explicit_smoothing, "explicit_smoothing_async");
+        PMP_REGISTER_FUNCTION_ASYNC(pmp::implicit_smoothing, "implicit_smoothing_async");
+        PMP_REGISTER_FUNCTION_ASYNC(parallel_explicit_smoothing,
+                                    "parallel_explicit_smoothing_async");
+        PMP_REGISTER_FUNCTION_ASYNC(pmp::uniform_remeshing, "uniform_remeshing_async");
+        PMP_REGISTER_FUNCTION_ASYNC(pmp::adaptive_remeshing, "adaptive_remeshing_async");
+        PMP_REGISTER_FUNCTION_ASYNC(parallel_uniform_remeshing, "parallel_uniform_remeshing_async");
+        PMP_REGISTER_FUNCTION_ASYNC(parallel_adaptive_remeshing,
+                                    "parallel_adaptive_remeshing_async");
+        PMP_REGISTER_FUNCTION_ASYNC(uniform_remeshing_onto, "uniform_remeshing_onto_async");
+        PMP_REGISTER_FUNCTION_ASYNC(adaptive_remeshing_onto, "adaptive_remeshing_onto_async");
+        PMP_REGISTER_FUNCTION_ASYNC(pmp::loop_subdivision, "loop_subdivision_async");
+        PMP_REGISTER_FUNCTION_ASYNC(pmp::catmull_clark_subdivision,
+                                    "catmull_clark_subdivision_async");
+        PMP_REGISTER_FUNCTION_ASYNC(pmp::quad_tri_subdivision, "quad_tri_subdivision_async");
+        PMP_REGISTER_FUNCTION_ASYNC(parallel_loop_subdivision, "parallel_loop_subdivision_async");
+        PMP_REGISTER_FUNCTION_ASYNC(parallel_catmull_clark_subdivision,
+                                    "parallel_catmull_clark_subdivision_async");
+        PMP_REGISTER_FUNCTION_ASYNC(parallel_quad_tri_subdivision,
+                                    "parallel_quad_tri_subdivision_async");
+        PMP_REGISTER_FUNCTION_ASYNC(read_mesh, "read_mesh_async");
+        PMP_REGISTER_FUNCTION_ASYNC(load_mesh, "load_mesh_async");
+
+        // Opt-in timers and counters of the registered functions (see profiling.h)
+        ROSETTA_REGISTER_CLASS(ProfileEntry)
+            .constructor<>()
+            .field("name", &ProfileEntry::name)
+            .field("is_counter", &ProfileEntry::is_counter)
+            .field("calls", &ProfileEntry::calls)
+            .field("total_seconds", &ProfileEntry::total_seconds)
+            .field("min_seconds", &ProfileEntry::min_seconds)
+            .field("max_seconds", &ProfileEntry::max_seconds)
+            .field("count", &ProfileEntry::count);
+
+        ROSETTA_REGISTER_FUNCTION(set_profiling);
+        ROSETTA_REGISTER_FUNCTION(profiling_enabled);
+        ROSETTA_REGISTER_FUNCTION(reset_profile);
+        ROSETTA_REGISTER_FUNCTION(profile_report);
+        PMP_REGISTER_FUNCTION_NOGIL(write_chrome_trace, "write_chrome_trace");
+
+        // Scalar and index sizes for the zero-copy buffer views
+        ROSETTA_REGISTER_FUNCTION(scalar_size);
+        ROSETTA_REGISTER_FUNCTION(index_size);
+
+        // ========================================================================
+        // Spatial queries (see mesh_bvh.h)
+        // ========================================================================
+
+        ROSETTA_REGISTER_CLASS(MeshBVH)
+            .constructor<>()
+            .constructor<const pmp::SurfaceMesh &>()
+            .method("empty", &MeshBVH::empty)
+            .method("n_triangles", &MeshBVH::n_triangles)
+            .method("closest_points", &MeshBVH::closest_points)
+            .method("ray_intersect", &MeshBVH::ray_intersect)
+            .method("winding_numbers", &MeshBVH::winding_numbers);
     }
 
 } // namespace pmp_rosetta
@@ -0,0 +1,322 @@
+// ============================================================================
+// Opt-in profiling of the registered functions
+// ============================================================================
+// While profiling is on, ProfileScope records the wall-clock span of a block
+// and profile_count() adds to a named counter. Every function registered
+// with PMP_REGISTER_FUNCTION_NOGIL gets a scope under its PMP_PROFILE_NAME;
+// the multithreaded kernels add scopes for their phases (e.g.
+// "remeshing.split", "remeshing.projection") and counters for their work
+// ("remeshing.splits").
+//
+// Events go to a buffer owned by the recording thread: appending is a store
+// and a release increment, with no lock and no sharing between threads. The
+// buffers are only read by profile_report() and write_chrome_trace(), and
+// cleared by reset_profile(); call these while no profiled function runs.
+// With profiling off, a scope costs one relaxed atomic load.
+//
+//   set_profiling(true);
+//   ... calls ...
+//   for (const auto &e : profile_report()) { e.name, e.calls, e.total_seconds }
+//   write_chrome_trace("trace.json");  // chrome://tracing or ui.perfetto.dev
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <pmp/exceptions.h>
+
+namespace pmp_rosetta {
+
+    namespace detail {
+
+        struct ProfileEvent {
+            const char  *name;
+            std::int64_t start_ns;
+            std::int64_t value; // duration in ns for a scope, increment for a counter
+            bool         is_counter;
+        };
+
+        // Append-only event log of one thread, in fixed-size chunks that
+        // never move, so the owner appends while a reader walks the
+        // published prefix
+        class ProfileBuffer {
+        public:
+            static constexpr std::size_t chunk_size = 4096;
+            static constexpr std::size_t max_chunks = 4096;
+
+            explicit ProfileBuffer(std::uint32_t thread_index) : thread_index_(thread_index) {}
+
+            ~ProfileBuffer() {
+                for (auto &c : chunks_) {
+                    delete[] c.load(std::memory_order_relaxed);
+                }
+            }
+
+            ProfileBuffer(const ProfileBuffer &)            = delete;
+            ProfileBuffer &operator=(const ProfileBuffer &) = delete;
+
+            std::uint32_t thread_index() const { return thread_index_; }
+            std::size_t   n_dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+            void push(const ProfileEvent &event) {
+                const auto n = size_.load(std::memory_order_relaxed);
+                const auto c = n / chunk_size;
+                if (c >= max_chunks) {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                auto *chunk = chunks_[c].load(std::memory_order_relaxed);
+                if (!chunk) {
+                    chunk = new ProfileEvent[chunk_size];
+                    chunks_[c].store(chunk, std::memory_order_release);
+                }
+                chunk[n % chunk_size] = event;
+                size_.store(n + 1, std::memory_order_release);
+            }
+
+            template <typename F> void for_each(F &&f) const {
+                const auto n = size_.load(std::memory_order_acquire);
+                for (std::size_t i = 0; i < n; ++i) {
+                    f(chunks_[i / chunk_size].load(std::memory_order_acquire)[i % chunk_size]);
+                }
+            }
+
+            // Chunks are kept for reuse
+            void clear() {
+                size_.store(0, std::memory_order_release);
+                dropped_.store(0, std::memory_order_relaxed);
+            }
+
+        private:
+            std::uint32_t                                       thread_index_;
+            std::array<std::atomic<ProfileEvent *>, max_chunks> chunks_{};
+            std::atomic<std::size_t>                            size_{0};
+            std::atomic<std::size_t>                            dropped_{0};
+        };
+
+        struct ProfileState {
+            std::atomic<bool>                           enabled{false};
+            std::chrono::steady_clock::time_point       epoch = std::chrono::steady_clock::now();
+            std::mutex                                  mutex; // guards buffers
+            std::vector<std::unique_ptr<ProfileBuffer>> buffers;
+        };
+
+        inline ProfileState &profile_state() {
+            static ProfileState state;
+            return state;
+        }
+
+        // Buffers outlive their threads, so that events of a finished
+        // thread still show in the report
+        inline ProfileBuffer &thread_profile_buffer() {
+            thread_local ProfileBuffer *buffer = [] {
+                auto                       &s = profile_state();
+                std::lock_guard<std::mutex> lock(s.mutex);
+                s.buffers.push_back(
+                    std::make_unique<ProfileBuffer>(std::uint32_t(s.buffers.size())));
+                return s.buffers.back().get();
+            }();
+            return *buffer;
+        }
+
+        inline std::int64_t profile_now_ns() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now() - profile_state().epoch)
+                .count();
+        }
+
+        // Wall-clock time since start, for the timings of reports
+        inline double seconds_since(std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                .count();
+        }
+
+        inline std::string json_escaped(const std::string &s) {
+            std::string out;
+            for (char c : s) {
+                if (c == '"' || c == '\\') {
+                    out += '\\';
+                }
+                out += c;
+            }
+            return out;
+        }
+
+    } // namespace detail
+
+    inline bool profiling_on() {
+        return detail::profile_state().enabled.load(std::memory_order_relaxed);
+    }
+
+    // Record the span of the enclosing block under `name`, a string literal
+    // (only the pointer is stored)
+    class ProfileScope {
+    public:
+        explicit ProfileScope(const char *name) : name_(name && profiling_on() ? name : nullptr) {
+            if (name_) {
+                start_ = detail::profile_now_ns();
+            }
+        }
+
+        ~ProfileScope() {
+            if (name_) {
+                detail::thread_profile_buffer().push(
+                    {name_, start_, detail::profile_now_ns() - start_, false});
+            }
+        }
+
+        ProfileScope(const ProfileScope &)            = delete;
+        ProfileScope &operator=(const ProfileScope &) = delete;
+
+    private:
+        const char  *name_;
+        std::int64_t start_ = 0;
+    };
+
+    // Add n to the counter `name`, a string literal
+    inline void profile_count(const char *name, std::int64_t n) {
+        if (profiling_on()) {
+            detail::thread_profile_buffer().push({name, detail::profile_now_ns(), n, true});
+        }
+    }
+
+    // Name F is timed under, given by PMP_PROFILE_NAME (see gil.h); null: not timed
+    template <auto F> inline constexpr const char *profile_name = nullptr;
+
+} // namespace pmp_rosetta
+
+// Totals of one scope or counter over the recorded events
+struct ProfileEntry {
+    std::string  name;
+    bool         is_counter    = false;
+    std::size_t  calls         = 0; // scopes closed, or counter increments
+    double       total_seconds = 0;
+    double       min_seconds   = 0;
+    double       max_seconds   = 0;
+    std::int64_t count         = 0; // sum of the counter increments
+};
+
+// Turn recording on or off. Events recorded so far are kept.
+inline void set_profiling(bool enabled) {
+    pmp_rosetta::detail::profile_state().enabled.store(enabled, std::memory_order_relaxed);
+}
+
+inline bool profiling_enabled() {
+    return pmp_rosetta::profiling_on();
+}
+
+// Drop the recorded events
+inline void reset_profile() {
+    auto                       &s = pmp_rosetta::detail::profile_state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+    for (auto &b : s.buffers) {
+        b->clear();
+    }
+}
+
+// One entry per scope or counter name, by decreasing total time (counters
+// last). Events past 16M per thread are dropped and counted as
+// "profile.dropped_events".
+inline std::vector<ProfileEntry> profile_report() {
+    auto                       &s = pmp_rosetta::detail::profile_state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    std::map<std::string, ProfileEntry> entries;
+    std::size_t                         n_dropped = 0;
+    for (const auto &b : s.buffers) {
+        n_dropped += b->n_dropped();
+        b->for_each([&](const pmp_rosetta::detail::ProfileEvent &e) {
+            auto &entry = entries[e.name];
+            entry.name  = e.name;
+            if (e.is_counter) {
+                entry.is_counter = true;
+                entry.count += e.value;
+            } else {
+                const double t      = double(e.value) * 1e-9;
+                entry.min_seconds   = entry.calls == 0 ? t : std::min(entry.min_seconds, t);
+                entry.max_seconds   = std::max(entry.max_seconds, t);
+                entry.total_seconds += t;
+            }
+            ++entry.calls;
+        });
+    }
+
+    if (n_dropped > 0) {
+        auto &entry      = entries["profile.dropped_events"];
+        entry.name       = "profile.dropped_events";
+        entry.is_counter = true;
+        entry.calls      = 1;
+        entry.count      = std::int64_t(n_dropped);
+    }
+
+    std::vector<ProfileEntry> report;
+    for (auto &[name, entry] : entries) {
+        report.push_back(std::move(entry));
+    }
+    std::stable_sort(report.begin(), report.end(),
+                     [](const ProfileEntry &a, const ProfileEntry &b) {
+                         if (a.is_counter != b.is_counter) {
+                             return !a.is_counter;
+                         }
+                         return a.total_seconds > b.total_seconds;
+                     });
+    return report;
+}
+
+// Write the recorded events in the Chrome trace event format: scopes as
+// complete events on the thread that ran them, counters as running totals.
+// Returns the number of events written.
+inline std::size_t write_chrome_trace(const std::string &path) {
+    using pmp_rosetta::detail::json_escaped;
+
+    auto                       &s = pmp_rosetta::detail::profile_state();
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    std::ofstream out(path);
+    if (!out) {
+        throw pmp::IOException("Failed to open file: " + path);
+    }
+
+    // Counter totals need the events of all threads in time order
+    struct TraceEvent {
+        pmp_rosetta::detail::ProfileEvent event;
+        std::uint32_t                     tid;
+    };
+    std::vector<TraceEvent> events;
+    for (const auto &b : s.buffers) {
+        b->for_each([&](const pmp_rosetta::detail::ProfileEvent &e) {
+            events.push_back({e, b->thread_index()});
+        });
+    }
+    std::stable_sort(events.begin(), events.end(), [](const TraceEvent &a, const TraceEvent &b) {
+        return a.event.start_ns < b.event.start_ns;
+    });
+
+    std::map<std::string, std::int64_t> totals;
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const auto &[e, tid] = events[i];
+        out << (i ? ",\n" : "\n") << "{\"name\":\"" << json_escaped(e.name)
+            << "\",\"pid\":1,\"tid\":" << tid << ",\"ts\":" << double(e.start_ns) * 1e-3;
+        if (e.is_counter) {
+            out << ",\"ph\":\"C\",\"args\":{\"value\":" << (totals[e.name] += e.value) << "}}";
+        } else {
+            out << ",\"ph\":\"X\",\"dur\":" << double(e.value) * 1e-3 << "}";
+        }
+    }
+    out << "\n]}\n";
+    if (!out) {
+        throw pmp::IOException("Failed to write file: " + path);
+    }
+    return events.size();
+}
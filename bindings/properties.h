@@ -0,0 +1,267 @@
+// ============================================================================
+// Typed access to named mesh properties
+// ============================================================================
+// Any vertex ('v'), halfedge ('h'), edge ('e') or face ('f') property of a
+// type stored in snapshots (bool, int, unsigned int, float, double and
+// 2/3-vectors of float or double) can be listed, viewed in place by address,
+// copied in or out of a caller-owned buffer, created and removed. Arrays
+// cover every element slot, deleted ones included, like points_view();
+// values are laid out as `components` contiguous numbers per element.
+//
+// bool properties are bit-packed by std::vector<bool> and have no address:
+// use read_property()/write_property(), which convert to one byte per value.
+// Addresses are valid until the next topology change or garbage collection.
+// ============================================================================
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "mesh_buffers.h"
+#include "snapshot.h"
+
+// Layout of one property
+struct PropertyInfo {
+    std::string    name;
+    std::string    kind;           // "v", "h", "e" or "f"
+    std::string    type;           // "bool", "int32", "uint32", "float32" or "float64"
+    unsigned int   components = 1; // numbers per element
+    std::size_t    size       = 0; // number of elements (slots)
+    std::uintptr_t address    = 0; // 0 for bool properties
+};
+
+namespace pmp_rosetta::detail {
+
+    inline std::string type_name(SnapshotType type) {
+        switch (type) {
+            case SnapshotType::Float32:
+                return "float32";
+            case SnapshotType::Float64:
+                return "float64";
+            case SnapshotType::Int32:
+                return "int32";
+            case SnapshotType::UInt32:
+                return "uint32";
+            case SnapshotType::Bool:
+                return "bool";
+            case SnapshotType::UInt64:
+                return "uint64";
+        }
+        return "unknown";
+    }
+
+    inline char property_kind(const std::string &kind) {
+        if (kind.size() != 1 || std::string("vhef").find(kind[0]) == std::string::npos) {
+            throw pmp::InvalidInputException("unknown property kind '" + kind +
+                                             "', expected 'v', 'h', 'e' or 'f'");
+        }
+        return kind[0];
+    }
+
+    template <typename T>
+    inline PropertyInfo describe_property(const std::string &name, char kind,
+                                          std::vector<T> &values) {
+        using Traits = SnapshotTraits<T>;
+        PropertyInfo info;
+        info.name       = name;
+        info.kind       = std::string(1, kind);
+        info.type       = type_name(Traits::type);
+        info.components = Traits::components;
+        info.size       = values.size();
+        if constexpr (!std::is_same_v<T, bool>) {
+            info.address = reinterpret_cast<std::uintptr_t>(values.empty() ? nullptr
+                                                                            : values.data());
+        }
+        return info;
+    }
+
+    // Call f(values) with the storage of an existing property of a supported
+    // type; throws if there is none
+    template <typename F>
+    inline void visit_property(const pmp::SurfaceMesh &mesh, char kind, const std::string &name,
+                               F &&f) {
+        const bool found = find_type(SnapshotTypes{}, [&](auto tag) {
+            using T      = typename decltype(tag)::type;
+            auto *values = property_vector<T>(mesh, kind, name);
+            if (!values) {
+                return false;
+            }
+            f(*values);
+            return true;
+        });
+        if (!found) {
+            throw pmp::InvalidInputException("no property '" + name + "' of a supported type");
+        }
+    }
+
+    // Call f(std::type_identity<T>{}) for the supported type named `type`
+    // with `components` numbers per element
+    template <typename F>
+    inline void visit_type(const std::string &type, unsigned int components, F &&f) {
+        const bool found = find_type(SnapshotTypes{}, [&](auto tag) {
+            using Traits = SnapshotTraits<typename decltype(tag)::type>;
+            if (type_name(Traits::type) != type || Traits::components != components) {
+                return false;
+            }
+            f(tag);
+            return true;
+        });
+        if (!found) {
+            throw pmp::InvalidInputException("unsupported property type " + type + " x" +
+                                             std::to_string(components));
+        }
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Names of the properties of one element kind, including built-in ones
+inline std::vector<std::string> list_properties(const pmp::SurfaceMesh &mesh,
+                                                const std::string      &kind) {
+    using namespace pmp_rosetta::detail;
+    return property_names(mesh, property_kind(kind));
+}
+
+inline PropertyInfo property_info(pmp::SurfaceMesh &mesh, const std::string &kind,
+                                  const std::string &name) {
+    using namespace pmp_rosetta::detail;
+
+    const char   k = property_kind(kind);
+    PropertyInfo info;
+    visit_property(mesh, k, name,
+                   [&](auto &values) { info = describe_property(name, k, values); });
+    return info;
+}
+
+// Add a property of the given type and number of components, or return the
+// existing one if it has exactly that type. Values start zeroed. The names of
+// built-in properties are reserved, except "v:point" for the positions.
+inline PropertyInfo add_property(pmp::SurfaceMesh &mesh, const std::string &kind,
+                                 const std::string &name, const std::string &type,
+                                 unsigned int components) {
+    using namespace pmp_rosetta::detail;
+
+    const char k = property_kind(kind);
+    if (is_builtin_property(name) && !(k == 'v' && name == "v:point")) {
+        throw pmp::InvalidInputException("cannot add or write built-in property '" + name + "'");
+    }
+    PropertyInfo info;
+    visit_type(type, components, [&](auto tag) {
+        using T = typename decltype(tag)::type;
+        for (const auto &existing : property_names(mesh, k)) {
+            if (existing == name && !property_vector<T>(mesh, k, name)) {
+                throw pmp::InvalidInputException("property '" + name +
+                                                 "' already exists with another type");
+            }
+        }
+        info = describe_property(name, k, make_property_vector<T>(mesh, k, name));
+    });
+    return info;
+}
+
+// Remove a custom property. Returns false if there is no such property;
+// built-in properties cannot be removed.
+inline bool remove_property(pmp::SurfaceMesh &mesh, const std::string &kind,
+                            const std::string &name) {
+    using namespace pmp_rosetta::detail;
+
+    const char k = property_kind(kind);
+    if (is_builtin_property(name)) {
+        throw pmp::InvalidInputException("cannot remove built-in property '" + name + "'");
+    }
+    bool removed = false;
+    find_type(SnapshotTypes{}, [&](auto tag) {
+        using T = typename decltype(tag)::type;
+        switch (k) {
+            case 'v':
+                if (auto p = mesh.get_vertex_property<T>(name)) {
+                    mesh.remove_vertex_property(p);
+                    removed = true;
+                }
+                break;
+            case 'h':
+                if (auto p = mesh.get_halfedge_property<T>(name)) {
+                    mesh.remove_halfedge_property(p);
+                    removed = true;
+                }
+                break;
+            case 'e':
+                if (auto p = mesh.get_edge_property<T>(name)) {
+                    mesh.remove_edge_property(p);
+                    removed = true;
+                }
+                break;
+            case 'f':
+                if (auto p = mesh.get_face_property<T>(name)) {
+                    mesh.remove_face_property(p);
+                    removed = true;
+                }
+                break;
+        }
+        return removed;
+    });
+    return removed;
+}
+
+// Copy a property into a caller buffer of size * components values of its
+// type (one byte per value for bool). Returns the number of elements copied.
+inline std::size_t read_property(const pmp::SurfaceMesh &mesh, const std::string &kind,
+                                 const std::string &name, std::uintptr_t out,
+                                 std::size_t capacity) {
+    using namespace pmp_rosetta::detail;
+
+    std::size_t n = 0;
+    visit_property(mesh, property_kind(kind), name, [&](auto &values) {
+        using T      = typename std::decay_t<decltype(values)>::value_type;
+        using Traits = SnapshotTraits<T>;
+        check_capacity(values.size() * Traits::components, capacity, "read_property");
+        if constexpr (std::is_same_v<T, bool>) {
+            auto *dst = buffer_cast<std::uint8_t>(out, capacity, "read_property");
+            for (std::size_t i = 0; i < values.size(); ++i) {
+                dst[i] = values[i] ? 1 : 0;
+            }
+        } else if (!values.empty()) {
+            std::memcpy(buffer_cast<void>(out, capacity, "read_property"), values.data(),
+                        values.size() * sizeof(T));
+        }
+        n = values.size();
+    });
+    return n;
+}
+
+// Create (see add_property()) and fill a property from a caller buffer of
+// n_elements * components values, n_elements being the number of slots of
+// that kind (e.g. mesh.vertices_size()). Returns its layout.
+inline PropertyInfo write_property(pmp::SurfaceMesh &mesh, const std::string &kind,
+                                   const std::string &name, const std::string &type,
+                                   unsigned int components, std::uintptr_t data,
+                                   std::size_t n_elements) {
+    using namespace pmp_rosetta::detail;
+
+    auto info = add_property(mesh, kind, name, type, components);
+    if (n_elements != info.size) {
+        throw pmp::InvalidInputException("write_property: " + std::to_string(n_elements) +
+                                         " elements given, the mesh has " +
+                                         std::to_string(info.size));
+    }
+    visit_type(type, components, [&](auto tag) {
+        using T      = typename decltype(tag)::type;
+        auto &values = make_property_vector<T>(mesh, info.kind[0], name);
+        if constexpr (std::is_same_v<T, bool>) {
+            const auto *src = buffer_cast<const std::uint8_t>(data, n_elements, "write_property");
+            for (std::size_t i = 0; i < n_elements; ++i) {
+                values[i] = src[i] != 0;
+            }
+        } else if (n_elements > 0) {
+            std::memcpy(static_cast<void *>(values.data()),
+                        buffer_cast<const void>(data, n_elements, "write_property"),
+                        n_elements * sizeof(T));
+        }
+    });
+    return info;
+}
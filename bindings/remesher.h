@@ -0,0 +1,301 @@
+// ============================================================================
+// Progressive remeshing on a background thread
+// ============================================================================
+// A Remesher owns a working copy of a source mesh and runs the iterations of
+// the multithreaded remeshing of remeshing.h on a native thread, one at a
+// time, so that a caller (a UI event loop) stays free while it runs:
+// - start() returns at once; running(), iterations_done() and wait() follow
+//   the run, cancel() stops it at the next iteration boundary;
+// - after every iteration the working mesh is copied into a published
+//   snapshot, which fetch() copies into a caller mesh with its version;
+// - a run whose parameters are within warm_start_tolerance of those of the
+//   previous run continues from its result instead of from the source, so a
+//   small change of edge length needs a few iterations instead of a full run.
+//
+//   Remesher r(source, reference, 0);
+//   r.set_uniform(0.01);
+//   r.start(10, 3);
+//   while (r.running()) { if (r.version() != seen) seen = r.fetch(view); ... }
+//
+// Copies share the same working mesh and thread. Parameters can only change
+// while no run is in progress.
+// ============================================================================
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "garbage_collection.h"
+#include "gil.h"
+#include "mesh_copy.h"
+#include "profiling.h"
+#include "remeshing.h"
+
+namespace pmp_rosetta::detail {
+
+    struct RemeshingParameters {
+        bool        uniform         = true;
+        pmp::Scalar edge_length     = 0;
+        pmp::Scalar min_edge_length = 0;
+        pmp::Scalar max_edge_length = 0;
+        pmp::Scalar approx_error    = 0;
+    };
+
+    // Whether b is within a relative tolerance of a, parameter by parameter
+    inline bool close_parameters(const RemeshingParameters &a, const RemeshingParameters &b,
+                                 double tolerance) {
+        const auto close = [&](pmp::Scalar x, pmp::Scalar y) {
+            return std::abs(double(y) - double(x)) <= tolerance * std::abs(double(x));
+        };
+        if (a.uniform != b.uniform) {
+            return false;
+        }
+        return a.uniform ? close(a.edge_length, b.edge_length)
+                         : close(a.min_edge_length, b.min_edge_length) &&
+                               close(a.max_edge_length, b.max_edge_length) &&
+                               close(a.approx_error, b.approx_error);
+    }
+
+    struct RemesherState {
+        pmp::SurfaceMesh   source;
+        RemeshingReference reference;
+        unsigned int       n_threads = 0;
+
+        // Only touched by the worker while a run is in progress
+        pmp::SurfaceMesh    mesh;
+        bool                has_result = false;
+        RemeshingParameters previous;
+
+        RemeshingParameters parameters;
+        double              warm_start_tolerance = 0.25;
+        bool                warm                 = false;
+
+        std::atomic<bool>         running{false};
+        std::atomic<bool>         cancelled{false};
+        std::atomic<unsigned int> iterations_done{0};
+
+        mutable std::mutex      mutex; // guards the members below
+        std::condition_variable finished;
+        pmp::SurfaceMesh        published;
+        std::size_t             version = 0;
+        std::exception_ptr      error;
+
+        std::thread worker;
+
+        ~RemesherState() {
+            cancelled = true;
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+
+        void publish() {
+            ProfileScope                scope("remesher.publish");
+            std::lock_guard<std::mutex> lock(mutex);
+            published.assign(mesh);
+            ++version;
+        }
+
+        void run(unsigned int iterations) {
+            try {
+                if (!warm) {
+                    copy_mesh_into(mesh, source);
+                } else if (mesh.has_garbage()) {
+                    // Collapses of the previous run, not to pile up
+                    parallel_garbage_collection(mesh, n_threads);
+                }
+                ParallelRemeshing remeshing(mesh, n_threads, reference);
+                const auto       &p = parameters;
+                if (p.uniform) {
+                    remeshing.begin_uniform(p.edge_length, true);
+                } else {
+                    remeshing.begin_adaptive(p.min_edge_length, p.max_edge_length, p.approx_error,
+                                             true);
+                }
+                for (unsigned int i = 0; i < iterations && !cancelled; ++i) {
+                    remeshing.iterate();
+                    ++iterations_done;
+                    publish();
+                }
+                remeshing.finish();
+                has_result = true;
+                previous   = p;
+                publish();
+            } catch (...) {
+                // The working mesh may be half updated: start over next time
+                has_result = false;
+                std::lock_guard<std::mutex> lock(mutex);
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            running = false;
+            finished.notify_all();
+        }
+    };
+
+} // namespace pmp_rosetta::detail
+
+class Remesher {
+public:
+    Remesher() = default;
+
+    // Remesh copies of source, a triangle mesh, projecting onto reference
+    // (built from source when empty), over n_threads threads (0: all cores)
+    Remesher(const pmp::SurfaceMesh &source, const RemeshingReference &reference,
+             unsigned int n_threads)
+        : state_(std::make_shared<pmp_rosetta::detail::RemesherState>()) {
+        if (!source.is_triangle_mesh()) {
+            throw pmp::InvalidInputException("Input is not a triangle mesh!");
+        }
+        auto &s     = *state_;
+        s.source    = source;
+        s.reference = reference.empty() ? RemeshingReference(source) : reference;
+        s.n_threads = n_threads;
+        s.published.assign(source);
+    }
+
+    // Parameters of the next runs
+    void set_uniform(pmp::Scalar edge_length) {
+        auto &p       = idle_state("set_uniform").parameters;
+        p             = {};
+        p.edge_length = edge_length;
+    }
+
+    void set_adaptive(pmp::Scalar min_edge_length, pmp::Scalar max_edge_length,
+                      pmp::Scalar approx_error) {
+        auto &p           = idle_state("set_adaptive").parameters;
+        p                 = {};
+        p.uniform         = false;
+        p.min_edge_length = min_edge_length;
+        p.max_edge_length = max_edge_length;
+        p.approx_error    = approx_error;
+    }
+
+    // Largest relative parameter change a run continues the previous result
+    // for (default 0.25; 0: only for identical parameters)
+    void set_warm_start_tolerance(double tolerance) {
+        idle_state("set_warm_start_tolerance").warm_start_tolerance = tolerance;
+    }
+
+    // Start the next run from the source
+    void reset() { idle_state("reset").has_result = false; }
+
+    // Run `iterations` iterations on the background thread, or
+    // warm_iterations when continuing the previous result, then flip away
+    // the caps; returns at once. Rethrows the error of the previous run.
+    void start(unsigned int iterations, unsigned int warm_iterations) {
+        auto &s = idle_state("start");
+        if (s.worker.joinable()) {
+            s.worker.join();
+        }
+        rethrow_error();
+        if (s.parameters.uniform ? !(s.parameters.edge_length > 0)
+                                 : !(s.parameters.min_edge_length > 0)) {
+            throw pmp::InvalidInputException("Remesher: set_uniform() or set_adaptive() first");
+        }
+
+        s.warm = s.has_result &&
+                 pmp_rosetta::detail::close_parameters(s.previous, s.parameters,
+                                                       s.warm_start_tolerance);
+        const auto n      = s.warm ? warm_iterations : iterations;
+        s.cancelled       = false;
+        s.iterations_done = 0;
+        s.running         = true;
+        s.worker          = std::thread([&s, n] { s.run(n); });
+    }
+
+    // Stop the run after its current iteration; its result so far is kept
+    void cancel() {
+        if (state_) {
+            state_->cancelled = true;
+        }
+    }
+
+    // Block until the run is over, for at most timeout_seconds when that is
+    // non-negative, without holding the Python GIL. Returns whether it is
+    // over; rethrows its error.
+    bool wait(double timeout_seconds) {
+        if (!state_) {
+            return true;
+        }
+        auto &s = *state_;
+        {
+            pmp_rosetta::ScopedGILRelease release;
+            std::unique_lock<std::mutex>  lock(s.mutex);
+            const auto                    over = [&] { return !s.running; };
+            if (timeout_seconds < 0) {
+                s.finished.wait(lock, over);
+            } else if (!s.finished.wait_for(
+                           lock, std::chrono::duration<double>(timeout_seconds), over)) {
+                return false;
+            }
+        }
+        rethrow_error();
+        return true;
+    }
+
+    bool running() const { return state_ && state_->running; }
+    bool cancelled() const { return state_ && state_->cancelled; }
+
+    // Whether the last run continued from the result of the previous one
+    bool warm_started() const { return state_ && state_->warm; }
+
+    unsigned int iterations_done() const { return state_ ? state_->iterations_done.load() : 0; }
+
+    // Number of snapshots published so far; 0 is the source itself
+    std::size_t version() const {
+        if (!state_) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        return state_->version;
+    }
+
+    // Copy the latest snapshot (connectivity and positions; it may hold
+    // deleted elements) into target, and return its version
+    std::size_t fetch(pmp::SurfaceMesh &target) const {
+        if (!state_) {
+            throw pmp::InvalidInputException("Remesher: no source mesh");
+        }
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        target.assign(state_->published);
+        return state_->version;
+    }
+
+private:
+    pmp_rosetta::detail::RemesherState &idle_state(const char *what) {
+        if (!state_) {
+            throw pmp::InvalidInputException(std::string("Remesher::") + what +
+                                             ": no source mesh");
+        }
+        if (state_->running) {
+            throw pmp::InvalidInputException(std::string("Remesher::") + what +
+                                             ": a run is in progress");
+        }
+        return *state_;
+    }
+
+    void rethrow_error() {
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex);
+            std::swap(error, state_->error);
+        }
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    std::shared_ptr<pmp_rosetta::detail::RemesherState> state_;
+};
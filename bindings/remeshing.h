@@ -0,0 +1,819 @@
+// ============================================================================
+// Multithreaded uniform and adaptive remeshing
+// ============================================================================
+// Same algorithm as pmp::uniform_remeshing() / pmp::adaptive_remeshing()
+// (Botsch & Kobbelt, "A Remeshing Approach to Multiresolution Modeling"),
+// with the per-vertex phases run over a thread pool:
+// - tangential smoothing: every vertex update only reads the current
+//   positions, so all updates are computed concurrently, then applied;
+// - back-projection onto the reference surface through a TriangleBVH;
+// - vertex normals and the adaptive sizing field.
+// Split, collapse and flip change the connectivity and stay sequential.
+//
+// The reference surface (copy, normals, BVH, curvature) can be built once as
+// a RemeshingReference and reused by any number of remeshing calls.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <numbers>
+#include <utility>
+#include <vector>
+
+#include <pmp/algorithms/curvature.h>
+#include <pmp/algorithms/normals.h>
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "bvh.h"
+#include "parallel.h"
+#include "profiling.h"
+
+namespace pmp_rosetta::detail {
+
+    // Barycentric coordinates of p with respect to the triangle (u, v, w)
+    inline pmp::Point barycentric(const pmp::Point &p, const pmp::Point &u, const pmp::Point &v,
+                                  const pmp::Point &w) {
+        const pmp::Point  e0 = v - u, e1 = w - u, e2 = p - u;
+        const pmp::Scalar d00 = dot(e0, e0), d01 = dot(e0, e1), d11 = dot(e1, e1);
+        const pmp::Scalar d20 = dot(e2, e0), d21 = dot(e2, e1);
+        const pmp::Scalar denom = d00 * d11 - d01 * d01;
+        if (std::abs(denom) < std::numeric_limits<pmp::Scalar>::min()) {
+            const pmp::Scalar third = pmp::Scalar(1) / 3;
+            return pmp::Point(third, third, third);
+        }
+        const pmp::Scalar b1 = (d11 * d20 - d01 * d21) / denom;
+        const pmp::Scalar b2 = (d00 * d21 - d01 * d20) / denom;
+        return pmp::Point(1 - b1 - b2, b1, b2);
+    }
+
+    // Edge length giving an approximation error of `error` on a sphere of
+    // curvature c, clamped to [min_length, max_length]
+    inline pmp::Scalar sizing_from_curvature(pmp::Scalar c, pmp::Scalar min_length,
+                                             pmp::Scalar max_length, pmp::Scalar error) {
+        pmp::Scalar h = max_length;
+        if (c > 0 && error < 1 / c) {
+            // see mathworld: "circle segment" and "equilateral triangle"
+            h = std::sqrt(6 * error / c - 3 * error * error);
+        }
+        return std::clamp(h, min_length, max_length);
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Reference surface of a remeshing with projection: a copy of the input
+// geometry with its vertex normals, a TriangleBVH over its faces and, on first
+// use by adaptive remeshing, its curvature. Building one and passing it to
+// uniform_remeshing_onto() / adaptive_remeshing_onto() reuses all of this
+// across repeated remeshings of the same input. Copies share the same
+// immutable data, so one reference can serve concurrent calls.
+class RemeshingReference {
+public:
+    // Closest point on the reference surface, and how to interpolate there
+    struct Sample {
+        pmp::Point                 point;
+        pmp::Normal                normal;
+        std::array<pmp::Vertex, 3> corners;
+        pmp::Point                 weights;
+    };
+
+    RemeshingReference() = default;
+
+    explicit RemeshingReference(const pmp::SurfaceMesh &mesh) : data_(std::make_shared<Data>()) {
+        auto &d = *data_;
+        d.mesh.assign(mesh);
+        d.bvh = pmp_rosetta::TriangleBVH(d.mesh);
+
+        d.normals.resize(d.mesh.vertices_size());
+        d.feature.assign(d.mesh.vertices_size(), 0);
+        auto feature = mesh.get_vertex_property<bool>("v:feature");
+        pmp_rosetta::parallel_for(0, d.mesh.vertices_size(), [&](std::size_t i) {
+            const pmp::Vertex v(static_cast<pmp::IndexType>(i));
+            if (!d.mesh.is_deleted(v)) {
+                d.normals[i] = pmp::vertex_normal(d.mesh, v);
+                d.feature[i] = feature && feature[v];
+            }
+        });
+    }
+
+    bool        empty() const { return !data_ || data_->bvh.empty(); }
+    std::size_t n_vertices() const { return data_ ? data_->mesh.n_vertices() : 0; }
+    std::size_t n_faces() const { return data_ ? data_->mesh.n_faces() : 0; }
+
+    // Size of arrays indexed by reference vertex index
+    std::size_t vertices_size() const { return data_ ? data_->mesh.vertices_size() : 0; }
+
+    Sample sample(const pmp::Point &p) const {
+        if (empty()) {
+            throw pmp::InvalidInputException("RemeshingReference: empty reference surface");
+        }
+        const auto &d  = *data_;
+        const auto  nn = d.bvh.nearest(p);
+
+        Sample s;
+        s.point = nn.point;
+        auto it = d.mesh.vertices(nn.face).begin();
+        for (auto &c : s.corners) {
+            c = *it;
+            ++it;
+        }
+        s.weights = pmp_rosetta::detail::barycentric(nn.point, d.mesh.position(s.corners[0]),
+                                                     d.mesh.position(s.corners[1]),
+                                                     d.mesh.position(s.corners[2]));
+        s.normal  = d.normals[s.corners[0].idx()] * s.weights[0];
+        s.normal += d.normals[s.corners[1].idx()] * s.weights[1];
+        s.normal += d.normals[s.corners[2].idx()] * s.weights[2];
+        return s;
+    }
+
+    // Maximum absolute curvature per reference vertex. Boundary and feature
+    // vertices, where it is unreliable, get the average of their reliable
+    // neighbors. Computed on first call.
+    const std::vector<pmp::Scalar> &curvatures() const {
+        if (!data_) {
+            throw pmp::InvalidInputException("RemeshingReference: empty reference surface");
+        }
+        std::call_once(data_->curvature_once, [d = data_.get()] {
+            // On a scratch copy, so that concurrent samplers never see the
+            // reference mesh change
+            pmp::SurfaceMesh scratch;
+            scratch.assign(d->mesh);
+            pmp::curvature(scratch, pmp::Curvature::max_abs, 1, true, false);
+            auto curv = scratch.get_vertex_property<pmp::Scalar>("v:curv");
+
+            auto reliable = [&](pmp::Vertex v) {
+                return !scratch.is_boundary(v) && !d->feature[v.idx()];
+            };
+            d->curvatures.assign(scratch.vertices_size(), 0);
+            pmp_rosetta::parallel_for(0, scratch.vertices_size(), [&](std::size_t i) {
+                const pmp::Vertex v(static_cast<pmp::IndexType>(i));
+                if (scratch.is_deleted(v)) {
+                    return;
+                }
+                pmp::Scalar c = curv[v];
+                if (!reliable(v)) {
+                    pmp::Scalar sum = 0;
+                    int         n   = 0;
+                    for (auto vv : scratch.vertices(v)) {
+                        if (reliable(vv)) {
+                            sum += curv[vv];
+                            ++n;
+                        }
+                    }
+                    if (n > 0) {
+                        c = sum / pmp::Scalar(n);
+                    }
+                }
+                d->curvatures[i] = c;
+            });
+        });
+        return data_->curvatures;
+    }
+
+private:
+    struct Data {
+        pmp::SurfaceMesh         mesh;
+        std::vector<pmp::Normal> normals;
+        std::vector<char>        feature;
+        pmp_rosetta::TriangleBVH bvh;
+        std::once_flag           curvature_once;
+        std::vector<pmp::Scalar> curvatures;
+    };
+
+    std::shared_ptr<Data> data_;
+};
+
+namespace pmp_rosetta::detail {
+
+    class ParallelRemeshing {
+    public:
+        // An empty reference is built from the mesh itself when needed
+        ParallelRemeshing(pmp::SurfaceMesh &mesh, unsigned int n_threads,
+                          RemeshingReference reference = {})
+            : mesh_(mesh), n_threads_(n_threads), reference_(std::move(reference)) {
+            if (!mesh_.is_triangle_mesh()) {
+                throw pmp::InvalidInputException("Input is not a triangle mesh!");
+            }
+            points_  = mesh_.vertex_property<pmp::Point>("v:point");
+            vnormal_ = mesh_.vertex_property<pmp::Normal>("v:normal");
+            update_vertex_normals();
+        }
+
+        void uniform_remeshing(pmp::Scalar edge_length, unsigned int iterations,
+                               bool use_projection) {
+            begin_uniform(edge_length, use_projection);
+            for (unsigned int i = 0; i < iterations; ++i) {
+                iterate();
+            }
+            finish();
+        }
+
+        void adaptive_remeshing(pmp::Scalar min_edge_length, pmp::Scalar max_edge_length,
+                                pmp::Scalar approx_error, unsigned int iterations,
+                                bool use_projection) {
+            begin_adaptive(min_edge_length, max_edge_length, approx_error, use_projection);
+            for (unsigned int i = 0; i < iterations; ++i) {
+                iterate();
+            }
+            finish();
+        }
+
+        // Step by step: begin_uniform() or begin_adaptive(), any number of
+        // iterate(), then finish(). The mesh is a valid triangle mesh after
+        // every step.
+        void begin_uniform(pmp::Scalar edge_length, bool use_projection) {
+            uniform_            = true;
+            use_projection_     = use_projection;
+            target_edge_length_ = edge_length;
+            preprocessing();
+        }
+
+        void begin_adaptive(pmp::Scalar min_edge_length, pmp::Scalar max_edge_length,
+                            pmp::Scalar approx_error, bool use_projection) {
+            uniform_         = false;
+            use_projection_  = use_projection;
+            min_edge_length_ = min_edge_length;
+            max_edge_length_ = max_edge_length;
+            approx_error_    = approx_error;
+            preprocessing();
+        }
+
+        void iterate() {
+            split_long_edges();
+            {
+                ProfileScope scope("remeshing.normals");
+                update_vertex_normals();
+            }
+            collapse_short_edges();
+            flip_edges();
+            tangential_smoothing(5);
+        }
+
+        void finish() {
+            remove_caps();
+            postprocessing();
+        }
+
+    private:
+        // Call fn(v) for every vertex, concurrently
+        template <typename Fn> void for_each_vertex(Fn &&fn) {
+            parallel_for(
+                0, mesh_.vertices_size(),
+                [&](std::size_t i) {
+                    const pmp::Vertex v(static_cast<pmp::IndexType>(i));
+                    if (!mesh_.is_deleted(v)) {
+                        fn(v);
+                    }
+                },
+                n_threads_);
+        }
+
+        void update_vertex_normals() {
+            for_each_vertex([&](pmp::Vertex v) { vnormal_[v] = pmp::vertex_normal(mesh_, v); });
+        }
+
+        void preprocessing() {
+            ProfileScope scope("remeshing.preprocessing");
+
+            vfeature_ = mesh_.vertex_property<bool>("v:feature", false);
+            efeature_ = mesh_.edge_property<bool>("e:feature", false);
+            vlocked_  = mesh_.add_vertex_property<bool>("v:locked", false);
+            elocked_  = mesh_.add_edge_property<bool>("e:locked", false);
+            vsizing_  = mesh_.add_vertex_property<pmp::Scalar>("v:sizing");
+
+            // Lock unselected vertices if some vertices are selected
+            if (auto vselected = mesh_.get_vertex_property<bool>("v:selected")) {
+                bool has_selection = false;
+                for (auto v : mesh_.vertices()) {
+                    if (vselected[v]) {
+                        has_selection = true;
+                        break;
+                    }
+                }
+                if (has_selection) {
+                    for (auto v : mesh_.vertices()) {
+                        vlocked_[v] = !vselected[v];
+                    }
+                    // Lock an edge if one of its vertices is locked
+                    for (auto e : mesh_.edges()) {
+                        elocked_[e] = vlocked_[mesh_.vertex(e, 0)] || vlocked_[mesh_.vertex(e, 1)];
+                    }
+                }
+            }
+
+            // Lock feature corners
+            for (auto v : mesh_.vertices()) {
+                if (vfeature_[v]) {
+                    int c = 0;
+                    for (auto h : mesh_.halfedges(v)) {
+                        if (efeature_[mesh_.edge(h)]) {
+                            ++c;
+                        }
+                    }
+                    if (c != 2) {
+                        vlocked_[v] = true;
+                    }
+                }
+            }
+
+            if (use_projection_ || !uniform_) {
+                if (reference_.empty()) {
+                    reference_ = RemeshingReference(mesh_);
+                }
+
+                // Sizing field on the reference, interpolated at projections
+                refsizing_.assign(reference_.vertices_size(), target_edge_length_);
+                if (!uniform_) {
+                    const auto &curvatures = reference_.curvatures();
+                    parallel_for(
+                        0, refsizing_.size(),
+                        [&](std::size_t i) {
+                            refsizing_[i] = sizing_from_curvature(curvatures[i], min_edge_length_,
+                                                                  max_edge_length_, approx_error_);
+                        },
+                        n_threads_);
+                }
+            }
+
+            if (uniform_) {
+                for_each_vertex([&](pmp::Vertex v) { vsizing_[v] = target_edge_length_; });
+            } else {
+                for_each_vertex([&](pmp::Vertex v) {
+                    vsizing_[v] = interpolate_sizing(reference_.sample(points_[v]));
+                });
+            }
+        }
+
+        void postprocessing() {
+            mesh_.remove_vertex_property(vlocked_);
+            mesh_.remove_edge_property(elocked_);
+            mesh_.remove_vertex_property(vsizing_);
+        }
+
+        pmp::Scalar interpolate_sizing(const RemeshingReference::Sample &s) const {
+            return refsizing_[s.corners[0].idx()] * s.weights[0] +
+                   refsizing_[s.corners[1].idx()] * s.weights[1] +
+                   refsizing_[s.corners[2].idx()] * s.weights[2];
+        }
+
+        // Move v to the closest point of the reference surface, interpolating
+        // normal and sizing field there. Only writes data of v.
+        void project_to_reference(pmp::Vertex v) {
+            if (!use_projection_) {
+                return;
+            }
+
+            const auto s      = reference_.sample(points_[v]);
+            const auto length = norm(s.normal);
+
+            points_[v] = s.point;
+            if (length > std::numeric_limits<pmp::Scalar>::min()) {
+                vnormal_[v] = s.normal / length;
+            }
+            vsizing_[v] = interpolate_sizing(s);
+        }
+
+        bool is_too_long(pmp::Vertex v0, pmp::Vertex v1) const {
+            return distance(points_[v0], points_[v1]) >
+                   pmp::Scalar(4.0 / 3.0) * std::min(vsizing_[v0], vsizing_[v1]);
+        }
+
+        bool is_too_short(pmp::Vertex v0, pmp::Vertex v1) const {
+            return distance(points_[v0], points_[v1]) <
+                   pmp::Scalar(4.0 / 5.0) * std::min(vsizing_[v0], vsizing_[v1]);
+        }
+
+        void split_long_edges() {
+            ProfileScope scope("remeshing.split");
+            std::size_t  n_splits = 0;
+
+            bool ok = false;
+            for (int i = 0; !ok && i < 10; ++i) {
+                ok = true;
+                for (auto e : mesh_.edges()) {
+                    const auto v0 = mesh_.vertex(e, 0);
+                    const auto v1 = mesh_.vertex(e, 1);
+                    if (elocked_[e] || !is_too_long(v0, v1)) {
+                        continue;
+                    }
+
+                    const bool is_feature  = efeature_[e];
+                    const bool is_boundary = mesh_.is_boundary(e);
+
+                    const auto vnew =
+                        mesh_.add_vertex((points_[v0] + points_[v1]) * pmp::Scalar(0.5));
+                    mesh_.split(e, vnew);
+
+                    // Need normal and sizing for adaptive refinement
+                    vnormal_[vnew] = pmp::vertex_normal(mesh_, vnew);
+                    vsizing_[vnew] = pmp::Scalar(0.5) * (vsizing_[v0] + vsizing_[v1]);
+
+                    if (is_feature) {
+                        const auto enew = is_boundary ? pmp::Edge(mesh_.edges_size() - 2)
+                                                      : pmp::Edge(mesh_.edges_size() - 3);
+                        efeature_[enew] = true;
+                        vfeature_[vnew] = true;
+                    } else {
+                        project_to_reference(vnew);
+                    }
+                    ++n_splits;
+                    ok = false;
+                }
+            }
+            profile_count("remeshing.splits", std::int64_t(n_splits));
+        }
+
+        void collapse_short_edges() {
+            ProfileScope scope("remeshing.collapse");
+            std::size_t  n_collapses = 0;
+
+            bool ok = false;
+            for (int i = 0; !ok && i < 10; ++i) {
+                ok = true;
+                for (auto e : mesh_.edges()) {
+                    if (mesh_.is_deleted(e) || elocked_[e]) {
+                        continue;
+                    }
+
+                    const auto h10 = mesh_.halfedge(e, 0);
+                    const auto h01 = mesh_.halfedge(e, 1);
+                    const auto v0  = mesh_.to_vertex(h10);
+                    const auto v1  = mesh_.to_vertex(h01);
+                    if (!is_too_short(v0, v1)) {
+                        continue;
+                    }
+
+                    const bool b0 = mesh_.is_boundary(v0);
+                    const bool b1 = mesh_.is_boundary(v1);
+                    const bool l0 = vlocked_[v0];
+                    const bool l1 = vlocked_[v1];
+                    const bool f0 = vfeature_[v0];
+                    const bool f1 = vfeature_[v1];
+                    bool       hcol01 = true;
+                    bool       hcol10 = true;
+
+                    // Boundary rules
+                    if (b0 && b1) {
+                        if (!mesh_.is_boundary(e)) {
+                            continue;
+                        }
+                    } else if (b0) {
+                        hcol01 = false;
+                    } else if (b1) {
+                        hcol10 = false;
+                    }
+
+                    // Locked rules
+                    if (l0 && l1) {
+                        continue;
+                    } else if (l0) {
+                        hcol01 = false;
+                    } else if (l1) {
+                        hcol10 = false;
+                    }
+
+                    // Feature rules
+                    if (f0 && f1) {
+                        // The edge must be a feature...
+                        if (!efeature_[e]) {
+                            continue;
+                        }
+                        // ...and the two other edges removed by the collapse must not
+                        if (efeature_[mesh_.edge(mesh_.prev_halfedge(h01))] ||
+                            efeature_[mesh_.edge(mesh_.next_halfedge(h10))]) {
+                            hcol01 = false;
+                        }
+                        if (efeature_[mesh_.edge(mesh_.prev_halfedge(h10))] ||
+                            efeature_[mesh_.edge(mesh_.next_halfedge(h01))]) {
+                            hcol10 = false;
+                        }
+                    } else if (f0) {
+                        hcol01 = false;
+                    } else if (f1) {
+                        hcol10 = false;
+                    }
+
+                    // Topological rules
+                    const bool collapse_ok = mesh_.is_collapse_ok(h01);
+                    hcol01                 = hcol01 && collapse_ok;
+                    hcol10                 = hcol10 && collapse_ok;
+
+                    // Both collapses possible: collapse into the vertex of higher valence
+                    if (hcol01 && hcol10) {
+                        if (mesh_.valence(v0) < mesh_.valence(v1)) {
+                            hcol10 = false;
+                        } else {
+                            hcol01 = false;
+                        }
+                    }
+
+                    // Do not create too long edges
+                    if (hcol10) {
+                        for (auto vv : mesh_.vertices(v1)) {
+                            if (is_too_long(v0, vv)) {
+                                hcol10 = false;
+                                break;
+                            }
+                        }
+                        if (hcol10) {
+                            mesh_.collapse(h10);
+                            ++n_collapses;
+                            ok = false;
+                        }
+                    } else if (hcol01) {
+                        for (auto vv : mesh_.vertices(v0)) {
+                            if (is_too_long(v1, vv)) {
+                                hcol01 = false;
+                                break;
+                            }
+                        }
+                        if (hcol01) {
+                            mesh_.collapse(h01);
+                            ++n_collapses;
+                            ok = false;
+                        }
+                    }
+                }
+            }
+
+            profile_count("remeshing.collapses", std::int64_t(n_collapses));
+            mesh_.garbage_collection();
+        }
+
+        void flip_edges() {
+            ProfileScope scope("remeshing.flip");
+            std::size_t  n_flips = 0;
+
+            // Valence are tracked incrementally, computed once in parallel
+            std::vector<int> valence(mesh_.vertices_size());
+            for_each_vertex([&](pmp::Vertex v) { valence[v.idx()] = int(mesh_.valence(v)); });
+
+            auto optimal = [&](pmp::Vertex v) { return mesh_.is_boundary(v) ? 4 : 6; };
+
+            bool ok = false;
+            for (int i = 0; !ok && i < 10; ++i) {
+                ok = true;
+                for (auto e : mesh_.edges()) {
+                    if (elocked_[e] || efeature_[e]) {
+                        continue;
+                    }
+
+                    const auto h0 = mesh_.halfedge(e, 0);
+                    const auto h1 = mesh_.halfedge(e, 1);
+                    const auto v0 = mesh_.to_vertex(h0);
+                    const auto v2 = mesh_.to_vertex(mesh_.next_halfedge(h0));
+                    const auto v1 = mesh_.to_vertex(h1);
+                    const auto v3 = mesh_.to_vertex(mesh_.next_halfedge(h1));
+                    if (vlocked_[v0] || vlocked_[v1] || vlocked_[v2] || vlocked_[v3]) {
+                        continue;
+                    }
+
+                    auto deviation = [&](pmp::Vertex v, int delta) {
+                        const int d = valence[v.idx()] + delta - optimal(v);
+                        return d * d;
+                    };
+                    const int before =
+                        deviation(v0, 0) + deviation(v1, 0) + deviation(v2, 0) + deviation(v3, 0);
+                    const int after =
+                        deviation(v0, -1) + deviation(v1, -1) + deviation(v2, 1) + deviation(v3, 1);
+
+                    if (before > after && mesh_.is_flip_ok(e)) {
+                        mesh_.flip(e);
+                        --valence[v0.idx()];
+                        --valence[v1.idx()];
+                        ++valence[v2.idx()];
+                        ++valence[v3.idx()];
+                        ++n_flips;
+                        ok = false;
+                    }
+                }
+            }
+            profile_count("remeshing.flips", std::int64_t(n_flips));
+        }
+
+        // Sizing-weighted centroid of the triangles around v
+        pmp::Point weighted_centroid(pmp::Vertex v) const {
+            pmp::Point  p(0, 0, 0);
+            pmp::Scalar ww = 0;
+            for (auto h : mesh_.halfedges(v)) {
+                const auto v2 = mesh_.to_vertex(h);
+                const auto v3 = mesh_.to_vertex(mesh_.next_halfedge(h));
+
+                pmp::Point b = points_[v];
+                b += points_[v2];
+                b += points_[v3];
+                b *= pmp::Scalar(1.0 / 3.0);
+
+                pmp::Scalar area = norm(cross(points_[v2] - points_[v], points_[v3] - points_[v]));
+                // Avoid all zero weights on degenerate faces
+                if (area == 0) {
+                    area = 1;
+                }
+                const pmp::Scalar s = (vsizing_[v] + vsizing_[v2] + vsizing_[v3]) / 3;
+                const pmp::Scalar w = area / (s * s);
+
+                p += w * b;
+                ww += w;
+            }
+            return p / ww;
+        }
+
+        void tangential_smoothing(unsigned int iterations) {
+            ProfileScope scope("remeshing.smoothing");
+
+            auto movable = [&](pmp::Vertex v) { return !mesh_.is_boundary(v) && !vlocked_[v]; };
+
+            // Project first, to get valid sizing and normals for new vertices
+            if (use_projection_) {
+                ProfileScope projection("remeshing.projection");
+                for_each_vertex([&](pmp::Vertex v) {
+                    if (movable(v)) {
+                        project_to_reference(v);
+                    }
+                });
+            }
+
+            std::vector<pmp::Point> update(mesh_.vertices_size(), pmp::Point(0, 0, 0));
+            for (unsigned int iter = 0; iter < iterations; ++iter) {
+                // Every update only reads positions, so all can run concurrently
+                for_each_vertex([&](pmp::Vertex v) {
+                    if (movable(v)) {
+                        update[v.idx()] = vfeature_[v] ? feature_update(v) : tangential_update(v);
+                    }
+                });
+
+                for_each_vertex([&](pmp::Vertex v) {
+                    if (movable(v)) {
+                        points_[v] += update[v.idx()];
+                    }
+                });
+
+                update_vertex_normals();
+            }
+
+            if (use_projection_) {
+                ProfileScope projection("remeshing.projection");
+                for_each_vertex([&](pmp::Vertex v) {
+                    if (movable(v)) {
+                        project_to_reference(v);
+                    }
+                });
+            }
+        }
+
+        // Move along the feature line, towards the sizing-weighted midpoint
+        // of the two feature neighbors
+        pmp::Point feature_update(pmp::Vertex v) const {
+            pmp::Point  u(0, 0, 0);
+            pmp::Point  t(0, 0, 0);
+            pmp::Scalar ww = 0;
+            int         c  = 0;
+            for (auto h : mesh_.halfedges(v)) {
+                if (!efeature_[mesh_.edge(h)]) {
+                    continue;
+                }
+                const auto vv = mesh_.to_vertex(h);
+
+                const pmp::Point  b = (points_[v] + points_[vv]) * pmp::Scalar(0.5);
+                const pmp::Scalar w = distance(points_[v], points_[vv]) /
+                                      (pmp::Scalar(0.5) * (vsizing_[v] + vsizing_[vv]));
+                ww += w;
+                u += w * b;
+
+                const auto dir = normalize(points_[vv] - points_[v]);
+                if (c++ == 0) {
+                    t += dir;
+                } else {
+                    t -= dir;
+                }
+            }
+            if (c != 2 || ww == 0) {
+                return pmp::Point(0, 0, 0);
+            }
+
+            u /= ww;
+            u -= points_[v];
+            t = normalize(t);
+            return t * dot(u, t);
+        }
+
+        // Move towards the weighted centroid, within the tangent plane
+        pmp::Point tangential_update(pmp::Vertex v) const {
+            pmp::Point       u = weighted_centroid(v) - points_[v];
+            const pmp::Point n = vnormal_[v];
+            u -= n * dot(u, n);
+            return u;
+        }
+
+        // Flip edges opposite to angles above 170 degrees
+        void remove_caps() {
+            ProfileScope scope("remeshing.remove_caps");
+
+            const pmp::Scalar max_cos = std::cos(pmp::Scalar(170.0 / 180.0 * std::numbers::pi));
+
+            for (auto e : mesh_.edges()) {
+                if (elocked_[e] || !mesh_.is_flip_ok(e)) {
+                    continue;
+                }
+
+                const auto h0 = mesh_.next_halfedge(mesh_.halfedge(e, 0));
+                const auto h1 = mesh_.next_halfedge(mesh_.halfedge(e, 1));
+                const auto vb = mesh_.to_vertex(h0);
+                const auto vd = mesh_.to_vertex(h1);
+
+                const pmp::Point a = points_[mesh_.vertex(e, 1)];
+                const pmp::Point b = points_[vb];
+                const pmp::Point c = points_[mesh_.vertex(e, 0)];
+                const pmp::Point d = points_[vd];
+
+                const auto a0 = dot(normalize(a - b), normalize(c - b));
+                const auto a1 = dot(normalize(a - d), normalize(c - d));
+                const auto v  = a0 < a1 ? vb : vd;
+                if (std::min(a0, a1) >= max_cos) {
+                    continue;
+                }
+
+                // Feature edge and feature vertex: seems to be intended
+                if (efeature_[e] && vfeature_[v]) {
+                    continue;
+                }
+                // Project v onto the feature edge
+                if (efeature_[e]) {
+                    points_[v] = (a + c) * pmp::Scalar(0.5);
+                }
+                mesh_.flip(e);
+            }
+        }
+
+        pmp::SurfaceMesh &mesh_;
+        unsigned int      n_threads_;
+
+        bool        uniform_            = true;
+        bool        use_projection_     = true;
+        pmp::Scalar target_edge_length_ = 0;
+        pmp::Scalar min_edge_length_    = 0;
+        pmp::Scalar max_edge_length_    = 0;
+        pmp::Scalar approx_error_       = 0;
+
+        pmp::VertexProperty<pmp::Point>  points_;
+        pmp::VertexProperty<pmp::Normal> vnormal_;
+        pmp::VertexProperty<bool>        vfeature_;
+        pmp::EdgeProperty<bool>          efeature_;
+        pmp::VertexProperty<bool>        vlocked_;
+        pmp::EdgeProperty<bool>          elocked_;
+        pmp::VertexProperty<pmp::Scalar> vsizing_;
+
+        RemeshingReference       reference_;
+        std::vector<pmp::Scalar> refsizing_;
+    };
+
+} // namespace pmp_rosetta::detail
+
+// Multithreaded pmp::uniform_remeshing(), on n_threads threads (0 = all cores)
+inline void parallel_uniform_remeshing(pmp::SurfaceMesh &mesh, pmp::Scalar edge_length,
+                                       unsigned int iterations, bool use_projection,
+                                       unsigned int n_threads) {
+    pmp_rosetta::detail::ParallelRemeshing(mesh, n_threads)
+        .uniform_remeshing(edge_length, iterations, use_projection);
+}
+
+// Multithreaded pmp::adaptive_remeshing(), on n_threads threads (0 = all cores)
+inline void parallel_adaptive_remeshing(pmp::SurfaceMesh &mesh, pmp::Scalar min_edge_length,
+                                        pmp::Scalar max_edge_length, pmp::Scalar approx_error,
+                                        unsigned int iterations, bool use_projection,
+                                        unsigned int n_threads) {
+    pmp_rosetta::detail::ParallelRemeshing(mesh, n_threads)
+        .adaptive_remeshing(min_edge_length, max_edge_length, approx_error, iterations,
+                            use_projection);
+}
+
+// Uniform remeshing with projection onto a prebuilt reference surface,
+// typically built once from the input and reused across calls
+inline void uniform_remeshing_onto(pmp::SurfaceMesh &mesh, const RemeshingReference &reference,
+                                   pmp::Scalar edge_length, unsigned int iterations,
+                                   unsigned int n_threads) {
+    if (reference.empty()) {
+        throw pmp::InvalidInputException("uniform_remeshing_onto: empty reference surface");
+    }
+    pmp_rosetta::detail::ParallelRemeshing(mesh, n_threads, reference)
+        .uniform_remeshing(edge_length, iterations, true);
+}
+
+// Adaptive remeshing with projection onto a prebuilt reference surface. The
+// curvature of the reference is computed on first use and then reused.
+inline void adaptive_remeshing_onto(pmp::SurfaceMesh &mesh, const RemeshingReference &reference,
+                                    pmp::Scalar min_edge_length, pmp::Scalar max_edge_length,
+                                    pmp::Scalar approx_error, unsigned int iterations,
+                                    unsigned int n_threads) {
+    if (reference.empty()) {
+        throw pmp::InvalidInputException("adaptive_remeshing_onto: empty reference surface");
+    }
+    pmp_rosetta::detail::ParallelRemeshing(mesh, n_threads, reference)
+        .adaptive_remeshing(min_edge_length, max_edge_length, approx_error, iterations, true);
+}
@@ -0,0 +1,168 @@
+// ============================================================================
+// Render buffers in one native pass
+// ============================================================================
+// A viewer refresh needs positions, vertex normals and an index buffer in the
+// layout of its graphics API. export_render_buffers() fills all three in
+// caller-owned arrays, over a thread pool, in one of two layouts:
+// - VTK (PyVista): the n_vertices() positions, then the n_vertices()
+//   normals, each block contiguous so both can be wrapped without a copy;
+//   faces as int64 [n, v0, ..., vn-1, ...] cells, polygons kept as they are.
+// - GL: interleaved [x y z nx ny nz] rows, for one vertex buffer with a
+//   stride of 6 scalars; pmp::IndexType triangle corners, polygons split
+//   into fans.
+// Rows follow export_points(), so meshes holding deleted elements need no
+// garbage collection first. Normals are those of pmp::vertex_normal().
+// ============================================================================
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <pmp/algorithms/normals.h>
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "mesh_buffers.h"
+#include "mesh_geometry.h"
+#include "parallel.h"
+#include "triangles.h"
+
+namespace pmp_rosetta::detail {
+
+    // Index values of face f in a VTK or GL buffer
+    inline std::size_t render_indices_of(const pmp::SurfaceMesh &mesh, pmp::Face f,
+                                         bool vtk_layout) {
+        const std::size_t n = mesh.valence(f);
+        return vtk_layout ? n + 1 : 3 * (n - 2);
+    }
+
+    // Offset of every face in the index buffer, plus the total; empty when
+    // all faces are triangles, whose offsets follow from their rank
+    template <typename AllTriangles>
+    inline std::vector<std::size_t> render_offsets(const pmp::SurfaceMesh       &mesh,
+                                                   const std::vector<pmp::Face> &faces,
+                                                   bool vtk_layout, AllTriangles) {
+        std::vector<std::size_t> offsets;
+        if constexpr (AllTriangles::value) {
+            return offsets;
+        }
+        offsets.resize(faces.size() + 1, 0);
+        for (std::size_t i = 0; i < faces.size(); ++i) {
+            offsets[i + 1] = offsets[i] + render_indices_of(mesh, faces[i], vtk_layout);
+        }
+        return offsets;
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Size of the index buffer of export_render_buffers(): n_faces() +
+// n_face_indices() values for the VTK layout, 3 per triangle of the fans for GL
+inline std::size_t n_render_indices(const pmp::SurfaceMesh &mesh, bool vtk_layout) {
+    std::size_t n = 0;
+    for (auto f : mesh.faces()) {
+        n += pmp_rosetta::detail::render_indices_of(mesh, f, vtk_layout);
+    }
+    return n;
+}
+
+// Fill vertices (6 * n_vertices() pmp::Scalar: positions and normals) and
+// indices (n_render_indices() values: std::int64_t with vtk_layout,
+// pmp::IndexType otherwise) in the layouts described above, over n_threads
+// threads (0: all cores). Returns the number of index values written.
+inline std::size_t export_render_buffers(const pmp::SurfaceMesh &mesh, std::uintptr_t vertices,
+                                         std::size_t vertex_capacity, std::uintptr_t indices,
+                                         std::size_t index_capacity, bool vtk_layout,
+                                         unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    const auto vs = handles<pmp::Vertex>(mesh.vertices());
+    const auto fs = handles<pmp::Face>(mesh.faces());
+    const auto nv = vs.size();
+
+    std::vector<pmp::IndexType> map;
+    if (mesh.has_garbage()) {
+        map = compact_vertex_map(mesh);
+    }
+    const auto index = [&](pmp::Vertex v) { return map.empty() ? v.idx() : map[v.idx()]; };
+
+    return with_arity(mesh, [&](auto arity) {
+        constexpr bool triangles = decltype(arity)::value;
+
+        const auto offsets   = render_offsets(mesh, fs, vtk_layout, arity);
+        const auto per_face  = vtk_layout ? std::size_t(4) : std::size_t(3);
+        const auto n_indices = offsets.empty() ? per_face * fs.size() : offsets.back();
+
+        check_capacity(6 * nv, vertex_capacity, "export_render_buffers");
+        check_capacity(n_indices, index_capacity, "export_render_buffers");
+        auto *dst = buffer_cast<pmp::Scalar>(vertices, vertex_capacity, "export_render_buffers");
+
+        // Positions and normals: VTK blocks of 3 * nv, or GL rows of 6
+        const std::size_t position_stride = vtk_layout ? 3 : 6;
+        auto             *normals         = vtk_layout ? dst + 3 * nv : dst + 3;
+        pmp_rosetta::parallel_for(
+            0, nv,
+            [&](std::size_t i) {
+                const auto &p = mesh.position(vs[i]);
+                const auto  n = vertex_normal(mesh, vs[i], arity);
+                for (int k = 0; k < 3; ++k) {
+                    dst[position_stride * i + k]     = p[k];
+                    normals[position_stride * i + k] = n[k];
+                }
+            },
+            n_threads, 256);
+
+        const auto offset_of = [&](std::size_t i) {
+            return offsets.empty() ? per_face * i : offsets[i];
+        };
+        if (vtk_layout) {
+            auto *out = buffer_cast<std::int64_t>(indices, index_capacity, "export_render_buffers");
+            pmp_rosetta::parallel_for(
+                0, fs.size(),
+                [&](std::size_t i) {
+                    auto *cell = out + offset_of(i);
+                    if constexpr (triangles) {
+                        *cell++ = 3;
+                        for (auto v : triangle_vertices(mesh, fs[i])) {
+                            *cell++ = std::int64_t(index(v));
+                        }
+                    } else {
+                        *cell++ = std::int64_t(mesh.valence(fs[i]));
+                        for (auto v : mesh.vertices(fs[i])) {
+                            *cell++ = std::int64_t(index(v));
+                        }
+                    }
+                },
+                n_threads, 1024);
+        } else {
+            auto *out =
+                buffer_cast<pmp::IndexType>(indices, index_capacity, "export_render_buffers");
+            pmp_rosetta::parallel_for(
+                0, fs.size(),
+                [&](std::size_t i) {
+                    auto *corner = out + offset_of(i);
+                    if constexpr (triangles) {
+                        for (auto v : triangle_vertices(mesh, fs[i])) {
+                            *corner++ = index(v);
+                        }
+                    } else {
+                        pmp::IndexType first = 0, last = 0;
+                        std::size_t    k     = 0;
+                        for (auto v : mesh.vertices(fs[i])) {
+                            const auto j = index(v);
+                            if (k == 0) {
+                                first = j;
+                            } else if (k >= 2) {
+                                *corner++ = first;
+                                *corner++ = last;
+                                *corner++ = j;
+                            }
+                            last = j;
+                            ++k;
+                        }
+                    }
+                },
+                n_threads, 1024);
+        }
+        return n_indices;
+    });
+}
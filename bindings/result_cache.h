@@ -0,0 +1,466 @@
+// ============================================================================
+// Content-addressed cache of algorithm results
+// ============================================================================
+// mesh_content_hash() hashes what the algorithms read from a mesh: the
+// halfedge connectivity, "v:point", the deleted flags and the selection and
+// feature flags ("v:selected", "v:feature", "e:feature") when present. The
+// elements are hashed in fixed-size chunks on all cores, each chunk through
+// four independent lanes that the compiler vectorizes, and the chunk hashes
+// are then hashed in order, so the result does not depend on the number of
+// threads.
+//
+// A ResultCache maps that hash, combined with an algorithm name and its
+// arguments, to the output mesh, stored as a snapshot (see snapshot.h) in a
+// directory shared by any number of processes. The cached_* functions run
+// an algorithm only for inputs the cache has not seen:
+//
+//   ResultCache cache("/var/cache/pmp", 1 << 30);
+//   cached_uniform_remeshing(mesh, cache, 0.01, 10, true);  // true on a hit
+//
+// Results are written to a temporary file and renamed into place, so
+// concurrent writers of the same key are harmless. When the directory grows
+// past max_bytes, the least recently used results are deleted.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include <pmp/algorithms/decimation.h>
+#include <pmp/algorithms/remeshing.h>
+#include <pmp/algorithms/subdivision.h>
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "parallel.h"
+#include "profiling.h"
+#include "snapshot.h"
+
+namespace pmp_rosetta::detail {
+
+    // Bump when the hashed data or the stored results change meaning
+    constexpr std::uint64_t result_cache_version = 1;
+
+    using Hash128 = std::array<std::uint64_t, 2>;
+
+    inline std::uint64_t rotl64(std::uint64_t x, int r) {
+        return (x << r) | (x >> (64 - r));
+    }
+
+    // splitmix64 finalizer
+    inline std::uint64_t mix64(std::uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // 128-bit hash of n bytes: xxHash64-style rounds over four 64-bit lanes
+    inline Hash128 hash_bytes(const unsigned char *data, std::size_t n, std::uint64_t seed) {
+        constexpr std::uint64_t p1 = 0x9e3779b185ebca87ull;
+        constexpr std::uint64_t p2 = 0xc2b2ae3d27d4eb4full;
+
+        std::uint64_t lanes[4] = {seed + p1 + p2, seed + p2, seed, seed - p1};
+        std::size_t   i        = 0;
+        for (; i + 32 <= n; i += 32) {
+            for (int k = 0; k < 4; ++k) {
+                std::uint64_t w;
+                std::memcpy(&w, data + i + 8 * k, 8);
+                lanes[k] = rotl64(lanes[k] + w * p2, 31) * p1;
+            }
+        }
+        unsigned char tail[32] = {};
+        if (n > i) {
+            std::memcpy(tail, data + i, n - i);
+        }
+        for (int k = 0; k < 4; ++k) {
+            std::uint64_t w;
+            std::memcpy(&w, tail + 8 * k, 8);
+            lanes[k] = rotl64(lanes[k] + w * p2, 31) * p1;
+        }
+
+        const auto a = mix64(lanes[0] ^ rotl64(lanes[1], 17) ^ std::uint64_t(n));
+        const auto b = mix64(lanes[2] ^ rotl64(lanes[3], 29) ^ (std::uint64_t(n) * p1));
+        return {mix64(a + 7 * b), mix64(b ^ rotl64(a, 23))};
+    }
+
+    // Appends values to a byte buffer to be hashed
+    class HashInput {
+    public:
+        template <typename T> void add(const T &value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            const auto *p = reinterpret_cast<const unsigned char *>(&value);
+            bytes_.insert(bytes_.end(), p, p + sizeof(T));
+        }
+
+        void add(const std::string &s) {
+            add(std::uint64_t(s.size()));
+            bytes_.insert(bytes_.end(), s.begin(), s.end());
+        }
+
+        Hash128 hash(std::uint64_t seed) const {
+            return hash_bytes(bytes_.data(), bytes_.size(), seed);
+        }
+
+    private:
+        std::vector<unsigned char> bytes_;
+    };
+
+    // Hash of the elements [0, n): fill(i, input) appends element i; chunks
+    // of `chunk` elements are hashed in parallel
+    template <typename Fill>
+    inline Hash128 hash_elements(std::size_t n, Fill &&fill, std::uint64_t seed,
+                                 unsigned int n_threads, std::size_t chunk = 16384) {
+        const auto           n_chunks = (n + chunk - 1) / chunk;
+        std::vector<Hash128> hashes(n_chunks);
+        parallel_for(
+            0, n_chunks,
+            [&](std::size_t c) {
+                HashInput input;
+                for (auto i = c * chunk; i < std::min(n, (c + 1) * chunk); ++i) {
+                    fill(i, input);
+                }
+                hashes[c] = input.hash(seed + c);
+            },
+            n_threads, 1);
+        return hash_bytes(reinterpret_cast<const unsigned char *>(hashes.data()),
+                          hashes.size() * sizeof(Hash128), seed ^ n);
+    }
+
+    inline Hash128 mesh_hash(const pmp::SurfaceMesh &mesh, unsigned int n_threads) {
+        ProfileScope scope("result_cache.hash");
+
+        const auto vselected = mesh.get_vertex_property<bool>("v:selected");
+        const auto vfeature  = mesh.get_vertex_property<bool>("v:feature");
+        const auto efeature  = mesh.get_edge_property<bool>("e:feature");
+        const bool garbage   = mesh.has_garbage();
+
+        HashInput summary;
+        summary.add(result_cache_version);
+        summary.add(std::uint64_t(sizeof(pmp::Scalar)));
+        summary.add(std::uint64_t(mesh.vertices_size()));
+        summary.add(std::uint64_t(mesh.halfedges_size()));
+        summary.add(std::uint64_t(mesh.faces_size()));
+        summary.add(std::uint8_t(garbage));
+        summary.add(std::uint8_t(bool(vselected)));
+        summary.add(std::uint8_t(bool(vfeature)));
+        summary.add(std::uint8_t(bool(efeature)));
+
+        const auto vertices = hash_elements(
+            mesh.vertices_size(),
+            [&](std::size_t i, HashInput &in) {
+                const pmp::Vertex v(static_cast<pmp::IndexType>(i));
+                const auto       &p = mesh.position(v);
+                in.add(mesh.halfedge(v).idx());
+                in.add(p[0]);
+                in.add(p[1]);
+                in.add(p[2]);
+                if (garbage) {
+                    in.add(std::uint8_t(mesh.is_deleted(v)));
+                }
+                if (vselected) {
+                    in.add(std::uint8_t(vselected[v]));
+                }
+                if (vfeature) {
+                    in.add(std::uint8_t(vfeature[v]));
+                }
+            },
+            1, n_threads);
+        const auto halfedges = hash_elements(
+            mesh.halfedges_size(),
+            [&](std::size_t i, HashInput &in) {
+                const pmp::Halfedge h(static_cast<pmp::IndexType>(i));
+                in.add(mesh.to_vertex(h).idx());
+                in.add(mesh.next_halfedge(h).idx());
+                in.add(mesh.face(h).idx());
+                if (i % 2 == 0) {
+                    const auto e = mesh.edge(h);
+                    if (garbage) {
+                        in.add(std::uint8_t(mesh.is_deleted(e)));
+                    }
+                    if (efeature) {
+                        in.add(std::uint8_t(efeature[e]));
+                    }
+                }
+            },
+            2, n_threads);
+        const auto faces = hash_elements(
+            mesh.faces_size(),
+            [&](std::size_t i, HashInput &in) {
+                const pmp::Face f(static_cast<pmp::IndexType>(i));
+                in.add(mesh.halfedge(f).idx());
+                if (garbage) {
+                    in.add(std::uint8_t(mesh.is_deleted(f)));
+                }
+            },
+            3, n_threads);
+
+        summary.add(vertices);
+        summary.add(halfedges);
+        summary.add(faces);
+        return summary.hash(0);
+    }
+
+    inline std::string hex(const Hash128 &h) {
+        static const char digits[] = "0123456789abcdef";
+        std::string       s;
+        for (auto word : h) {
+            for (int shift = 60; shift >= 0; shift -= 4) {
+                s += digits[(word >> shift) & 0xf];
+            }
+        }
+        return s;
+    }
+
+    // Key of algorithm(args...) applied to mesh
+    template <typename... Args>
+    inline std::string result_key(const pmp::SurfaceMesh &mesh, const std::string &algorithm,
+                                  const Args &...args) {
+        HashInput input;
+        input.add(mesh_hash(mesh, 0));
+        input.add(algorithm);
+        (input.add(args), ...);
+        return hex(input.hash(result_cache_version));
+    }
+
+    struct ResultCacheState {
+        std::filesystem::path      directory;
+        std::uint64_t              max_bytes = 0;
+        std::atomic<std::uint64_t> hits{0};
+        std::atomic<std::uint64_t> misses{0};
+    };
+
+} // namespace pmp_rosetta::detail
+
+// Hex digest of the data mesh_content_hash() covers (see above), on
+// n_threads threads (0: all cores)
+inline std::string mesh_content_hash(const pmp::SurfaceMesh &mesh, unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+    return hex(mesh_hash(mesh, n_threads));
+}
+
+// Results stored in one directory, created if needed. max_bytes bounds its
+// size (0: unbounded). Copies share the same counters.
+class ResultCache {
+public:
+    ResultCache() = default;
+
+    ResultCache(const std::string &directory, std::uint64_t max_bytes)
+        : state_(std::make_shared<pmp_rosetta::detail::ResultCacheState>()) {
+        state_->directory = directory;
+        state_->max_bytes = max_bytes;
+        std::error_code error;
+        std::filesystem::create_directories(state_->directory, error);
+        if (!std::filesystem::is_directory(state_->directory)) {
+            throw pmp::IOException("ResultCache: cannot create directory " + directory);
+        }
+    }
+
+    std::string   directory() const { return state().directory.string(); }
+    std::uint64_t hits() const { return state_ ? state_->hits.load() : 0; }
+    std::uint64_t misses() const { return state_ ? state_->misses.load() : 0; }
+
+    bool contains(const std::string &key) const {
+        std::error_code error;
+        return std::filesystem::exists(path(key), error);
+    }
+
+    // Replace mesh by the result stored under key, if any. Returns whether
+    // there was one; mesh is left untouched if not.
+    bool load(const std::string &key, pmp::SurfaceMesh &mesh) const {
+        pmp_rosetta::ProfileScope scope("result_cache.load");
+
+        const auto      file = path(key);
+        std::error_code error;
+        if (!std::filesystem::exists(file, error)) {
+            ++state_->misses;
+            return false;
+        }
+        // open_snapshot() clears the mesh before it can fail
+        pmp::SurfaceMesh result;
+        try {
+            open_snapshot(result, file);
+        } catch (const pmp::IOException &) {
+            // Truncated by a crash, or written by an incompatible build
+            std::filesystem::remove(file, error);
+            ++state_->misses;
+            return false;
+        }
+        mesh = result;
+        // The modification time orders results for trim()
+        std::filesystem::last_write_time(file, std::filesystem::file_time_type::clock::now(),
+                                         error);
+        ++state_->hits;
+        return true;
+    }
+
+    void store(const std::string &key, const pmp::SurfaceMesh &mesh) const {
+        pmp_rosetta::ProfileScope scope("result_cache.store");
+
+        const auto file = path(key);
+        const auto unique =
+            std::hash<std::thread::id>{}(std::this_thread::get_id()) ^
+            std::uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+        auto temp = file;
+        temp += ".tmp" + std::to_string(unique);
+        save_snapshot(mesh, temp);
+
+        std::error_code error;
+        std::filesystem::rename(temp, file, error);
+        if (error) {
+            std::filesystem::remove(temp, error);
+            throw pmp::IOException("ResultCache: cannot store " + file.string());
+        }
+        if (state_->max_bytes > 0) {
+            trim(state_->max_bytes);
+        }
+    }
+
+    // Delete the least recently used results until the directory holds at
+    // most max_bytes. Returns the bytes left.
+    std::uint64_t trim(std::uint64_t max_bytes) const {
+        struct Entry {
+            std::filesystem::path           path;
+            std::filesystem::file_time_type time;
+            std::uint64_t                   size;
+        };
+        std::vector<Entry> entries;
+        std::uint64_t      total = 0;
+        std::error_code    error;
+        for (const auto &e : std::filesystem::directory_iterator(state().directory, error)) {
+            if (e.path().extension() != ".pmpsnap") {
+                continue;
+            }
+            Entry entry{e.path(), e.last_write_time(error), e.file_size(error)};
+            if (!error) {
+                total += entry.size;
+                entries.push_back(std::move(entry));
+            }
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const Entry &a, const Entry &b) { return a.time < b.time; });
+        for (const auto &entry : entries) {
+            if (total <= max_bytes) {
+                break;
+            }
+            if (std::filesystem::remove(entry.path, error)) {
+                total -= entry.size;
+            }
+        }
+        return total;
+    }
+
+    // Delete every stored result
+    void clear() const { trim(0); }
+
+    // If key is stored, load it into mesh and return true; otherwise run
+    // run(mesh), store the result and return false
+    template <typename Run> bool apply(const std::string &key, pmp::SurfaceMesh &mesh, Run &&run) {
+        if (load(key, mesh)) {
+            return true;
+        }
+        run(mesh);
+        store(key, mesh);
+        return false;
+    }
+
+private:
+    const pmp_rosetta::detail::ResultCacheState &state() const {
+        if (!state_) {
+            throw pmp::InvalidInputException("ResultCache: no directory");
+        }
+        return *state_;
+    }
+
+    std::filesystem::path path(const std::string &key) const {
+        return state().directory / (key + ".pmpsnap");
+    }
+
+    std::shared_ptr<pmp_rosetta::detail::ResultCacheState> state_;
+};
+
+// The cache key of a mesh and an algorithm with its arguments, for callers
+// caching their own pipelines with ResultCache::load() / store()
+inline std::string result_key(const pmp::SurfaceMesh &mesh, const std::string &algorithm,
+                              const std::string &arguments) {
+    return pmp_rosetta::detail::result_key(mesh, algorithm, arguments);
+}
+
+// pmp::uniform_remeshing() and friends through a cache: each returns true
+// when the result came from the cache, false when it was computed (and stored)
+inline bool cached_uniform_remeshing(pmp::SurfaceMesh &mesh, ResultCache &cache,
+                                     pmp::Scalar edge_length, unsigned int iterations,
+                                     bool use_projection) {
+    const auto key = pmp_rosetta::detail::result_key(mesh, "uniform_remeshing", edge_length,
+                                                     iterations, use_projection);
+    return cache.apply(key, mesh, [&](pmp::SurfaceMesh &m) {
+        pmp::uniform_remeshing(m, edge_length, iterations, use_projection);
+    });
+}
+
+inline bool cached_adaptive_remeshing(pmp::SurfaceMesh &mesh, ResultCache &cache,
+                                      pmp::Scalar min_edge_length, pmp::Scalar max_edge_length,
+                                      pmp::Scalar approx_error, unsigned int iterations,
+                                      bool use_projection) {
+    const auto key =
+        pmp_rosetta::detail::result_key(mesh, "adaptive_remeshing", min_edge_length,
+                                        max_edge_length, approx_error, iterations, use_projection);
+    return cache.apply(key, mesh, [&](pmp::SurfaceMesh &m) {
+        pmp::adaptive_remeshing(m, min_edge_length, max_edge_length, approx_error, iterations,
+                                use_projection);
+    });
+}
+
+inline bool cached_decimate(pmp::SurfaceMesh &mesh, ResultCache &cache, unsigned int n_vertices,
+                            pmp::Scalar aspect_ratio, pmp::Scalar edge_length,
+                            unsigned int max_valence, pmp::Scalar normal_deviation,
+                            pmp::Scalar hausdorff_error, pmp::Scalar seam_threshold,
+                            pmp::Scalar seam_angle_deviation) {
+    const auto key = pmp_rosetta::detail::result_key(
+        mesh, "decimate", n_vertices, aspect_ratio, edge_length, max_valence, normal_deviation,
+        hausdorff_error, seam_threshold, seam_angle_deviation);
+    return cache.apply(key, mesh, [&](pmp::SurfaceMesh &m) {
+        pmp::decimate(m, n_vertices, aspect_ratio, edge_length, max_valence, normal_deviation,
+                      hausdorff_error, seam_threshold, seam_angle_deviation);
+    });
+}
+
+inline bool cached_loop_subdivision(pmp::SurfaceMesh &mesh, ResultCache &cache,
+                                    pmp::BoundaryHandling boundary_handling) {
+    const auto key = pmp_rosetta::detail::result_key(mesh, "loop_subdivision", boundary_handling);
+    return cache.apply(key, mesh, [&](pmp::SurfaceMesh &m) {
+        pmp::loop_subdivision(m, boundary_handling);
+    });
+}
+
+inline bool cached_catmull_clark_subdivision(pmp::SurfaceMesh &mesh, ResultCache &cache,
+                                             pmp::BoundaryHandling boundary_handling) {
+    const auto key =
+        pmp_rosetta::detail::result_key(mesh, "catmull_clark_subdivision", boundary_handling);
+    return cache.apply(key, mesh, [&](pmp::SurfaceMesh &m) {
+        pmp::catmull_clark_subdivision(m, boundary_handling);
+    });
+}
+
+inline bool cached_quad_tri_subdivision(pmp::SurfaceMesh &mesh, ResultCache &cache,
+                                        pmp::BoundaryHandling boundary_handling) {
+    const auto key =
+        pmp_rosetta::detail::result_key(mesh, "quad_tri_subdivision", boundary_handling);
+    return cache.apply(key, mesh, [&](pmp::SurfaceMesh &m) {
+        pmp::quad_tri_subdivision(m, boundary_handling);
+    });
+}
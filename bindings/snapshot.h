@@ -0,0 +1,493 @@
+// ============================================================================
+// Memory-mapped binary mesh snapshots
+// ============================================================================
+// A snapshot stores the SurfaceMesh property arrays as they are in memory:
+// halfedge connectivity, "v:point" and every custom vertex/halfedge/edge/face
+// property of a supported type (bool, int, unsigned int, float, double and
+// 2/3-vectors of float or double), plus a face corner list (CSR) for
+// renderers. Every array starts on a 64-byte boundary.
+//
+// - MeshSnapshot maps a file in O(1) with copy-on-write pages: the arrays can
+//   be viewed (and edited) without touching the file or building a mesh.
+// - open_snapshot() rebuilds a SurfaceMesh from the mapped arrays directly,
+//   without parsing or rebuilding connectivity face by face: the elements
+//   are allocated once, their links set from the stored ones, and positions
+//   and properties memcpy()ed into their property vectors.
+//
+// Loading into a SurfaceMesh is an O(n) copy, not a mapping: by design, as
+// SurfaceMesh owns its arrays and cannot adopt the pages of a file. Code
+// that only reads the arrays can use MeshSnapshot's views and skip it.
+//
+// The format uses the native byte order, scalar and index sizes; files are
+// rejected by builds where any of these differ.
+// ============================================================================
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "mapped_file.h"
+#include "mesh_allocator.h"
+#include "mesh_buffers.h"
+
+namespace pmp_rosetta::detail {
+
+    constexpr char          snapshot_magic[8]  = {'P', 'M', 'P', 'S', 'N', 'A', 'P', '1'};
+    constexpr std::uint32_t snapshot_version   = 1;
+    constexpr std::uint32_t snapshot_byteorder = 0x01020304;
+    constexpr std::size_t   snapshot_alignment = 64;
+
+    struct SnapshotHeader {
+        char          magic[8];
+        std::uint32_t version;
+        std::uint32_t byteorder;
+        std::uint32_t scalar_size;
+        std::uint32_t index_size;
+        std::uint64_t n_vertices;
+        std::uint64_t n_edges;
+        std::uint64_t n_faces;
+        std::uint64_t n_sections;
+    };
+
+    enum class SnapshotType : std::uint8_t {
+        Float32 = 1,
+        Float64 = 2,
+        Int32   = 3,
+        UInt32  = 4,
+        Bool    = 5, // one byte per element
+        UInt64  = 6,
+    };
+
+    // One array of the file. kind is 'v', 'h', 'e' or 'f' for mesh
+    // properties; internal arrays have kind 0 and a name starting with '@'.
+    struct SnapshotSection {
+        char          name[64];
+        std::uint8_t  kind;
+        SnapshotType  type;
+        std::uint16_t components;
+        std::uint32_t reserved;
+        std::uint64_t offset; // from the start of the file
+        std::uint64_t size;   // in bytes
+    };
+
+    static_assert(sizeof(SnapshotHeader) == 56 && sizeof(SnapshotSection) == 88,
+                  "snapshot layout must not depend on the compiler");
+
+    template <typename T> struct SnapshotTraits;
+
+    template <> struct SnapshotTraits<float> {
+        static constexpr SnapshotType  type       = SnapshotType::Float32;
+        static constexpr std::uint16_t components = 1;
+    };
+    template <> struct SnapshotTraits<double> {
+        static constexpr SnapshotType  type       = SnapshotType::Float64;
+        static constexpr std::uint16_t components = 1;
+    };
+    template <> struct SnapshotTraits<int> {
+        static constexpr SnapshotType  type       = SnapshotType::Int32;
+        static constexpr std::uint16_t components = 1;
+    };
+    template <> struct SnapshotTraits<unsigned int> {
+        static constexpr SnapshotType  type       = SnapshotType::UInt32;
+        static constexpr std::uint16_t components = 1;
+    };
+    template <> struct SnapshotTraits<std::uint64_t> {
+        static constexpr SnapshotType  type       = SnapshotType::UInt64;
+        static constexpr std::uint16_t components = 1;
+    };
+    template <> struct SnapshotTraits<bool> {
+        static constexpr SnapshotType  type       = SnapshotType::Bool;
+        static constexpr std::uint16_t components = 1;
+    };
+    template <typename S, int M> struct SnapshotTraits<pmp::Matrix<S, M, 1>> {
+        static_assert(sizeof(pmp::Matrix<S, M, 1>) == M * sizeof(S));
+        static constexpr SnapshotType  type       = SnapshotTraits<S>::type;
+        static constexpr std::uint16_t components = M;
+    };
+
+    inline std::size_t align_up(std::size_t n) {
+        return (n + snapshot_alignment - 1) / snapshot_alignment * snapshot_alignment;
+    }
+
+    // Number of elements of a given kind
+    inline std::size_t element_count(const SnapshotHeader &header, char kind) {
+        switch (kind) {
+            case 'v':
+                return header.n_vertices;
+            case 'h':
+                return 2 * header.n_edges;
+            case 'e':
+                return header.n_edges;
+            case 'f':
+                return header.n_faces;
+        }
+        return 0;
+    }
+
+} // namespace pmp_rosetta::detail
+
+// A snapshot file mapped in memory. Opening is O(1); arrays are exposed by
+// address (valid while the snapshot object is alive) and use copy-on-write
+// pages, so writing through them never modifies the file.
+class MeshSnapshot {
+public:
+    MeshSnapshot() = default;
+
+    explicit MeshSnapshot(const std::string &path)
+        : file_(std::make_shared<pmp_rosetta::MappedFile>(path)) {
+        using namespace pmp_rosetta::detail;
+
+        if (file_->size() < sizeof(SnapshotHeader)) {
+            throw pmp::IOException("Not a mesh snapshot: " + path);
+        }
+        header_ = reinterpret_cast<const SnapshotHeader *>(file_->data());
+        if (std::memcmp(header_->magic, snapshot_magic, sizeof(snapshot_magic)) != 0 ||
+            header_->version != snapshot_version) {
+            throw pmp::IOException("Not a mesh snapshot: " + path);
+        }
+        if (header_->byteorder != snapshot_byteorder ||
+            header_->scalar_size != sizeof(pmp::Scalar) ||
+            header_->index_size != sizeof(pmp::IndexType)) {
+            throw pmp::IOException("Snapshot was written with an incompatible build: " + path);
+        }
+
+        // Bound the count first: n_sections * sizeof(SnapshotSection) can wrap
+        if (header_->n_sections >
+            (file_->size() - sizeof(SnapshotHeader)) / sizeof(SnapshotSection)) {
+            throw pmp::IOException("Truncated snapshot: " + path);
+        }
+        sections_ = reinterpret_cast<const SnapshotSection *>(file_->data() +
+                                                             sizeof(SnapshotHeader));
+        for (std::size_t i = 0; i < header_->n_sections; ++i) {
+            const auto &s = sections_[i];
+            if (s.offset > file_->size() || s.size > file_->size() - s.offset ||
+                s.name[sizeof(s.name) - 1] != '\0') {
+                throw pmp::IOException("Corrupted snapshot: " + path);
+            }
+        }
+    }
+
+    std::size_t n_vertices() const { return header_ ? header_->n_vertices : 0; }
+    std::size_t n_edges() const { return header_ ? header_->n_edges : 0; }
+    std::size_t n_faces() const { return header_ ? header_->n_faces : 0; }
+
+    // Number of face corners, i.e. the size of the face_indices array
+    std::size_t n_face_indices() const {
+        const auto *s = find("@face_indices", 0);
+        return s ? s->size / sizeof(pmp::IndexType) : 0;
+    }
+
+    // n_vertices() rows of 3 pmp::Scalar
+    std::uintptr_t points_address() const {
+        return address(array<pmp::Scalar>("v:point", 'v', 3 * n_vertices()));
+    }
+
+    // n_faces() + 1 CSR offsets into face_indices (pmp::IndexType)
+    std::uintptr_t face_offsets_address() const {
+        return address(array<pmp::IndexType>("@face_offsets", 0, n_faces() + 1));
+    }
+
+    // n_face_indices() vertex indices (pmp::IndexType), face after face
+    std::uintptr_t face_indices_address() const {
+        return address(array<pmp::IndexType>("@face_indices", 0, n_face_indices()));
+    }
+
+    // Stored custom properties, e.g. "v:curv" or "e:feature"
+    std::vector<std::string> property_names() const {
+        std::vector<std::string> names;
+        for (std::size_t i = 0; header_ && i < header_->n_sections; ++i) {
+            if (sections_[i].kind != 0 && std::strcmp(sections_[i].name, "v:point") != 0) {
+                names.emplace_back(sections_[i].name);
+            }
+        }
+        return names;
+    }
+
+    // Rebuild a full SurfaceMesh (cleared first) from the mapped arrays
+    void to_mesh(pmp::SurfaceMesh &mesh) const {
+        using namespace pmp_rosetta::detail;
+
+        const std::size_t nv = n_vertices();
+        const std::size_t ne = n_edges();
+        const std::size_t nh = 2 * ne;
+        const std::size_t nf = n_faces();
+
+        const auto *points     = array<pmp::Scalar>("v:point", 'v', 3 * nv);
+        const auto *v_halfedge = array<pmp::IndexType>("@vertex_halfedge", 0, nv);
+        const auto *h_vertex   = array<pmp::IndexType>("@halfedge_vertex", 0, nh);
+        const auto *h_next     = array<pmp::IndexType>("@halfedge_next", 0, nh);
+        const auto *h_face     = array<pmp::IndexType>("@halfedge_face", 0, nh);
+        const auto *f_halfedge = array<pmp::IndexType>("@face_halfedge", 0, nf);
+
+        // Reject out-of-range handles before they reach the mesh
+        auto check = [](const pmp::IndexType *a, std::size_t n, std::size_t bound,
+                        bool allow_invalid) {
+            for (std::size_t i = 0; i < n; ++i) {
+                if (a[i] >= bound && !(allow_invalid && a[i] == PMP_MAX_INDEX)) {
+                    throw pmp::IOException("Corrupted snapshot: handle out of range");
+                }
+            }
+        };
+        check(v_halfedge, nv, nh, true);
+        check(h_vertex, nh, nv, false);
+        check(h_next, nh, nh, false);
+        check(h_face, nh, nf, true);
+        check(f_halfedge, nf, nh, false);
+
+        mesh.clear();
+        mesh.reserve(nv, ne, nf);
+
+        for (std::size_t v = 0; v < nv; ++v) {
+            SurfaceMeshAllocator::allocate_vertex(mesh);
+        }
+        if (nv > 0) {
+            std::memcpy(static_cast<void *>(mesh.positions().data()), points,
+                        3 * nv * sizeof(pmp::Scalar));
+        }
+        for (std::size_t e = 0; e < ne; ++e) {
+            SurfaceMeshAllocator::allocate_edge(mesh, pmp::Vertex(h_vertex[2 * e + 1]),
+                                                pmp::Vertex(h_vertex[2 * e]));
+        }
+        for (std::size_t f = 0; f < nf; ++f) {
+            SurfaceMeshAllocator::allocate_face(mesh);
+        }
+
+        for (std::size_t h = 0; h < nh; ++h) {
+            const auto hh = pmp::Halfedge(pmp::IndexType(h));
+            mesh.set_next_halfedge(hh, pmp::Halfedge(h_next[h]));
+            if (h_face[h] != PMP_MAX_INDEX) {
+                mesh.set_face(hh, pmp::Face(h_face[h]));
+            }
+        }
+        for (std::size_t v = 0; v < nv; ++v) {
+            if (v_halfedge[v] != PMP_MAX_INDEX) {
+                mesh.set_halfedge(pmp::Vertex(pmp::IndexType(v)), pmp::Halfedge(v_halfedge[v]));
+            }
+        }
+        for (std::size_t f = 0; f < nf; ++f) {
+            mesh.set_halfedge(pmp::Face(pmp::IndexType(f)), pmp::Halfedge(f_halfedge[f]));
+        }
+
+        for (std::size_t i = 0; i < header_->n_sections; ++i) {
+            const auto &s = sections_[i];
+            if (s.kind != 0 && std::strcmp(s.name, "v:point") != 0) {
+                restore_property(mesh, s);
+            }
+        }
+    }
+
+private:
+    const pmp_rosetta::detail::SnapshotSection *find(const char *name, std::uint8_t kind) const {
+        for (std::size_t i = 0; header_ && i < header_->n_sections; ++i) {
+            if (sections_[i].kind == kind && std::strcmp(sections_[i].name, name) == 0) {
+                return &sections_[i];
+            }
+        }
+        return nullptr;
+    }
+
+    // Typed pointer to a section holding exactly `count` values of T
+    template <typename T>
+    T *array(const char *name, std::uint8_t kind, std::size_t count) const {
+        const auto *s = find(name, kind);
+        if (!s || s->size != count * sizeof(T)) {
+            throw pmp::IOException(std::string("Corrupted snapshot: bad array ") + name);
+        }
+        return reinterpret_cast<T *>(file_->data() + s->offset);
+    }
+
+    static std::uintptr_t address(const void *p) { return reinterpret_cast<std::uintptr_t>(p); }
+
+    void restore_property(pmp::SurfaceMesh                          &mesh,
+                          const pmp_rosetta::detail::SnapshotSection &s) const {
+        using namespace pmp_rosetta::detail;
+
+        const char  kind  = char(s.kind);
+        const auto  count = element_count(*header_, kind);
+        const char *data  = file_->data() + s.offset;
+
+        find_type(SnapshotTypes{}, [&](auto tag) {
+            using T = typename decltype(tag)::type;
+            if (SnapshotTraits<T>::type != s.type ||
+                SnapshotTraits<T>::components != s.components) {
+                return false;
+            }
+            const auto element_size = std::is_same_v<T, bool> ? 1 : sizeof(T);
+            if (s.size != count * element_size) {
+                throw pmp::IOException(std::string("Corrupted snapshot: bad property ") + s.name);
+            }
+            auto &values = make_property_vector<T>(mesh, kind, s.name);
+            if constexpr (std::is_same_v<T, bool>) {
+                for (std::size_t i = 0; i < count; ++i) {
+                    values[i] = data[i] != 0;
+                }
+            } else {
+                std::memcpy(static_cast<void *>(values.data()), data, s.size);
+            }
+            return true;
+        });
+    }
+
+    std::shared_ptr<pmp_rosetta::MappedFile>         file_;
+    const pmp_rosetta::detail::SnapshotHeader       *header_   = nullptr;
+    const pmp_rosetta::detail::SnapshotSection      *sections_ = nullptr;
+};
+
+// Write a snapshot of a mesh. A mesh holding deleted elements is compacted
+// on a copy first, the mesh itself is left untouched.
+inline void save_snapshot(const pmp::SurfaceMesh &mesh, const std::filesystem::path &path) {
+    using namespace pmp_rosetta::detail;
+
+    if (mesh.has_garbage()) {
+        pmp::SurfaceMesh compact(mesh);
+        compact.garbage_collection();
+        save_snapshot(compact, path);
+        return;
+    }
+
+    const std::size_t nv = mesh.n_vertices();
+    const std::size_t ne = mesh.n_edges();
+    const std::size_t nh = mesh.n_halfedges();
+    const std::size_t nf = mesh.n_faces();
+
+    // Connectivity, flattened into index arrays
+    std::vector<pmp::IndexType> v_halfedge(nv), h_vertex(nh), h_next(nh), h_face(nh),
+        f_halfedge(nf);
+    for (auto v : mesh.vertices()) {
+        v_halfedge[v.idx()] = mesh.halfedge(v).idx();
+    }
+    for (auto h : mesh.halfedges()) {
+        h_vertex[h.idx()] = mesh.to_vertex(h).idx();
+        h_next[h.idx()]   = mesh.next_halfedge(h).idx();
+        h_face[h.idx()]   = mesh.face(h).idx();
+    }
+    for (auto f : mesh.faces()) {
+        f_halfedge[f.idx()] = mesh.halfedge(f).idx();
+    }
+
+    std::vector<pmp::IndexType> face_offsets(nf + 1), face_indices(n_face_indices(mesh));
+    export_faces(mesh, reinterpret_cast<std::uintptr_t>(face_indices.data()), face_indices.size(),
+                 reinterpret_cast<std::uintptr_t>(face_offsets.data()), face_offsets.size(),
+                 false);
+
+    struct Pending {
+        SnapshotSection  section;
+        const char      *data;
+        std::vector<char> bytes; // owned storage, used when data is null
+    };
+    std::vector<Pending> pending;
+
+    auto add = [&](const std::string &name, char kind, SnapshotType type,
+                   std::uint16_t components, const void *data, std::size_t size) {
+        if (name.size() >= sizeof(SnapshotSection::name)) {
+            throw pmp::InvalidInputException("save_snapshot: property name too long: " + name);
+        }
+        Pending p{};
+        std::strncpy(p.section.name, name.c_str(), sizeof(p.section.name) - 1);
+        p.section.kind       = std::uint8_t(kind);
+        p.section.type       = type;
+        p.section.components = components;
+        p.section.size       = size;
+        p.data               = static_cast<const char *>(data);
+        pending.push_back(std::move(p));
+    };
+
+    constexpr auto index_type = SnapshotTraits<pmp::IndexType>::type;
+    add("@vertex_halfedge", 0, index_type, 1, v_halfedge.data(), nv * sizeof(pmp::IndexType));
+    add("@halfedge_vertex", 0, index_type, 1, h_vertex.data(), nh * sizeof(pmp::IndexType));
+    add("@halfedge_next", 0, index_type, 1, h_next.data(), nh * sizeof(pmp::IndexType));
+    add("@halfedge_face", 0, index_type, 1, h_face.data(), nh * sizeof(pmp::IndexType));
+    add("@face_halfedge", 0, index_type, 1, f_halfedge.data(), nf * sizeof(pmp::IndexType));
+    add("@face_offsets", 0, index_type, 1, face_offsets.data(),
+        face_offsets.size() * sizeof(pmp::IndexType));
+    add("@face_indices", 0, index_type, 1, face_indices.data(),
+        face_indices.size() * sizeof(pmp::IndexType));
+
+    // "v:point" and the custom properties of supported types
+    for (char kind : {'v', 'h', 'e', 'f'}) {
+        for (const auto &name : property_names(mesh, kind)) {
+            if (is_builtin_property(name) && name != "v:point") {
+                continue;
+            }
+            find_type(SnapshotTypes{}, [&](auto tag) {
+                using T      = typename decltype(tag)::type;
+                auto *values = property_vector<T>(mesh, kind, name);
+                if (!values) {
+                    return false;
+                }
+                using Traits = SnapshotTraits<T>;
+                if constexpr (std::is_same_v<T, bool>) {
+                    add(name, kind, Traits::type, Traits::components, nullptr, values->size());
+                    auto &bytes = pending.back().bytes;
+                    bytes.resize(values->size());
+                    for (std::size_t i = 0; i < values->size(); ++i) {
+                        bytes[i] = (*values)[i] ? 1 : 0;
+                    }
+                } else {
+                    add(name, kind, Traits::type, Traits::components, values->data(),
+                        values->size() * sizeof(T));
+                }
+                return true;
+            });
+        }
+    }
+
+    // Layout: header, section table, then 64-byte aligned arrays
+    SnapshotHeader header{};
+    std::memcpy(header.magic, snapshot_magic, sizeof(snapshot_magic));
+    header.version     = snapshot_version;
+    header.byteorder   = snapshot_byteorder;
+    header.scalar_size = sizeof(pmp::Scalar);
+    header.index_size  = sizeof(pmp::IndexType);
+    header.n_vertices  = nv;
+    header.n_edges     = ne;
+    header.n_faces     = nf;
+    header.n_sections  = pending.size();
+
+    std::size_t offset = align_up(sizeof(SnapshotHeader) + pending.size() * sizeof(SnapshotSection));
+    for (auto &p : pending) {
+        p.section.offset = offset;
+        offset           = align_up(offset + p.section.size);
+    }
+
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        throw pmp::IOException("Failed to open file: " + path.string());
+    }
+
+    out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    for (const auto &p : pending) {
+        out.write(reinterpret_cast<const char *>(&p.section), sizeof(p.section));
+    }
+
+    const std::vector<char> padding(snapshot_alignment, 0);
+    std::size_t             position =
+        sizeof(SnapshotHeader) + pending.size() * sizeof(SnapshotSection);
+    for (const auto &p : pending) {
+        out.write(padding.data(), std::streamsize(p.section.offset - position));
+        const char *data = p.data ? p.data : p.bytes.data();
+        out.write(data, std::streamsize(p.section.size));
+        position = p.section.offset + p.section.size;
+    }
+    // Pad the file so that the last array can be read by whole cache lines
+    out.write(padding.data(), std::streamsize(align_up(position) - position));
+
+    if (!out) {
+        throw pmp::IOException("Failed to write snapshot: " + path.string());
+    }
+}
+
+// Read a snapshot into mesh, without parsing or rebuilding connectivity
+inline void open_snapshot(pmp::SurfaceMesh &mesh, const std::filesystem::path &path) {
+    MeshSnapshot(path.string()).to_mesh(mesh);
+}
@@ -0,0 +1,547 @@
+// ============================================================================
+// Parallel subdivision
+// ============================================================================
+// pmp::loop_subdivision(), catmull_clark_subdivision() and
+// quad_tri_subdivision() refine a mesh in place: every edge split and every
+// face split is a topology edit that grows the property arrays one element
+// at a time. The refined mesh only depends on the input, though: each edge
+// gets a midpoint vertex, each face is cut into triangles between its edge
+// midpoints or into quads around a center vertex, so all element counts are
+// known up front. The functions here allocate the refined mesh once, then
+// fill in its connectivity and positions in parallel passes over the input
+// edges, faces and vertices, each writing only the elements it creates.
+//
+// The positions are those of the PMP functions, and so is the vertex
+// numbering: input vertices, then the midpoint of each edge in edge order,
+// then face centers in face order. Edges and faces are numbered by the input
+// element they come from. "v:feature" / "e:feature" flags are carried over,
+// both halves of a split feature edge staying features. Meshes with deleted
+// elements or with other properties, which the rebuild would lose, go
+// through the PMP functions.
+//
+// The refined mesh is built apart from the input, which it reads, then
+// assigned to it, so property handles taken before the call are invalidated.
+// ============================================================================
+#pragma once
+
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <vector>
+
+#include <pmp/algorithms/subdivision.h>
+#include <pmp/surface_mesh.h>
+
+#include "garbage_collection.h"
+#include "mesh_allocator.h"
+#include "mesh_buffers.h"
+#include "parallel.h"
+#include "profiling.h"
+
+namespace pmp_rosetta::detail {
+
+    // The halves of input halfedge h in the refined mesh: from its start to
+    // the midpoint of its edge, then on to its end. Edge e is split into
+    // edges 2e (on the side of its vertex 0) and 2e + 1.
+    inline pmp::Halfedge first_half(pmp::Halfedge h) {
+        const auto e = h.idx() >> 1;
+        return pmp::Halfedge(h.idx() & 1 ? 4 * e + 3 : 4 * e);
+    }
+
+    inline pmp::Halfedge second_half(pmp::Halfedge h) {
+        const auto e = h.idx() >> 1;
+        return pmp::Halfedge(h.idx() & 1 ? 4 * e + 1 : 4 * e + 2);
+    }
+
+    // Whether the refined mesh can be rebuilt with all the properties of
+    // mesh: positions and feature flags only, no deleted elements
+    inline bool rebuildable(const pmp::SurfaceMesh &mesh) {
+        if (mesh.has_garbage()) {
+            return false;
+        }
+        for (char kind : {'v', 'h', 'e', 'f'}) {
+            for (const auto &name : property_names(mesh, kind)) {
+                const bool feature = (name == "v:feature" || name == "e:feature") &&
+                                     property_vector<bool>(mesh, kind, name) != nullptr;
+                if (!is_connectivity_property(name) && !is_deleted_flag(name) &&
+                    name != "v:point" && !feature) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Refined connectivity of mesh, with positions left to the caller: edges
+    // are split at their midpoints, and faces for which has_center(f,
+    // valence) holds are cut into quads around a new center vertex, the
+    // others (triangles) into four triangles.
+    struct Refinement {
+        pmp::SurfaceMesh            mesh;
+        std::vector<pmp::IndexType> centers; // center vertex of each input face, or PMP_MAX_INDEX
+    };
+
+    template <typename HasCenter>
+    inline Refinement refine(const pmp::SurfaceMesh &mesh, HasCenter &&has_center,
+                             unsigned int n_threads) {
+        ProfileScope scope("subdivision.topology");
+
+        const std::size_t nv = mesh.vertices_size();
+        const std::size_t ne = mesh.edges_size();
+        const std::size_t nf = mesh.faces_size();
+
+        std::vector<std::size_t> valence(nf);
+        std::vector<char>        center(nf);
+        pmp_rosetta::parallel_for(
+            0, nf,
+            [&](std::size_t i) {
+                const auto f = pmp::Face(pmp::IndexType(i));
+                valence[i]   = mesh.valence(f);
+                center[i]    = has_center(f, valence[i]);
+            },
+            n_threads);
+
+        // A face of valence k adds k inner edges, and k + 1 faces when cut
+        // into triangles, k when cut into quads
+        Refinement               r;
+        std::vector<std::size_t> corners(nf + 1, 0), faces(nf + 1, 0);
+        std::size_t              n_vertices = nv + ne;
+        r.centers.assign(nf, PMP_MAX_INDEX);
+        for (std::size_t i = 0; i < nf; ++i) {
+            corners[i + 1] = corners[i] + valence[i];
+            faces[i + 1]   = faces[i] + valence[i] + (center[i] ? 0 : 1);
+            if (center[i]) {
+                r.centers[i] = pmp::IndexType(n_vertices++);
+            }
+        }
+
+        auto &result = r.mesh;
+        result.reserve(n_vertices, 2 * ne + corners[nf], faces[nf]);
+        for (std::size_t i = 0; i < n_vertices; ++i) {
+            SurfaceMeshAllocator::allocate_vertex(result);
+        }
+        for (std::size_t i = 0; i < 2 * ne + corners[nf]; ++i) {
+            SurfaceMeshAllocator::allocate_edge(result, pmp::Vertex(0), pmp::Vertex(0));
+        }
+        for (std::size_t i = 0; i < faces[nf]; ++i) {
+            SurfaceMeshAllocator::allocate_face(result);
+        }
+
+        // Split edges; boundary halves are linked here, the others by their face
+        pmp_rosetta::parallel_for(
+            0, ne,
+            [&](std::size_t e) {
+                const auto mid = pmp::Vertex(pmp::IndexType(nv + e));
+                for (pmp::IndexType side = 0; side < 2; ++side) {
+                    const auto h = pmp::Halfedge(pmp::IndexType(2 * e) + side);
+                    result.set_vertex(first_half(h), mid);
+                    result.set_vertex(second_half(h), mesh.to_vertex(h));
+                    if (mesh.is_boundary(h)) {
+                        result.set_next_halfedge(first_half(h), second_half(h));
+                        result.set_next_halfedge(second_half(h),
+                                                 first_half(mesh.next_halfedge(h)));
+                    }
+                }
+                // A boundary vertex starts from its boundary halfedge
+                const auto h1 = pmp::Halfedge(pmp::IndexType(2 * e + 1));
+                result.set_halfedge(mid, second_half(mesh.is_boundary(h1)
+                                                         ? h1
+                                                         : mesh.opposite_halfedge(h1)));
+            },
+            n_threads);
+
+        pmp_rosetta::parallel_for(
+            0, nv,
+            [&](std::size_t i) {
+                const auto v = pmp::Vertex(pmp::IndexType(i));
+                const auto h = mesh.halfedge(v);
+                if (h.is_valid()) {
+                    result.set_halfedge(v, first_half(h));
+                }
+            },
+            n_threads);
+
+        // Split faces. Corner j of face f (halfedge h, preceded by prev) gets
+        // inner edge j: from the midpoint of h to that of prev in a triangle
+        // cut, from the midpoint of h to the center in a quad cut
+        pmp_rosetta::parallel_for(
+            0, nf,
+            [&](std::size_t i) {
+                const auto f     = pmp::Face(pmp::IndexType(i));
+                const auto k     = valence[i];
+                const auto inner = [&](std::size_t j) {
+                    return pmp::Halfedge(pmp::IndexType(2 * (2 * ne + corners[i] + j % k)));
+                };
+                const auto opposite = [&](pmp::Halfedge h) { return result.opposite_halfedge(h); };
+
+                auto h    = mesh.halfedge(f);
+                auto prev = mesh.prev_halfedge(h);
+                for (std::size_t j = 0; j < k; ++j) {
+                    const auto mid      = pmp::Vertex(pmp::IndexType(nv + h.idx() / 2));
+                    const auto prev_mid = pmp::Vertex(pmp::IndexType(nv + prev.idx() / 2));
+                    const auto a        = first_half(h);
+                    const auto b        = second_half(prev);
+                    const auto t        = inner(j);
+                    const auto g        = pmp::Face(pmp::IndexType(faces[i] + j));
+
+                    result.set_next_halfedge(b, a);
+                    result.set_next_halfedge(a, t);
+                    result.set_face(a, g);
+                    result.set_face(b, g);
+                    result.set_face(t, g);
+                    result.set_halfedge(g, a);
+                    result.set_vertex(opposite(t), mid);
+                    if (!center[i]) {
+                        // Corner triangle, and the middle one through opposite(t)
+                        const auto middle = pmp::Face(pmp::IndexType(faces[i] + k));
+                        result.set_next_halfedge(t, b);
+                        result.set_vertex(t, prev_mid);
+                        result.set_next_halfedge(opposite(t), opposite(inner(j + 1)));
+                        result.set_face(opposite(t), middle);
+                    } else {
+                        const auto u = opposite(inner(j + k - 1));
+                        result.set_next_halfedge(t, u);
+                        result.set_next_halfedge(u, b);
+                        result.set_face(u, g);
+                        result.set_vertex(t, pmp::Vertex(r.centers[i]));
+                    }
+                    prev = h;
+                    h    = mesh.next_halfedge(h);
+                }
+                if (!center[i]) {
+                    result.set_halfedge(pmp::Face(pmp::IndexType(faces[i] + k)),
+                                        opposite(inner(0)));
+                } else {
+                    result.set_halfedge(pmp::Vertex(r.centers[i]), opposite(inner(0)));
+                }
+            },
+            n_threads);
+
+        // Input flags stay on input vertices and on both halves of input
+        // edges; midpoints of feature edges become feature vertices.
+        // Bit-packed: set on one thread.
+        auto vfeature = mesh.get_vertex_property<bool>("v:feature");
+        auto efeature = mesh.get_edge_property<bool>("e:feature");
+        if (vfeature) {
+            auto flags = result.add_vertex_property<bool>("v:feature", false);
+            for (std::size_t i = 0; i < nv; ++i) {
+                flags[pmp::Vertex(pmp::IndexType(i))] = vfeature[pmp::Vertex(pmp::IndexType(i))];
+            }
+            if (efeature) {
+                for (std::size_t e = 0; e < ne; ++e) {
+                    flags[pmp::Vertex(pmp::IndexType(nv + e))] =
+                        efeature[pmp::Edge(pmp::IndexType(e))];
+                }
+            }
+        }
+        if (efeature) {
+            auto flags = result.add_edge_property<bool>("e:feature", false);
+            for (std::size_t e = 0; e < ne; ++e) {
+                const bool feature = efeature[pmp::Edge(pmp::IndexType(e))];
+                flags[pmp::Edge(pmp::IndexType(2 * e))]     = feature;
+                flags[pmp::Edge(pmp::IndexType(2 * e + 1))] = feature;
+            }
+        }
+        return r;
+    }
+
+    // Loop and Catmull-Clark boundary rule, or the input position when
+    // boundaries are preserved
+    inline pmp::Point boundary_point(const pmp::SurfaceMesh &mesh, pmp::Vertex v,
+                                     pmp::BoundaryHandling boundary_handling) {
+        if (boundary_handling == pmp::BoundaryHandling::Preserve) {
+            return mesh.position(v);
+        }
+        const auto h1 = mesh.halfedge(v);
+        const auto h0 = mesh.prev_halfedge(h1);
+        pmp::Point p  = mesh.position(v);
+        p *= 6.0;
+        p += mesh.position(mesh.to_vertex(h1));
+        p += mesh.position(mesh.from_vertex(h0));
+        p *= 0.125;
+        return p;
+    }
+
+    // Interior feature vertex on exactly two feature edges: crease rule;
+    // corners and darts keep their position
+    inline pmp::Point feature_point(const pmp::SurfaceMesh &mesh, pmp::Vertex v,
+                                    const pmp::EdgeProperty<bool> &efeature) {
+        pmp::Point p = mesh.position(v);
+        p *= 6.0;
+        int count = 0;
+        for (auto h : mesh.halfedges(v)) {
+            if (efeature[mesh.edge(h)]) {
+                p += mesh.position(mesh.to_vertex(h));
+                ++count;
+            }
+        }
+        if (count != 2) {
+            return mesh.position(v);
+        }
+        return p * 0.125;
+    }
+
+    inline pmp::Point face_centroid(const pmp::SurfaceMesh &mesh, pmp::Face f) {
+        pmp::Point  c(0, 0, 0);
+        pmp::Scalar n(0);
+        for (auto v : mesh.vertices(f)) {
+            c += mesh.position(v);
+            ++n;
+        }
+        return c / n;
+    }
+
+    inline pmp::Point midpoint(const pmp::SurfaceMesh &mesh, pmp::Edge e) {
+        return 0.5f * (mesh.position(mesh.vertex(e, 0)) + mesh.position(mesh.vertex(e, 1)));
+    }
+
+} // namespace pmp_rosetta::detail
+
+// pmp::loop_subdivision() of a triangle mesh, with the refined mesh built in
+// parallel over n_threads threads (0: all cores)
+inline void parallel_loop_subdivision(pmp::SurfaceMesh     &mesh,
+                                      pmp::BoundaryHandling boundary_handling,
+                                      unsigned int          n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    if (!mesh.is_triangle_mesh() || !rebuildable(mesh)) {
+        pmp::loop_subdivision(mesh, boundary_handling);
+        return;
+    }
+    const auto vfeature = mesh.get_vertex_property<bool>("v:feature");
+    const auto efeature = mesh.get_edge_property<bool>("e:feature");
+    const auto nv       = mesh.vertices_size();
+
+    auto  r = refine(mesh, [](pmp::Face, std::size_t) { return false; }, n_threads);
+    auto &points = r.mesh.positions();
+
+    pmp_rosetta::ProfileScope scope("subdivision.points");
+    pmp_rosetta::parallel_for(
+        0, nv,
+        [&](std::size_t i) {
+            const auto v = pmp::Vertex(pmp::IndexType(i));
+            if (mesh.is_isolated(v)) {
+                points[i] = mesh.position(v);
+            } else if (mesh.is_boundary(v)) {
+                points[i] = boundary_point(mesh, v, boundary_handling);
+            } else if (vfeature && vfeature[v]) {
+                points[i] = feature_point(mesh, v, efeature);
+            } else {
+                pmp::Point  p(0, 0, 0);
+                pmp::Scalar k(0);
+                for (auto vv : mesh.vertices(v)) {
+                    p += mesh.position(vv);
+                    ++k;
+                }
+                p /= k;
+                const pmp::Scalar beta =
+                    (0.625 - std::pow(0.375 + 0.25 * std::cos(2.0 * std::numbers::pi / k), 2.0));
+                points[i] = mesh.position(v) * (pmp::Scalar)(1.0 - beta) + beta * p;
+            }
+        },
+        n_threads);
+    pmp_rosetta::parallel_for(
+        0, mesh.edges_size(),
+        [&](std::size_t i) {
+            const auto e = pmp::Edge(pmp::IndexType(i));
+            if (mesh.is_boundary(e) || (efeature && efeature[e])) {
+                points[nv + i] = midpoint(mesh, e);
+            } else {
+                const auto h0 = mesh.halfedge(e, 0);
+                const auto h1 = mesh.halfedge(e, 1);
+                pmp::Point p  = mesh.position(mesh.to_vertex(h0));
+                p += mesh.position(mesh.to_vertex(h1));
+                p *= 3.0;
+                p += mesh.position(mesh.to_vertex(mesh.next_halfedge(h0)));
+                p += mesh.position(mesh.to_vertex(mesh.next_halfedge(h1)));
+                p *= 0.125;
+                points[nv + i] = p;
+            }
+        },
+        n_threads);
+
+    mesh = r.mesh;
+}
+
+// pmp::catmull_clark_subdivision(), with the refined mesh built in parallel
+// over n_threads threads (0: all cores)
+inline void parallel_catmull_clark_subdivision(pmp::SurfaceMesh     &mesh,
+                                               pmp::BoundaryHandling boundary_handling,
+                                               unsigned int          n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    if (!rebuildable(mesh)) {
+        pmp::catmull_clark_subdivision(mesh, boundary_handling);
+        return;
+    }
+    const auto vfeature = mesh.get_vertex_property<bool>("v:feature");
+    const auto efeature = mesh.get_edge_property<bool>("e:feature");
+    const auto nv       = mesh.vertices_size();
+    const auto ne       = mesh.edges_size();
+
+    auto  r = refine(mesh, [](pmp::Face, std::size_t) { return true; }, n_threads);
+    auto &points = r.mesh.positions();
+
+    // Face points first: edge and vertex points average them
+    pmp_rosetta::ProfileScope scope("subdivision.points");
+    const auto                fpoint = [&](pmp::Face f) -> const pmp::Point & {
+        return points[r.centers[f.idx()]];
+    };
+    pmp_rosetta::parallel_for(
+        0, mesh.faces_size(),
+        [&](std::size_t i) {
+            const auto f            = pmp::Face(pmp::IndexType(i));
+            points[r.centers[i]] = face_centroid(mesh, f);
+        },
+        n_threads);
+    pmp_rosetta::parallel_for(
+        0, ne,
+        [&](std::size_t i) {
+            const auto e = pmp::Edge(pmp::IndexType(i));
+            if (mesh.is_boundary(e) || (efeature && efeature[e])) {
+                points[nv + i] = midpoint(mesh, e);
+            } else {
+                pmp::Point p(0, 0, 0);
+                p += mesh.position(mesh.vertex(e, 0));
+                p += mesh.position(mesh.vertex(e, 1));
+                p += fpoint(mesh.face(e, 0));
+                p += fpoint(mesh.face(e, 1));
+                p *= 0.25f;
+                points[nv + i] = p;
+            }
+        },
+        n_threads);
+    pmp_rosetta::parallel_for(
+        0, nv,
+        [&](std::size_t i) {
+            const auto v = pmp::Vertex(pmp::IndexType(i));
+            if (mesh.is_isolated(v)) {
+                points[i] = mesh.position(v);
+            } else if (mesh.is_boundary(v)) {
+                points[i] = boundary_point(mesh, v, boundary_handling);
+            } else if (vfeature && vfeature[v]) {
+                points[i] = feature_point(mesh, v, efeature);
+            } else {
+                // Weights of "Subdivision Surfaces in Character Animation"
+                const pmp::Scalar k = mesh.valence(v);
+                pmp::Point        p(0, 0, 0);
+                for (auto vv : mesh.vertices(v)) {
+                    p += mesh.position(vv);
+                }
+                for (auto f : mesh.faces(v)) {
+                    p += fpoint(f);
+                }
+                p /= (k * k);
+                p += ((k - 2.0f) / k) * mesh.position(v);
+                points[i] = p;
+            }
+        },
+        n_threads);
+
+    mesh = r.mesh;
+}
+
+// pmp::quad_tri_subdivision(), with the refined mesh built in parallel over
+// n_threads threads (0: all cores)
+inline void parallel_quad_tri_subdivision(pmp::SurfaceMesh     &mesh,
+                                          pmp::BoundaryHandling boundary_handling,
+                                          unsigned int          n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    if (!rebuildable(mesh)) {
+        pmp::quad_tri_subdivision(mesh, boundary_handling);
+        return;
+    }
+    const auto nv = mesh.vertices_size();
+
+    // Triangles are cut into four triangles, other faces into quads
+    auto r = refine(mesh, [](pmp::Face, std::size_t valence) { return valence != 3; }, n_threads);
+
+    // Linear refinement first, then smoothing of the refined mesh
+    pmp_rosetta::ProfileScope scope("subdivision.points");
+    std::vector<pmp::Point>   linear(r.mesh.vertices_size());
+    pmp_rosetta::parallel_for(
+        0, nv, [&](std::size_t i) { linear[i] = mesh.position(pmp::Vertex(pmp::IndexType(i))); },
+        n_threads);
+    pmp_rosetta::parallel_for(
+        0, mesh.edges_size(),
+        [&](std::size_t i) { linear[nv + i] = midpoint(mesh, pmp::Edge(pmp::IndexType(i))); },
+        n_threads);
+    pmp_rosetta::parallel_for(
+        0, mesh.faces_size(),
+        [&](std::size_t i) {
+            if (r.centers[i] != PMP_MAX_INDEX) {
+                linear[r.centers[i]] = face_centroid(mesh, pmp::Face(pmp::IndexType(i)));
+            }
+        },
+        n_threads);
+
+    const auto &refined = r.mesh;
+    auto       &points  = r.mesh.positions();
+    pmp_rosetta::parallel_for(
+        0, linear.size(),
+        [&](std::size_t i) {
+            const auto v = pmp::Vertex(pmp::IndexType(i));
+            pmp::Point p(0, 0, 0);
+            if (refined.is_boundary(v)) {
+                if (boundary_handling == pmp::BoundaryHandling::Preserve) {
+                    p = linear[i];
+                } else {
+                    p = 0.5 * linear[i];
+                    for (auto vv : refined.vertices(v)) {
+                        if (refined.is_boundary(vv)) {
+                            p += 0.25 * linear[vv.idx()];
+                        }
+                    }
+                }
+                points[i] = p;
+                return;
+            }
+
+            int n_faces = 0, n_quads = 0;
+            for (auto f : refined.faces(v)) {
+                ++n_faces;
+                if (refined.valence(f) == 4) {
+                    ++n_quads;
+                }
+            }
+            // Diagonal of v in the quad left of outgoing h
+            const auto opposite = [&](pmp::Halfedge h) {
+                return linear[refined.to_vertex(refined.next_halfedge(h)).idx()];
+            };
+            if (n_quads == 0) {
+                // Triangles only
+                const double c = std::cos(2.0 * std::numbers::pi / n_faces);
+                const double a = 2.0 * std::pow(3.0 / 8.0 + (c - 1.0) / 4.0, 2.0);
+                const double b = (1.0 - a) / n_faces;
+                p              = a * linear[i];
+                for (auto vv : refined.vertices(v)) {
+                    p += b * linear[vv.idx()];
+                }
+            } else if (n_quads == n_faces) {
+                // Quads only
+                const double c = (n_faces - 3.0) / n_faces;
+                const double d = 2.0 / std::pow(n_faces, 2.0);
+                const double e = 1.0 / std::pow(n_faces, 2.0);
+                p              = c * linear[i];
+                for (auto h : refined.halfedges(v)) {
+                    p += d * linear[refined.to_vertex(h).idx()];
+                    p += e * opposite(h);
+                }
+            } else {
+                // Triangles and quads
+                const double alpha = 1.0 / (1.0 + 0.5 * n_faces + 0.25 * n_quads);
+                p                  = alpha * linear[i];
+                for (auto h : refined.halfedges(v)) {
+                    p += alpha * 0.5 * linear[refined.to_vertex(h).idx()];
+                    if (refined.valence(refined.face(h)) == 4) {
+                        p += alpha * 0.25 * opposite(h);
+                    }
+                }
+            }
+            points[i] = p;
+        },
+        n_threads);
+
+    mesh = r.mesh;
+}
@@ -0,0 +1,557 @@
+// ============================================================================
+// Out-of-core processing of large meshes in spatial tiles
+// ============================================================================
+// process_tiled() remeshes, decimates and smooths a binary STL file that is
+// too large to be loaded as one SurfaceMesh:
+// 1. the file is memory-mapped and its triangles are bucketed into a grid
+//    of tiles by centroid (4 bytes of memory per input triangle);
+// 2. each tile is welded into its own mesh, processed and appended to the
+//    output, n_threads tiles at a time, so memory is bounded by the tiles in
+//    flight rather than by the input;
+// 3. tiles fit together without cracks because their boundary is locked:
+//    seam vertices keep their exact position and seam edges are never
+//    split, collapsed or flipped.
+// With seam_pass, the output of step 2 goes to an intermediate file whose
+// facet attribute bytes flag the locked corners, and a second pass over the
+// grid shifted by half a tile (so that the first-pass seams run through the
+// middle of its tiles) reprocesses a band around them.
+//
+// The boundary of the input surface itself stays locked in both passes.
+// The output is a binary STL triangle soup; meshes rebuilt from it by
+// welding identical points (e.g. read_mesh()) are watertight across seams.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <pmp/exceptions.h>
+#include <pmp/surface_mesh.h>
+
+#include "batch.h"
+#include "decimation.h"
+#include "explicit_smoothing.h"
+#include "mapped_file.h"
+#include "parallel.h"
+#include "parallel_io.h"
+#include "remeshing.h"
+
+// Steps applied to every tile, in this order:
+// uniform remeshing -> decimation -> explicit smoothing
+struct TiledPipeline {
+    // Target number of input triangles per tile, which bounds the memory
+    // used by one tile
+    std::size_t tile_triangles = std::size_t(1) << 20;
+
+    // Uniform remeshing, skipped when remesh_edge_length is 0. With
+    // remesh_relative, the edge length is a fraction of the bounding box
+    // diagonal of the whole input.
+    pmp::Scalar  remesh_edge_length = 0;
+    bool         remesh_relative    = true;
+    unsigned int remesh_iterations  = 10;
+    bool         remesh_projection  = true;
+
+    // Decimation to decimate_ratio times the vertex count, skipped when 0
+    pmp::Scalar decimate_ratio = 0;
+
+    // Explicit smoothing, skipped when smoothing_iterations is 0
+    unsigned int smoothing_iterations = 0;
+    bool         smoothing_uniform    = false;
+
+    // Reprocess the seams between tiles in a second pass
+    bool seam_pass = true;
+};
+
+// Outcome of process_tiled(); timings are in seconds
+struct TiledReport {
+    std::size_t n_tiles             = 0; // first pass
+    std::size_t n_seam_tiles        = 0; // second pass, 0 without seam_pass
+    std::size_t n_input_triangles   = 0;
+    std::size_t n_output_triangles  = 0;
+    std::size_t max_tile_triangles  = 0; // largest tile, in input triangles
+    std::size_t n_skipped_triangles = 0; // non-manifold, copied through unchanged
+    double      first_pass_seconds  = 0;
+    double      seam_pass_seconds   = 0;
+    double      total_seconds       = 0;
+};
+
+namespace pmp_rosetta::detail {
+
+    using StlTriangle = std::array<std::array<float, 3>, 3>;
+
+    constexpr std::size_t stl_facet_size = 50;
+
+    // Rings of vertices around the first-pass seams that the second pass
+    // frees: one ring is not enough, since an edge with a locked end is
+    // locked as well
+    constexpr int seam_rings = 2;
+
+    inline std::size_t stl_triangle_count(const MappedFile &file, const std::string &path) {
+        if (!is_binary_stl(file)) {
+            throw pmp::IOException("process_tiled: " + path + " is not a binary STL file");
+        }
+        std::uint32_t n = 0;
+        std::memcpy(&n, file.data() + 80, sizeof(n));
+        return n;
+    }
+
+    inline void read_facet(const MappedFile &file, std::size_t t, StlTriangle &corners,
+                           std::uint16_t &attribute) {
+        const char *facet = file.data() + 84 + stl_facet_size * t;
+        std::memcpy(corners.data(), facet + 12, 36);
+        std::memcpy(&attribute, facet + 48, sizeof(attribute));
+    }
+
+    inline std::array<float, 3> centroid(const StlTriangle &t) {
+        return {(t[0][0] + t[1][0] + t[2][0]) / 3, (t[0][1] + t[1][1] + t[2][1]) / 3,
+                (t[0][2] + t[1][2] + t[2][2]) / 3};
+    }
+
+    // Bounding box of all corners, as {min, max}
+    inline std::array<std::array<float, 3>, 2> stl_bounds(const MappedFile &file, std::size_t n,
+                                                          unsigned int n_threads) {
+        constexpr float   inf      = std::numeric_limits<float>::infinity();
+        const std::size_t n_chunks = resolve_threads(n_threads);
+        std::vector<std::array<std::array<float, 3>, 2>> chunks(
+            n_chunks, {{{inf, inf, inf}, {-inf, -inf, -inf}}});
+        parallel_for(
+            0, n_chunks,
+            [&](std::size_t c) {
+                StlTriangle   t;
+                std::uint16_t attribute;
+                for (std::size_t i = n * c / n_chunks; i < n * (c + 1) / n_chunks; ++i) {
+                    read_facet(file, i, t, attribute);
+                    for (const auto &p : t) {
+                        for (int k = 0; k < 3; ++k) {
+                            chunks[c][0][k] = std::min(chunks[c][0][k], p[k]);
+                            chunks[c][1][k] = std::max(chunks[c][1][k], p[k]);
+                        }
+                    }
+                }
+            },
+            n_threads, 1);
+        auto box = chunks[0];
+        for (const auto &b : chunks) {
+            for (int k = 0; k < 3; ++k) {
+                box[0][k] = std::min(box[0][k], b[0][k]);
+                box[1][k] = std::max(box[1][k], b[1][k]);
+            }
+        }
+        return box;
+    }
+
+    // Regular grid of about cubic cells; axes along which the input is thin
+    // compared to the cell size are not split
+    struct TileGrid {
+        std::array<double, 3>      origin{};
+        std::array<double, 3>      cell{1, 1, 1};
+        std::array<std::size_t, 3> counts{1, 1, 1};
+
+        TileGrid() = default;
+
+        TileGrid(const std::array<std::array<float, 3>, 2> &box, std::size_t n_tiles) {
+            std::array<double, 3> extent;
+            std::array<bool, 3>   split;
+            for (int k = 0; k < 3; ++k) {
+                origin[k] = box[0][k];
+                extent[k] = std::max(double(box[1][k]) - box[0][k], 0.0);
+                split[k]  = extent[k] > 0;
+            }
+
+            double size = 0;
+            for (bool changed = true; changed;) {
+                changed       = false;
+                int    n_axes = 0;
+                double volume = 1;
+                for (int k = 0; k < 3; ++k) {
+                    if (split[k]) {
+                        ++n_axes;
+                        volume *= extent[k];
+                    }
+                }
+                if (n_axes == 0) {
+                    break;
+                }
+                size = std::pow(volume / double(std::max<std::size_t>(n_tiles, 1)), 1.0 / n_axes);
+                for (int k = 0; k < 3; ++k) {
+                    if (split[k] && extent[k] < size) {
+                        split[k] = false;
+                        changed  = true;
+                        break;
+                    }
+                }
+            }
+
+            for (int k = 0; k < 3; ++k) {
+                counts[k] = split[k] ? std::max<std::size_t>(std::llround(extent[k] / size), 1)
+                                     : 1;
+                cell[k]   = extent[k] > 0 ? extent[k] / double(counts[k]) : 1;
+            }
+        }
+
+        std::size_t size() const { return counts[0] * counts[1] * counts[2]; }
+
+        std::size_t tile_of(const std::array<float, 3> &p) const {
+            std::size_t index = 0;
+            for (int k = 2; k >= 0; --k) {
+                const double c = std::floor((p[k] - origin[k]) / cell[k]);
+                const auto   i = std::size_t(std::clamp(c, 0.0, double(counts[k] - 1)));
+                index          = index * counts[k] + i;
+            }
+            return index;
+        }
+
+        // The same cells, moved by half a cell along the split axes
+        TileGrid shifted() const {
+            TileGrid grid = *this;
+            for (int k = 0; k < 3; ++k) {
+                if (counts[k] > 1) {
+                    grid.origin[k] -= cell[k] / 2;
+                    grid.counts[k] += 1;
+                }
+            }
+            return grid;
+        }
+    };
+
+    // Output binary STL appended to by concurrent tiles; the triangle count
+    // of the header is written by finish()
+    class StlWriter {
+    public:
+        explicit StlWriter(const std::string &path) : path_(path), out_(path, std::ios::binary) {
+            if (!out_) {
+                throw pmp::IOException("Failed to open file: " + path);
+            }
+            const char header[84] = {};
+            out_.write(header, sizeof(header));
+        }
+
+        void write(const std::vector<StlTriangle> &triangles,
+                   const std::vector<std::uint16_t> &attributes) {
+            std::vector<char> buffer(triangles.size() * stl_facet_size);
+            for (std::size_t t = 0; t < triangles.size(); ++t) {
+                const auto &[a, b, c] = triangles[t];
+                const pmp::dvec3 u(b[0] - a[0], b[1] - a[1], b[2] - a[2]);
+                const pmp::dvec3 v(c[0] - a[0], c[1] - a[1], c[2] - a[2]);
+                const pmp::dvec3 n = cross(u, v);
+                const double     l = norm(n) > 0 ? norm(n) : 1;
+                const float      normal[3] = {float(n[0] / l), float(n[1] / l), float(n[2] / l)};
+                char *facet = buffer.data() + stl_facet_size * t;
+                std::memcpy(facet, normal, 12);
+                std::memcpy(facet + 12, triangles[t].data(), 36);
+                std::memcpy(facet + 48, &attributes[t], 2);
+            }
+            std::lock_guard<std::mutex> lock(mutex_);
+            out_.write(buffer.data(), std::streamsize(buffer.size()));
+            n_triangles_ += triangles.size();
+        }
+
+        std::size_t finish() {
+            if (n_triangles_ > std::numeric_limits<std::uint32_t>::max()) {
+                throw pmp::IOException("process_tiled: too many triangles for STL: " + path_);
+            }
+            const auto n = std::uint32_t(n_triangles_);
+            out_.seekp(80);
+            out_.write(reinterpret_cast<const char *>(&n), sizeof(n));
+            out_.close();
+            if (!out_) {
+                throw pmp::IOException("Failed to write file: " + path_);
+            }
+            return n_triangles_;
+        }
+
+    private:
+        std::string   path_;
+        std::ofstream out_;
+        std::mutex    mutex_;
+        std::size_t   n_triangles_ = 0;
+    };
+
+    // Triangle ids of every tile, as CSR
+    struct TileBuckets {
+        std::vector<std::uint32_t> offsets;
+        std::vector<std::uint32_t> triangles;
+    };
+
+    inline TileBuckets bucket_triangles(const MappedFile &file, std::size_t n,
+                                        const TileGrid &grid, unsigned int n_threads) {
+        const auto tile_of = [&](std::size_t i) {
+            StlTriangle   t;
+            std::uint16_t attribute;
+            read_facet(file, i, t, attribute);
+            return grid.tile_of(centroid(t));
+        };
+
+        std::vector<std::atomic<std::uint32_t>> count(grid.size());
+        parallel_for(
+            0, n, [&](std::size_t i) { count[tile_of(i)].fetch_add(1, std::memory_order_relaxed); },
+            n_threads);
+
+        TileBuckets buckets;
+        buckets.offsets.assign(grid.size() + 1, 0);
+        for (std::size_t t = 0; t < grid.size(); ++t) {
+            buckets.offsets[t + 1] = buckets.offsets[t] + count[t].load();
+            count[t].store(buckets.offsets[t]);
+        }
+        buckets.triangles.resize(n);
+        parallel_for(
+            0, n,
+            [&](std::size_t i) {
+                const auto slot       = count[tile_of(i)].fetch_add(1, std::memory_order_relaxed);
+                buckets.triangles[slot] = std::uint32_t(i);
+            },
+            n_threads);
+        return buckets;
+    }
+
+    struct TileStats {
+        std::size_t n_input   = 0;
+        std::size_t n_skipped = 0;
+    };
+
+    // Process the triangles of one tile and append the result to out. In the
+    // first pass, the tile boundary is locked and flagged in the attribute
+    // bytes of the output; in the seam pass, the flagged vertices and the rings
+    // around them are freed, and the counts of decimation apply to the
+    // flagged vertices only, which are still at input resolution.
+    inline TileStats process_tile(const MappedFile &file, const std::uint32_t *ids, std::size_t n,
+                                  bool seam_pass, const TiledPipeline &pipeline,
+                                  pmp::Scalar edge_length, StlWriter &out) {
+        TileStats stats;
+        stats.n_input = n;
+
+        std::vector<std::array<float, 3>> points(3 * n);
+        std::vector<std::uint16_t>        attributes(n);
+        std::vector<std::uint32_t>        sorted(ids, ids + n);
+        std::sort(sorted.begin(), sorted.end());
+        for (std::size_t i = 0; i < n; ++i) {
+            StlTriangle t;
+            read_facet(file, sorted[i], t, attributes[i]);
+            std::copy(t.begin(), t.end(), points.begin() + std::ptrdiff_t(3 * i));
+        }
+
+        pmp::SurfaceMesh          mesh;
+        std::vector<std::int64_t> corners;
+        const auto                rejected = add_triangle_soup(mesh, points, corners);
+
+        // Vertices added by remeshing get the defaults: free, not on a seam
+        auto locked = mesh.vertex_property<bool>("v:tile_locked", false);
+        auto seam   = mesh.vertex_property<bool>("v:tile_seam", false);
+        if (!seam_pass) {
+            for (auto v : mesh.vertices()) {
+                locked[v] = mesh.is_boundary(v);
+            }
+        } else {
+            for (std::size_t f = 0; f < n; ++f) {
+                for (int k = 0; k < 3; ++k) {
+                    if (attributes[f] & (1u << k)) {
+                        seam[pmp::Vertex(pmp::IndexType(corners[3 * f + k]))] = true;
+                    }
+                }
+            }
+            std::vector<char> band(mesh.vertices_size(), 0);
+            for (auto v : mesh.vertices()) {
+                band[v.idx()] = seam[v];
+            }
+            for (int ring = 0; ring < seam_rings; ++ring) {
+                auto next = band;
+                for (auto v : mesh.vertices()) {
+                    if (band[v.idx()]) {
+                        for (auto w : mesh.vertices(v)) {
+                            next[w.idx()] = 1;
+                        }
+                    }
+                }
+                band.swap(next);
+            }
+            for (auto v : mesh.vertices()) {
+                locked[v] = !band[v.idx()] || mesh.is_boundary(v);
+            }
+        }
+
+        const auto count_free = [&](bool seam_only) {
+            std::size_t c = 0;
+            for (auto v : mesh.vertices()) {
+                c += !locked[v] && (!seam_only || seam[v]);
+            }
+            return c;
+        };
+
+        if (count_free(false) > 0) {
+            if (edge_length > 0) {
+                auto selected = mesh.vertex_property<bool>("v:selected", false);
+                for (auto v : mesh.vertices()) {
+                    selected[v] = !locked[v];
+                }
+                parallel_uniform_remeshing(mesh, edge_length, pipeline.remesh_iterations,
+                                           pipeline.remesh_projection, 1);
+                mesh.remove_vertex_property(selected);
+            }
+
+            if (pipeline.decimate_ratio > 0) {
+                const std::size_t reduce = count_free(seam_pass);
+                const auto        target = mesh.n_vertices() -
+                                    std::size_t(double(reduce) * (1 - pipeline.decimate_ratio));
+                QuadricDecimator decimator(mesh);
+                for (auto v : mesh.vertices()) {
+                    if (locked[v]) {
+                        decimator.lock(v);
+                    }
+                }
+                decimator.decimate(target);
+                mesh.garbage_collection();
+            }
+
+            if (pipeline.smoothing_iterations > 0) {
+                const auto vertices = handles<pmp::Vertex>(mesh.vertices());
+                const auto m        = one_ring_matrix(
+                    mesh, vertices, pipeline.smoothing_uniform,
+                    [&](pmp::Vertex v) { return bool(locked[v]); }, 1);
+                smooth_positions(mesh, vertices, m, pipeline.smoothing_iterations, 1);
+            }
+        }
+
+        std::vector<StlTriangle>   triangles;
+        std::vector<std::uint16_t> flags;
+        triangles.reserve(mesh.n_faces());
+        for (auto f : mesh.faces()) {
+            StlTriangle   t;
+            std::uint16_t flag = 0;
+            int           k    = 0;
+            for (auto v : mesh.vertices(f)) {
+                const auto &p = mesh.position(v);
+                t[k]          = {float(p[0]), float(p[1]), float(p[2])};
+                if (!seam_pass && locked[v]) {
+                    flag |= std::uint16_t(1u << k);
+                }
+                ++k;
+            }
+            triangles.push_back(t);
+            flags.push_back(flag);
+        }
+        for (std::size_t f = 0; f < n; ++f) {
+            if (rejected[f]) {
+                triangles.push_back({points[3 * f], points[3 * f + 1], points[3 * f + 2]});
+                flags.push_back(seam_pass ? 0 : 7);
+                ++stats.n_skipped;
+            }
+        }
+        out.write(triangles, flags);
+        return stats;
+    }
+
+    // One pass over all tiles of a file; returns the number of tiles with
+    // triangles
+    inline std::size_t process_tiles(const MappedFile &file, std::size_t n, const TileGrid &grid,
+                                     bool seam_pass, const TiledPipeline &pipeline,
+                                     pmp::Scalar edge_length, StlWriter &out,
+                                     unsigned int n_threads, TiledReport &report) {
+        const auto buckets = bucket_triangles(file, n, grid, n_threads);
+
+        std::vector<std::size_t> tiles;
+        for (std::size_t t = 0; t < grid.size(); ++t) {
+            if (buckets.offsets[t + 1] > buckets.offsets[t]) {
+                tiles.push_back(t);
+            }
+        }
+
+        std::vector<TileStats> stats(tiles.size());
+        {
+            ThreadPool pool(std::min<std::size_t>(resolve_threads(n_threads),
+                                                  std::max<std::size_t>(tiles.size(), 1)));
+            for (std::size_t i = 0; i < tiles.size(); ++i) {
+                pool.submit([&, i] {
+                    const auto begin = buckets.offsets[tiles[i]];
+                    const auto end   = buckets.offsets[tiles[i] + 1];
+                    stats[i] = process_tile(file, buckets.triangles.data() + begin, end - begin,
+                                            seam_pass, pipeline, edge_length, out);
+                });
+            }
+            pool.wait();
+        }
+
+        for (const auto &s : stats) {
+            report.max_tile_triangles = std::max(report.max_tile_triangles, s.n_input);
+            if (!seam_pass) {
+                report.n_skipped_triangles += s.n_skipped;
+            }
+        }
+        return tiles.size();
+    }
+
+} // namespace pmp_rosetta::detail
+
+// Run the pipeline on the binary STL file `input` tile by tile, on
+// n_threads threads (0 = all cores), and write the result as binary STL to
+// `output`. With seam_pass, `output` + ".tiles.stl" holds the first pass
+// until the second one is done.
+inline TiledReport process_tiled(const std::string &input, const std::string &output,
+                                 const TiledPipeline &pipeline, unsigned int n_threads) {
+    using namespace pmp_rosetta::detail;
+
+    if (pipeline.tile_triangles == 0) {
+        throw pmp::InvalidInputException("process_tiled: tile_triangles must be positive");
+    }
+
+    const auto  start = std::chrono::steady_clock::now();
+    TiledReport report;
+
+    pmp_rosetta::detail::TileGrid grid;
+    pmp::Scalar                   edge_length = 0;
+    std::string                   first_path  = output;
+    {
+        const pmp_rosetta::MappedFile file(input);
+        const std::size_t             n = stl_triangle_count(file, input);
+        report.n_input_triangles        = n;
+
+        const auto box = stl_bounds(file, n, n_threads);
+        grid = TileGrid(box, (n + pipeline.tile_triangles - 1) / pipeline.tile_triangles);
+
+        edge_length = pipeline.remesh_edge_length;
+        if (pipeline.remesh_relative && n > 0) {
+            double diagonal = 0;
+            for (int k = 0; k < 3; ++k) {
+                diagonal += double(box[1][k] - box[0][k]) * (box[1][k] - box[0][k]);
+            }
+            edge_length *= pmp::Scalar(std::sqrt(diagonal));
+        }
+
+        const bool seams = pipeline.seam_pass && grid.size() > 1;
+        if (seams) {
+            first_path = output + ".tiles.stl";
+        }
+        StlWriter out(first_path);
+        report.n_tiles =
+            process_tiles(file, n, grid, false, pipeline, edge_length, out, n_threads, report);
+        report.n_output_triangles = out.finish();
+        report.first_pass_seconds = seconds_since(start);
+    }
+
+    if (first_path != output) {
+        const auto seam_start = std::chrono::steady_clock::now();
+        {
+            const pmp_rosetta::MappedFile file(first_path);
+            StlWriter                     out(output);
+            report.n_seam_tiles = process_tiles(file, stl_triangle_count(file, first_path),
+                                                grid.shifted(), true, pipeline, edge_length, out,
+                                                n_threads, report);
+            report.n_output_triangles = out.finish();
+        }
+        std::filesystem::remove(first_path);
+        report.seam_pass_seconds = seconds_since(seam_start);
+    }
+
+    report.total_seconds = seconds_since(start);
+    return report;
+}
@@ -0,0 +1,94 @@
+// ============================================================================
+// Fixed-arity face access for triangle meshes
+// ============================================================================
+// The SurfaceMesh circulators handle any polygon: vertices(f) walks the
+// halfedges of f testing for the end at every step, and pmp::face_normal()
+// and pmp::vertex_normal() check the valence of every face they touch to
+// pick between the triangle formula and Newell's method. Nearly all meshes
+// we process are made of triangles only.
+//
+// The kernels of the exporters are written once as templates over the face
+// arity: with std::true_type they read the three corners of a face with
+// three halfedge lookups and use the triangle formulas directly, with
+// std::false_type they use the general PMP code. with_arity() runs a kernel
+// with the instantiation matching the mesh, from a single check. Both give
+// the same values as the PMP functions.
+// ============================================================================
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#include <pmp/algorithms/normals.h>
+#include <pmp/surface_mesh.h>
+
+namespace pmp_rosetta::detail {
+
+    using Triangles = std::true_type;
+    using Polygons  = std::false_type;
+
+    // Corners of triangle f, in the order of mesh.vertices(f)
+    inline std::array<pmp::Vertex, 3> triangle_vertices(const pmp::SurfaceMesh &mesh,
+                                                        pmp::Face               f) {
+        const auto h0 = mesh.halfedge(f);
+        const auto h1 = mesh.next_halfedge(h0);
+        const auto h2 = mesh.next_halfedge(h1);
+        return {mesh.to_vertex(h0), mesh.to_vertex(h1), mesh.to_vertex(h2)};
+    }
+
+    // pmp::face_normal(), for a face known to be a triangle (IsTriangle) or not
+    template <typename IsTriangle>
+    inline pmp::Normal face_normal(const pmp::SurfaceMesh &mesh, pmp::Face f, IsTriangle) {
+        if constexpr (IsTriangle::value) {
+            const auto [v0, v1, v2] = triangle_vertices(mesh, f);
+            const auto &p1          = mesh.position(v1);
+            return pmp::normalize(pmp::cross(mesh.position(v2) - p1, mesh.position(v0) - p1));
+        } else {
+            return pmp::face_normal(mesh, f);
+        }
+    }
+
+    // pmp::vertex_normal(): sum of the normals of the faces around v,
+    // weighted by their angle at v
+    template <typename AllTriangles>
+    inline pmp::Normal vertex_normal(const pmp::SurfaceMesh &mesh, pmp::Vertex v, AllTriangles) {
+        if constexpr (!AllTriangles::value) {
+            return pmp::vertex_normal(mesh, v);
+        } else {
+            pmp::Point nn(0, 0, 0);
+            if (mesh.is_isolated(v)) {
+                return nn;
+            }
+            const auto &p0 = mesh.position(v);
+            for (auto h : mesh.halfedges(v)) {
+                if (mesh.is_boundary(h)) {
+                    continue;
+                }
+                const auto        w     = mesh.from_vertex(mesh.prev_halfedge(h));
+                const pmp::Point  p1    = mesh.position(mesh.to_vertex(h)) - p0;
+                const pmp::Point  p2    = mesh.position(w) - p0;
+                const pmp::Scalar denom = std::sqrt(pmp::dot(p1, p1) * pmp::dot(p2, p2));
+                if (denom > std::numeric_limits<pmp::Scalar>::min()) {
+                    const pmp::Scalar cosine = std::clamp(pmp::dot(p1, p2) / denom,
+                                                          pmp::Scalar(-1), pmp::Scalar(1));
+                    nn += std::acos(cosine) * pmp::normalize(pmp::cross(p1, p2));
+                }
+            }
+            return pmp::normalize(nn);
+        }
+    }
+
+    // Run kernel(Triangles{}) on a pure triangle mesh, kernel(Polygons{})
+    // otherwise
+    template <typename Kernel> inline decltype(auto) with_arity(const pmp::SurfaceMesh &mesh,
+                                                                Kernel                &&kernel) {
+        if (mesh.is_triangle_mesh()) {
+            return kernel(Triangles{});
+        }
+        return kernel(Polygons{});
+    }
+
+} // namespace pmp_rosetta::detail
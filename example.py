@@ -75,7 +75,9 @@ def save_mesh(mesh, filepath):
     
     flags = pmp.IOFlags()
     flags.use_binary = filepath.lower().endswith('.stl')
-    
+
+    # pmp.write() expects consecutive indices: drop the deleted elements
+    pmp.parallel_garbage_collection(mesh, 0)
     pmp.write(mesh, filepath, flags)
     print(f"  Saved successfully!")
 
@@ -112,9 +114,6 @@ def remesh(mesh, target_edge_length=None):
     # - n_iterations: number of remeshing iterations (default ~10)
     # - use_projection: project vertices back to original surface
     pmp.uniform_remeshing(mesh, target_edge_length, 10, True)
-    
-    # Clean up
-    mesh.garbage_collection()
 
 
 def main():
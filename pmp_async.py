@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""
+asyncio helpers for the asynchronous PMP functions
+
+Every long-running algorithm has an ``<name>_async`` variant that queues the
+call on a native executor shared by the whole process and returns a
+``pmp.Job`` at once (see bindings/jobs.h). ``run_async`` awaits such a job
+without blocking the event loop or holding a thread: the loop watches the
+executor's notification pipe and is woken when a job starts or finishes.
+
+When the executor queue is full, ``run_async`` waits for room before
+submitting, so a burst of requests queues up as coroutines instead of native
+jobs. The queue depth and the number of jobs run at a time are set with
+``pmp.set_job_limits(n_workers, max_queued)``.
+
+The mesh passed to a job is worked on in place, in the background: leave it
+alone until the job is over. ``run_async`` keeps the arguments alive until
+then, even when the awaiting task is cancelled.
+
+Usage:
+    import pmp
+    from pmp_async import run_async
+
+    async def handle(mesh):
+        await run_async(pmp.uniform_remeshing_async, mesh, 0.01, 10, True)
+        job = await run_async(pmp.parallel_decimate_async, mesh, 1000, 0, False)
+        return pmp.job_decimation_report(job)
+
+Only one event loop per process should await jobs: the loops would share
+the notification pipe.
+"""
+
+import asyncio
+import os
+import weakref
+
+import pmp
+
+
+class _JobWatcher:
+    """Futures of the jobs awaited on one event loop, resolved on notifications."""
+
+    def __init__(self, loop):
+        self._loop = loop
+        self._jobs = []  # (job, future)
+        self._room = []  # futures waiting for a free slot in the queue
+        self._kept = []  # (job, args) of cancelled awaits, until the job is over
+        self._fd = pmp.job_notify_fd()
+        self._poller = None
+        if self._fd >= 0:
+            loop.add_reader(self._fd, self._on_notify)
+
+    def _start_polling(self):
+        # No notification pipe (Windows): check every few milliseconds while
+        # something is awaited
+        async def poll():
+            while self._jobs or self._room or self._kept:
+                await asyncio.sleep(0.005)
+                self._update()
+            self._poller = None
+
+        if self._fd < 0 and self._poller is None:
+            self._poller = self._loop.create_task(poll())
+
+    def _on_notify(self):
+        try:
+            while os.read(self._fd, 4096):
+                pass
+        except BlockingIOError:
+            pass
+        self._update()
+
+    def _update(self):
+        pending = []
+        for job, future in self._jobs:
+            if not job.done():
+                pending.append((job, future))
+            elif not future.done():
+                future.set_result(None)
+        self._jobs = pending
+        self._kept = [(job, args) for job, args in self._kept if not job.done()]
+        if self._room and not pmp.job_queue_full():
+            room, self._room = self._room, []
+            for future in room:
+                if not future.done():
+                    future.set_result(None)
+
+    async def wait_done(self, job):
+        future = self._loop.create_future()
+        self._jobs.append((job, future))
+        self._start_polling()
+        # The job may have ended before it was registered
+        self._update()
+        await future
+
+    async def wait_room(self):
+        future = self._loop.create_future()
+        self._room.append(future)
+        self._start_polling()
+        self._update()
+        await future
+
+    def keep(self, job, args):
+        self._kept.append((job, args))
+        self._start_polling()
+
+
+_watchers = weakref.WeakKeyDictionary()
+
+
+def _watcher():
+    loop = asyncio.get_running_loop()
+    watcher = _watchers.get(loop)
+    if watcher is None:
+        watcher = _watchers[loop] = _JobWatcher(loop)
+    return watcher
+
+
+async def run_async(submit, *args):
+    """Submit submit(*args), one of the pmp.*_async functions, and await its job.
+
+    Returns:
+        The finished pmp.Job, for its timings or its result
+        (e.g. pmp.job_decimation_report(job)).
+
+    Raises:
+        RuntimeError: when the job failed or was cancelled, with its error.
+    """
+    watcher = _watcher()
+    while pmp.job_queue_full():
+        await watcher.wait_room()
+    job = submit(*args)
+    try:
+        await watcher.wait_done(job)
+    except asyncio.CancelledError:
+        # A job that already runs cannot be stopped: its arguments (the mesh)
+        # must outlive it
+        if not job.cancel() and not job.done():
+            watcher.keep(job, args)
+        raise
+    if not job.ok():
+        name = getattr(submit, "__name__", "job")
+        raise RuntimeError(f"{name}: job {job.status()}: {job.error()}")
+    return job
@@ -0,0 +1,446 @@
+#!/usr/bin/env python3
+"""
+NumPy helpers for the PMP Python bindings
+
+The bindings expose the address and size of the native mesh storage. This
+module wraps them into NumPy arrays that share memory with the SurfaceMesh
+(no copy, no type widening). Every array keeps a reference to its mesh, so
+the mesh cannot be destroyed while a view of it is alive.
+
+A view is only valid until the next topology change (add_vertex, remeshing,
+decimation, garbage_collection, ...) on the mesh, since those may reallocate
+the underlying storage. Take a fresh view after modifying the mesh.
+
+Usage:
+    import pmp
+    from pmp_numpy import points_view
+
+    mesh = pmp.icosahedron()
+    pts = points_view(mesh)                  # read-only (N, 3) view
+    pts_rw = points_view(mesh, writable=True)
+    pts_rw *= 2.0                            # scales the mesh in place
+"""
+
+import numpy as np
+
+import pmp
+
+
+class _MeshBuffer:
+    """Expose a native buffer through the NumPy array interface.
+
+    The instance becomes the ``base`` of the resulting array and holds a
+    reference to the owning mesh, tying the lifetime of the view to it.
+    """
+
+    def __init__(self, owner, address, shape, dtype, readonly):
+        self.owner = owner
+        self.__array_interface__ = {
+            'version': 3,
+            'shape': tuple(shape),
+            'typestr': np.dtype(dtype).str,
+            'data': (int(address), bool(readonly)),
+        }
+
+
+def scalar_dtype():
+    """NumPy dtype matching pmp::Scalar (float32 unless PMP uses doubles)."""
+    return np.float64 if pmp.scalar_size() == 8 else np.float32
+
+
+def index_dtype():
+    """NumPy dtype matching pmp::IndexType (uint32 unless PMP uses 64-bit indices)."""
+    return np.uint64 if pmp.index_size() == 8 else np.uint32
+
+
+def _view(owner, address, shape, dtype, writable):
+    if int(np.prod(shape)) == 0 or address == 0:
+        return np.empty(shape, dtype=dtype)
+    return np.asarray(_MeshBuffer(owner, address, shape, dtype, not writable))
+
+
+def points_view(mesh, writable=False):
+    """Return an (n, 3) view of the vertex positions ("v:point") of a mesh.
+
+    n is mesh.vertices_size(): when the mesh still holds deleted vertices
+    (mesh.has_garbage()), their rows are included, which keeps row numbers
+    equal to vertex indices.
+    """
+    n = mesh.vertices_size()
+    return _view(mesh, mesh.points_address(), (n, 3), scalar_dtype(), writable)
+
+
+def points_array(mesh):
+    """Return a compact (n_vertices, 3) copy of the positions, skipping deleted vertices.
+
+    Rows match the vertex numbering of faces_array()/polygons_array() with
+    compact=True, so no garbage_collection() is needed before exporting.
+    """
+    out = np.empty((mesh.n_vertices(), 3), dtype=scalar_dtype())
+    pmp.export_points(mesh, out.ctypes.data, out.size)
+    return out
+
+
+def faces_array(mesh, compact=True):
+    """Return an (n_faces, k) index array for a pure triangle (k=3) or quad (k=4) mesh.
+
+    With compact=True indices refer to rows of points_array(), otherwise to
+    rows of points_view(). Use polygons_array() for general polygon meshes.
+    """
+    if mesh.is_triangle_mesh():
+        arity = 3
+    elif mesh.is_quad_mesh():
+        arity = 4
+    else:
+        raise ValueError("faces_array() requires a triangle or quad mesh, use polygons_array()")
+    out = np.empty((mesh.n_faces(), arity), dtype=index_dtype())
+    pmp.export_faces(mesh, out.ctypes.data, out.size, 0, 0, compact)
+    return out
+
+
+def polygons_array(mesh, compact=True):
+    """Return the face connectivity as CSR arrays (offsets, connectivity).
+
+    Face i uses connectivity[offsets[i]:offsets[i + 1]]; offsets has
+    n_faces + 1 entries. Indices numbering follows faces_array().
+    """
+    connectivity = np.empty(pmp.n_face_indices(mesh), dtype=index_dtype())
+    offsets = np.empty(mesh.n_faces() + 1, dtype=index_dtype())
+    pmp.export_faces(mesh, connectivity.ctypes.data, connectivity.size,
+                     offsets.ctypes.data, offsets.size, compact)
+    return offsets, connectivity
+
+
+def snapshot_points_view(snapshot, writable=False):
+    """Return an (n_vertices, 3) view of the positions stored in a MeshSnapshot.
+
+    The snapshot is mapped copy-on-write: writing through the view never
+    modifies the file.
+    """
+    n = snapshot.n_vertices()
+    return _view(snapshot, snapshot.points_address(), (n, 3), scalar_dtype(), writable)
+
+
+def snapshot_polygons_view(snapshot):
+    """Return read-only (offsets, connectivity) CSR views of the faces of a MeshSnapshot."""
+    offsets = _view(snapshot, snapshot.face_offsets_address(), (snapshot.n_faces() + 1,),
+                    index_dtype(), False)
+    connectivity = _view(snapshot, snapshot.face_indices_address(),
+                         (snapshot.n_face_indices(),), index_dtype(), False)
+    return offsets, connectivity
+
+
+def compact_points_array(compact, n_threads=0):
+    """Return the decoded (n_vertices, 3) positions of a pmp.CompactMesh.
+
+    Rows follow points_array() of the mesh it was built from, each coordinate
+    within compact.max_error() of the original one.
+    """
+    out = np.empty((compact.n_vertices(), 3), dtype=scalar_dtype())
+    pmp.export_compact_points(compact, out.ctypes.data, out.size, n_threads)
+    return out
+
+
+def compact_polygons_array(compact, n_threads=0):
+    """Return the faces of a pmp.CompactMesh as CSR arrays (offsets, connectivity).
+
+    For a triangle mesh, connectivity.reshape(-1, 3) gives the faces_array() layout.
+    """
+    connectivity = np.empty(compact.n_face_indices(), dtype=index_dtype())
+    offsets = np.empty(compact.n_faces() + 1, dtype=index_dtype())
+    pmp.export_compact_faces(compact, connectivity.ctypes.data, connectivity.size,
+                             offsets.ctypes.data, offsets.size, n_threads)
+    return offsets, connectivity
+
+
+def mesh_from_arrays(points, faces, arity=0, mesh=None):
+    """Build a SurfaceMesh from contiguous arrays in a single native call.
+
+    Args:
+        points: (n, 3) array-like of vertex positions
+        faces: either an (m, k) array of vertex indices (k >= 3), or a flat
+               VTK-style array [n, v0, ..., vn-1, n, ...] when arity is 0
+        arity: number of vertices per face for a flat fixed-arity array,
+               0 for VTK-style faces (ignored when faces is 2D)
+        mesh: optional SurfaceMesh to fill (it is cleared first)
+
+    Returns:
+        (mesh, n_skipped) where n_skipped counts the faces rejected because
+        they would make the mesh non-manifold
+    """
+    points = np.ascontiguousarray(points, dtype=scalar_dtype()).reshape(-1, 3)
+    faces = np.ascontiguousarray(faces, dtype=np.int64)
+    if faces.ndim == 2:
+        arity = faces.shape[1]
+    faces = faces.ravel()
+
+    if mesh is None:
+        mesh = pmp.SurfaceMesh()
+    n_skipped = pmp.build_mesh(mesh, points.ctypes.data, len(points),
+                               faces.ctypes.data, len(faces), arity)
+    return mesh, n_skipped
+
+
+class MeshPool:
+    """Recycle SurfaceMesh objects so that repeated copies do not allocate.
+
+    acquire(src) returns a mesh of the pool holding a copy of src, made by
+    pmp.copy_mesh_into() into the largest released mesh that has no more
+    elements than src; release() puts a mesh back. copy_mesh_into() cannot
+    shrink a mesh in place, so meshes reserved up front and released with
+    no more elements than the next source reuse their storage, others are
+    reallocated.
+
+    Views of a released mesh become invalid on its next acquire: keep a mesh
+    acquired for as long as arrays or PolyData built from its views are used.
+
+    Args:
+        size: number of meshes to create up front
+        n_vertices, n_edges, n_faces: capacity reserved in each of them
+    """
+
+    def __init__(self, size=0, n_vertices=0, n_edges=0, n_faces=0):
+        self._free = []
+        for _ in range(size):
+            mesh = pmp.SurfaceMesh()
+            mesh.reserve(n_vertices, n_edges, n_faces)
+            self._free.append(mesh)
+
+    def acquire(self, src=None):
+        """Take a mesh from the pool (a new one if it is empty), copying src into it."""
+        if not self._free:
+            mesh = pmp.SurfaceMesh()
+        elif src is None:
+            mesh = self._free.pop()
+        else:
+            # The copy is made in place into a mesh no larger than src: take
+            # the largest of those, whose storage is the most likely to hold
+            # src, or else the smallest, leaving larger ones to larger sources
+            sizes = [(m.vertices_size(), m.faces_size()) for m in self._free]
+            fits = [i for i, (v, f) in enumerate(sizes)
+                    if v <= src.vertices_size() and f <= src.faces_size()]
+            if fits:
+                best = max(fits, key=lambda i: sizes[i])
+            else:
+                best = min(range(len(sizes)), key=lambda i: sizes[i])
+            mesh = self._free.pop(best)
+        if src is not None:
+            pmp.copy_mesh_into(mesh, src)
+        return mesh
+
+    def release(self, mesh):
+        """Return a mesh to the pool for reuse."""
+        self._free.append(mesh)
+
+    def __len__(self):
+        return len(self._free)
+
+
+_PROPERTY_DTYPES = {
+    'bool': np.uint8,  # converted, std::vector<bool> is bit-packed
+    'int32': np.int32,
+    'uint32': np.uint32,
+    'float32': np.float32,
+    'float64': np.float64,
+}
+
+
+def _property_shape(info):
+    return (info.size,) if info.components == 1 else (info.size, info.components)
+
+
+def property_view(mesh, kind, name, writable=False):
+    """Zero-copy view of a mesh property, kind being 'v', 'h', 'e' or 'f'.
+
+    The array has one row per element slot (e.g. mesh.vertices_size() rows),
+    deleted elements included. bool properties cannot be viewed in place and
+    are returned as a copy (see property_array()).
+    """
+    info = pmp.property_info(mesh, kind, name)
+    if info.type == 'bool':
+        return property_array(mesh, kind, name)
+    return _view(mesh, info.address, _property_shape(info), _PROPERTY_DTYPES[info.type], writable)
+
+
+def property_array(mesh, kind, name):
+    """Copy of a mesh property (bool properties as a bool array)."""
+    info = pmp.property_info(mesh, kind, name)
+    out = np.empty(_property_shape(info), dtype=_PROPERTY_DTYPES[info.type])
+    pmp.read_property(mesh, kind, name, out.ctypes.data, out.size)
+    return out.astype(bool) if info.type == 'bool' else out
+
+
+def set_property(mesh, kind, name, values):
+    """Create or overwrite a mesh property from an array of one row per element slot.
+
+    The property type follows the array: bool, int32, uint32, float32 or
+    float64, with shape (n,) or (n, 2) / (n, 3) for vector properties.
+    Built-in properties cannot be written, except 'v:point' (the positions).
+    """
+    values = np.asarray(values)
+    if values.dtype == bool:
+        values = values.astype(np.uint8)
+        type_name = 'bool'
+    else:
+        type_name = {np.dtype(v): k for k, v in _PROPERTY_DTYPES.items()}.get(values.dtype)
+        if type_name is None or type_name == 'bool':
+            raise ValueError(f"set_property(): unsupported dtype {values.dtype}")
+    components = 1 if values.ndim == 1 else values.shape[1]
+    values = np.ascontiguousarray(values)
+    return pmp.write_property(mesh, kind, name, type_name, components,
+                              values.ctypes.data, len(values))
+
+
+def curvatures(mesh, n_threads=0):
+    """Per-vertex curvatures of a triangle mesh, computed over n_threads threads (0: all cores).
+
+    Returns:
+        dict of (n_vertices,) arrays 'min', 'max', 'mean' and 'gauss', rows
+        matching points_array()
+    """
+    n = mesh.n_vertices()
+    k = {name: np.empty(n, dtype=scalar_dtype()) for name in ('min', 'max', 'mean', 'gauss')}
+    pmp.export_curvatures(mesh, k['min'].ctypes.data, k['max'].ctypes.data,
+                          k['mean'].ctypes.data, k['gauss'].ctypes.data, n, n_threads)
+    return k
+
+
+def vertex_normals_array(mesh, n_threads=0):
+    """(n_vertices, 3) vertex normals, rows matching points_array()."""
+    out = np.empty((mesh.n_vertices(), 3), dtype=scalar_dtype())
+    pmp.export_vertex_normals(mesh, out.ctypes.data, out.size, n_threads)
+    return out
+
+
+def face_normals_array(mesh, n_threads=0):
+    """(n_faces, 3) face normals, rows matching faces_array()."""
+    out = np.empty((mesh.n_faces(), 3), dtype=scalar_dtype())
+    pmp.export_face_normals(mesh, out.ctypes.data, out.size, n_threads)
+    return out
+
+
+def vertex_areas_array(mesh, n_threads=0):
+    """(n_vertices,) mixed Voronoi vertex areas, rows matching points_array()."""
+    out = np.empty(mesh.n_vertices(), dtype=scalar_dtype())
+    pmp.export_vertex_areas(mesh, out.ctypes.data, out.size, n_threads)
+    return out
+
+
+def _render_buffers(mesh, vtk_layout, index_type, n_threads, out):
+    n_vertices = 6 * mesh.n_vertices()
+    n_indices = pmp.n_render_indices(mesh, vtk_layout)
+    if out is None:
+        vertices = np.empty(n_vertices, dtype=scalar_dtype())
+        indices = np.empty(n_indices, dtype=index_type)
+    else:
+        vertices, indices = out
+        for array, size, dtype in ((vertices, n_vertices, scalar_dtype()),
+                                   (indices, n_indices, index_type)):
+            if (array.dtype != dtype or array.ndim != 1 or array.size < size
+                    or not array.flags.c_contiguous or not array.flags.writeable):
+                raise ValueError(f"out arrays must be writable contiguous 1D {np.dtype(dtype)} "
+                                 f"arrays of at least {size} elements")
+    pmp.export_render_buffers(mesh, vertices.ctypes.data, vertices.size, indices.ctypes.data,
+                              indices.size, vtk_layout, n_threads)
+    return vertices[:n_vertices], indices[:n_indices]
+
+
+def vtk_buffers(mesh, n_threads=0, out=None):
+    """Points, vertex normals and VTK cells of a mesh, filled in one native pass.
+
+    Returns:
+        (points, normals, faces): (n, 3) points and normals, contiguous blocks
+        of one buffer, and the flat int64 [n, v0, ..., vn-1, ...] cell array
+        of pyvista.PolyData(points, faces). Rows match points_array().
+
+    out may hold the (buffer, faces) 1D arrays of a previous call, or any
+    large enough arrays of the same types, to be filled instead of new ones.
+    Arrays still used by a PolyData must not be passed.
+    """
+    n = mesh.n_vertices()
+    vertices, faces = _render_buffers(mesh, True, np.int64, n_threads, out)
+    return vertices[:3 * n].reshape(n, 3), vertices[3 * n:].reshape(n, 3), faces
+
+
+def gl_buffers(mesh, n_threads=0, out=None):
+    """Interleaved vertex buffer and triangle index buffer of a mesh, in one native pass.
+
+    Returns:
+        (vertices, triangles): (n, 6) rows [x, y, z, nx, ny, nz] and (t, 3)
+        index_dtype() corners, polygons being split into fans. Rows match
+        points_array(); out works as in vtk_buffers().
+    """
+    vertices, indices = _render_buffers(mesh, False, index_dtype(), n_threads, out)
+    return vertices.reshape(-1, 6), indices.reshape(-1, 3)
+
+
+def geodesic_distances(mesh, seed_sets, max_distance=np.inf, n_threads=0):
+    """Geodesic distance fields of a triangle mesh for a list of seed vertex sets.
+
+    seed_sets holds one sequence of vertex rows (as in points_array()) per
+    field. The fields are computed concurrently, one set per thread; the
+    front stops at max_distance and farther vertices get inf.
+
+    Returns:
+        (len(seed_sets), n_vertices) array
+    """
+    sets = [np.asarray(s, dtype=index_dtype()).ravel() for s in seed_sets]
+    offsets = np.zeros(len(sets) + 1, dtype=index_dtype())
+    offsets[1:] = np.cumsum([len(s) for s in sets])
+    seeds = np.concatenate(sets) if sets else np.empty(0, dtype=index_dtype())
+    out = np.empty((len(sets), mesh.n_vertices()), dtype=scalar_dtype())
+    max_distance = min(float(max_distance), float(np.finfo(scalar_dtype()).max))
+    pmp.geodesic_distances(mesh, seeds.ctypes.data, len(seeds), offsets.ctypes.data, len(sets),
+                           out.ctypes.data, out.size, max_distance, n_threads)
+    return out
+
+
+def _points3(points):
+    return np.ascontiguousarray(points, dtype=scalar_dtype()).reshape(-1, 3)
+
+
+def closest_points(bvh, points, n_threads=0):
+    """Closest surface points of a MeshBVH for an (n, 3) array of query points.
+
+    Returns:
+        (points, distances, faces): (n, 3) closest points, (n,) distances and
+        (n,) raw face indices of the mesh the tree was built from
+    """
+    points = _points3(points)
+    nearest = np.empty_like(points)
+    distances = np.empty(len(points), dtype=scalar_dtype())
+    faces = np.empty(len(points), dtype=index_dtype())
+    bvh.closest_points(points.ctypes.data, len(points), nearest.ctypes.data,
+                       distances.ctypes.data, faces.ctypes.data, n_threads)
+    return nearest, distances, faces
+
+
+def ray_intersect(bvh, origins, directions, n_threads=0):
+    """First hits of the rays origins[i] + t * directions[i], t >= 0, on a MeshBVH.
+
+    Returns:
+        (t, faces, hit): (n,) ray parameters (inf on a miss), (n,) raw face
+        indices and the (n,) boolean hit mask
+    """
+    origins = _points3(origins)
+    directions = _points3(directions)
+    if origins.shape != directions.shape:
+        raise ValueError("ray_intersect(): origins and directions differ in shape")
+    t = np.empty(len(origins), dtype=scalar_dtype())
+    faces = np.empty(len(origins), dtype=index_dtype())
+    bvh.ray_intersect(origins.ctypes.data, directions.ctypes.data, len(origins),
+                      t.ctypes.data, faces.ctypes.data, n_threads)
+    return t, faces, np.isfinite(t)
+
+
+def winding_number_inside(bvh, points, n_threads=0, beta=2.0, return_winding=False):
+    """Inside test for an (n, 3) array of points, from generalized winding numbers.
+
+    Robust to small holes and inconsistencies in the surface. Returns the
+    (n,) boolean mask, and the (n,) winding numbers too with return_winding.
+    """
+    points = _points3(points)
+    winding = np.empty(len(points), dtype=scalar_dtype())
+    bvh.winding_numbers(points.ctypes.data, len(points), winding.ctypes.data, beta, n_threads)
+    inside = winding > 0.5
+    return (inside, winding) if return_winding else inside
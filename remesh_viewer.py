@@ -32,7 +32,9 @@ from PyQt5.QtWidgets import (
     QSplitter, QStatusBar, QFrame, QSlider, QMessageBox, QComboBox,
     QCheckBox
 )
-from PyQt5.QtCore import Qt
+from PyQt5.QtCore import Qt, QTimer
+
+from pmp_numpy import curvatures, mesh_from_arrays, vtk_buffers
 
 # Available color palettes for visualization
 COLOR_PALETTES = [
@@ -53,59 +55,31 @@ ATTRIBUTES = [
     'Max Curvature'
 ]
 
+# Curvature attributes and their pmp_numpy.curvatures() key
+CURVATURE_KEYS = {
+    'Gaussian Curvature': 'gauss',
+    'Mean Curvature': 'mean',
+    'Min Curvature': 'min',
+    'Max Curvature': 'max',
+}
+
 
 def pyvista_to_pmp(pv_mesh):
     """Convert a PyVista PolyData to a PMP SurfaceMesh."""
-    # Get vertices and faces from PyVista
-    vertices = pv_mesh.points
-    faces = pv_mesh.faces
-
-    # Create PMP mesh and add vertices
-    mesh = pmp.SurfaceMesh()
-
-    # Add all vertices
-    pmp_vertices = []
-    for v in vertices:
-        pmp_v = mesh.add_vertex(pmp.Point(float(v[0]), float(v[1]), float(v[2])))
-        pmp_vertices.append(pmp_v)
-
-    # Parse PyVista faces format: [n, v0, v1, ..., vn, n, v0, v1, ..., vn, ...]
-    i = 0
-    while i < len(faces):
-        n = faces[i]  # Number of vertices in this face
-        if n == 3:
-            mesh.add_triangle(
-                pmp_vertices[faces[i + 1]],
-                pmp_vertices[faces[i + 2]],
-                pmp_vertices[faces[i + 3]]
-            )
-        elif n == 4:
-            mesh.add_quad(
-                pmp_vertices[faces[i + 1]],
-                pmp_vertices[faces[i + 2]],
-                pmp_vertices[faces[i + 3]],
-                pmp_vertices[faces[i + 4]]
-            )
-        i += n + 1
-
+    # PyVista faces format: [n, v0, v1, ..., vn, n, v0, v1, ..., vn, ...]
+    mesh, _ = mesh_from_arrays(pv_mesh.points, pv_mesh.faces, arity=0)
     return mesh
 
 
 def pmp_to_pyvista(mesh):
     """Convert a PMP SurfaceMesh to a PyVista PolyData."""
-    # Get vertices
-    verts = mesh.vertices()
-    vertices = np.array(verts, dtype=np.float64).reshape(-1, 3)
-
-    # Get faces
-    indices = mesh.indices()
-    indices_array = np.array(indices, dtype=np.int64).reshape(-1, 3)
+    # Points, normals and the [n, v0, v1, v2, ...] face array in one native
+    # pass; deleted elements are skipped, so no garbage collection is needed
+    points, normals, faces = vtk_buffers(mesh)
 
-    # PyVista face format: [n, v0, v1, v2, n, v0, v1, v2, ...]
-    n_faces = len(indices_array)
-    faces = np.column_stack([np.full(n_faces, 3), indices_array]).ravel()
-
-    return pv.PolyData(vertices, faces)
+    poly = pv.PolyData(points, faces)
+    poly.point_data.active_normals = normals
+    return poly
 
 
 class RemeshViewer(QMainWindow):
@@ -116,11 +90,28 @@ class RemeshViewer(QMainWindow):
 
         self.original_mesh = None  # PyVista mesh
         self.remeshed_mesh = None  # PyVista mesh
+        self.reference = None  # pmp.RemeshingReference of original_mesh, built on first remesh
+        self.source = None  # triangulated pmp.SurfaceMesh of original_mesh, built on first remesh
+        self.remesher = None  # pmp.Remesher of source, running remeshes in the background
+        self.snapshot = pmp.SurfaceMesh()  # latest remesher snapshot, reused across fetches
+        self.shown_version = 0  # remesher snapshot shown in the remeshed view
+        self.remesh_label = ""  # status text of the running remesh
+        self.reset_remeshed_camera = False  # reset the camera on the next snapshot shown
         self.current_filepath = None
         self.target_edge_length = 0.02
         self.auto_edge_length = 0.02
         self._syncing_cameras = False  # Flag to prevent recursive sync
 
+        # Snapshots are polled while a remesh runs, and slider moves restart
+        # the remesh once they pause
+        self.poll_timer = QTimer(self)
+        self.poll_timer.setInterval(50)
+        self.poll_timer.timeout.connect(self.poll_remesh)
+        self.restart_timer = QTimer(self)
+        self.restart_timer.setSingleShot(True)
+        self.restart_timer.setInterval(200)
+        self.restart_timer.timeout.connect(self.do_remesh)
+
         self.setup_ui()
         self.setup_status_bar()
         self.setup_camera_sync()
@@ -384,14 +375,13 @@ class RemeshViewer(QMainWindow):
             return mesh.points[:, 1]
         elif attribute == 'Z Coordinate':
             return mesh.points[:, 2]
-        elif attribute == 'Gaussian Curvature':
-            return mesh.curvature(curv_type='gaussian')
-        elif attribute == 'Mean Curvature':
-            return mesh.curvature(curv_type='mean')
-        elif attribute == 'Min Curvature':
-            return mesh.curvature(curv_type='minimum')
-        elif attribute == 'Max Curvature':
-            return mesh.curvature(curv_type='maximum')
+        elif attribute in CURVATURE_KEYS:
+            # Rows of the converted mesh are the PolyData points. curvatures()
+            # needs triangles; triangulating only adds edges, so rows still match.
+            source = pyvista_to_pmp(mesh)
+            if not source.is_triangle_mesh():
+                pmp.triangulate(source)
+            return curvatures(source)[CURVATURE_KEYS[attribute]]
         return None
 
     def update_mesh_display(self, plotter, mesh, default_color):
@@ -506,6 +496,11 @@ class RemeshViewer(QMainWindow):
         self.edge_length_spinbox.setValue(self.target_edge_length)
         self.edge_length_spinbox.blockSignals(False)
 
+        # Once a result is shown, follow the slider: small changes continue
+        # from the current result instead of remeshing from scratch
+        if self.remeshed_mesh is not None:
+            self.restart_timer.start()
+
     def on_spinbox_changed(self, value):
         """Handle spinbox value change."""
         self.target_edge_length = value
@@ -563,6 +558,10 @@ class RemeshViewer(QMainWindow):
             # Load with PyVista
             self.original_mesh = pv.read(filepath)
             self.current_filepath = filepath
+            self.stop_remesh()
+            self.reference = None
+            self.source = None
+            self.remesher = None
 
             if self.original_mesh.n_points == 0:
                 raise RuntimeError("Mesh is empty")
@@ -601,7 +600,7 @@ class RemeshViewer(QMainWindow):
             self.status_bar.showMessage("Error loading mesh")
 
     def do_remesh(self):
-        """Perform remeshing using PMP."""
+        """Start remeshing with PMP on a background thread."""
         if self.original_mesh is None:
             return
 
@@ -612,70 +611,108 @@ class RemeshViewer(QMainWindow):
                 min_edge = self.min_edge_spinbox.value()
                 max_edge = self.max_edge_spinbox.value()
                 approx_error = self.approx_error_spinbox.value()
-                self.status_bar.showMessage(
-                    f"Adaptive remeshing (min={min_edge:.4f}, max={max_edge:.4f}, err={approx_error:.4f})..."
+                self.remesh_label = (
+                    f"Adaptive remeshing (min={min_edge:.4f}, max={max_edge:.4f}, err={approx_error:.4f})"
                 )
             else:
-                self.status_bar.showMessage(
-                    f"Uniform remeshing with edge length: {self.target_edge_length:.4f}..."
+                self.remesh_label = (
+                    f"Uniform remeshing with edge length: {self.target_edge_length:.4f}"
                 )
-            QApplication.processEvents()
-
-            # Convert PyVista mesh to PMP
-            pmp_mesh = pyvista_to_pmp(self.original_mesh)
+            self.status_bar.showMessage(f"{self.remesh_label}...")
+
+            # The PMP source mesh and the projection surface (BVH, normals,
+            # curvature) only depend on the original mesh: build them once
+            # and reuse them for every remesh
+            if self.source is None:
+                self.source = pyvista_to_pmp(self.original_mesh)
+                if not self.source.is_triangle_mesh():
+                    pmp.triangulate(self.source)
+            if self.reference is None:
+                self.reference = pmp.RemeshingReference(self.source)
+            if self.remesher is None:
+                self.remesher = pmp.Remesher(self.source, self.reference, 0)  # 0 = all cores
+                self.shown_version = 0
+                self.reset_remeshed_camera = True
+
+            # A run in progress stops at its next iteration; its result is
+            # where a close enough new run continues from
+            self.stop_remesh()
 
-            # Triangulate if needed
-            if not pmp_mesh.is_triangle_mesh():
-                pmp.triangulate(pmp_mesh)
-
-            # Apply remeshing based on selected method
             if is_adaptive:
-                pmp.adaptive_remeshing(
-                    pmp_mesh,
+                self.remesher.set_adaptive(
                     self.min_edge_spinbox.value(),   # min_edge_length
                     self.max_edge_spinbox.value(),   # max_edge_length
-                    self.approx_error_spinbox.value(),  # approx_error
-                    10,   # iterations
-                    True  # use projection
+                    self.approx_error_spinbox.value()  # approx_error
                 )
             else:
-                pmp.uniform_remeshing(
-                    pmp_mesh,
-                    self.target_edge_length,
-                    10,   # iterations
-                    True  # use projection
-                )
-            pmp_mesh.garbage_collection()
+                self.remesher.set_uniform(self.target_edge_length)
 
-            # Convert back to PyVista
-            self.remeshed_mesh = pmp_to_pyvista(pmp_mesh)
-
-            # Display using current visualization settings
-            self.update_mesh_display(self.plotter_remeshed, self.remeshed_mesh, 'lightgreen')
-            self.plotter_remeshed.reset_camera()
+            # 10 iterations from the source, 3 to adapt the previous result
+            self.remesher.start(10, 3)
+            self.poll_timer.start()
 
-            # Sync camera
-            self.sync_cameras()
-
-            # Update UI
-            self.save_btn.setEnabled(True)
+        except Exception as e:
+            QMessageBox.critical(self, "Error", f"Failed to remesh:\n{str(e)}")
+            self.status_bar.showMessage("Error during remeshing")
 
-            # Update info
-            method_name = "Adaptive" if is_adaptive else "Uniform"
-            self.remeshed_info.setText(
-                f"Remeshed ({method_name}): V={self.remeshed_mesh.n_points}, "
-                f"F={self.remeshed_mesh.n_faces_strict}"
-            )
+    def stop_remesh(self):
+        """Cancel the running remesh, if any, and wait for it to stop."""
+        self.poll_timer.stop()
+        if self.remesher is not None and self.remesher.running():
+            self.remesher.cancel()
+            try:
+                self.remesher.wait(-1)
+            except Exception:
+                pass  # superseded run
+
+    def poll_remesh(self):
+        """Show the latest snapshot of the running remesh, and its end."""
+        remesher = self.remesher
+        running = remesher.running()
+        try:
+            if remesher.version() != self.shown_version:
+                self.shown_version = remesher.fetch(self.snapshot)
+                self.show_remeshed(pmp_to_pyvista(self.snapshot))
+            if not running:
+                self.poll_timer.stop()
+                remesher.wait(0)  # raises the error of a failed run
+        except Exception as e:
+            self.poll_timer.stop()
+            QMessageBox.critical(self, "Error", f"Failed to remesh:\n{str(e)}")
+            self.status_bar.showMessage("Error during remeshing")
+            return
 
+        if running:
             self.status_bar.showMessage(
-                f"{method_name} remeshing complete - "
-                f"V: {self.original_mesh.n_points} -> {self.remeshed_mesh.n_points}, "
-                f"F: {self.original_mesh.n_faces_strict} -> {self.remeshed_mesh.n_faces_strict}"
+                f"{self.remesh_label}... iteration {remesher.iterations_done()}"
             )
+            return
 
-        except Exception as e:
-            QMessageBox.critical(self, "Error", f"Failed to remesh:\n{str(e)}")
-            self.status_bar.showMessage("Error during remeshing")
+        method_name = "Adaptive" if self.method_combo.currentIndex() == 1 else "Uniform"
+        self.remeshed_info.setText(
+            f"Remeshed ({method_name}): V={self.remeshed_mesh.n_points}, "
+            f"F={self.remeshed_mesh.n_faces_strict}"
+        )
+        start = "continued from the previous result" if remesher.warm_started() else "from scratch"
+        self.status_bar.showMessage(
+            f"{method_name} remeshing complete ({start}) - "
+            f"V: {self.original_mesh.n_points} -> {self.remeshed_mesh.n_points}, "
+            f"F: {self.original_mesh.n_faces_strict} -> {self.remeshed_mesh.n_faces_strict}"
+        )
+
+    def show_remeshed(self, poly):
+        """Replace the mesh of the remeshed view."""
+        self.remeshed_mesh = poly
+
+        # Display using current visualization settings
+        self.update_mesh_display(self.plotter_remeshed, self.remeshed_mesh, 'lightgreen')
+        if self.reset_remeshed_camera:
+            self.reset_remeshed_camera = False
+            self.plotter_remeshed.reset_camera()
+            self.sync_cameras()
+
+        # Update UI
+        self.save_btn.setEnabled(True)
 
     def sync_cameras(self):
         """Sync the camera of the remeshed view with the original view."""
@@ -713,6 +750,8 @@ class RemeshViewer(QMainWindow):
 
     def closeEvent(self, event):
         """Clean up on close."""
+        self.restart_timer.stop()
+        self.stop_remesh()
         self.plotter_original.close()
         self.plotter_remeshed.close()
         event.accept()